@@ -1,14 +1,164 @@
 #ifndef CDeflate_H
 #define CDeflate_H
 
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
 #include <vector>
+#include <cstddef>
 
+// zlib compression and decompression.
+//
+// Inflater and Deflater keep their zlib stream state between calls (it is reset rather
+// than reallocated) so one object can decode or encode many small buffers cheaply. Data
+// is passed as whole buffers or streamed in chunks through read/write callbacks.
 namespace CDeflate {
 
+using Bytes = std::vector<unsigned char>;
+
+//! stream framing (AUTO accepts zlib or gzip header when inflating, zlib when deflating)
+enum class Format {
+  ZLIB,
+  GZIP,
+  RAW,
+  AUTO
+};
+
+//! read up to len bytes into data, returns number of bytes read (0 at end of input)
+using ReadFunc = std::function<size_t (unsigned char *data, size_t len)>;
+
+//! write len bytes from data, returns false to stop
+using WriteFunc = std::function<bool (const unsigned char *data, size_t len)>;
+
+//---
+
+// Reusable byte buffers (thread safe) so repeated decodes don't reallocate.
+class BufferPool {
+ public:
+  explicit BufferPool(size_t maxBuffers=16) : maxBuffers_(maxBuffers) { }
+
+  BufferPool(const BufferPool &) = delete;
+  BufferPool &operator=(const BufferPool &) = delete;
+
+  //! buffer of size n (reuses storage of a released buffer when possible)
+  Bytes acquire(size_t n);
+
+  //! return buffer storage to pool (dropped if pool is full)
+  void release(Bytes &&bytes);
+
+  size_t numBuffers() const;
+
+  void clear();
+
+ private:
+  using Buffers = std::vector<Bytes>;
+
+  mutable std::mutex mutex_;
+  Buffers            buffers_;
+  size_t             maxBuffers_ { 16 };
+};
+
+//! shared pool used for stream chunk buffers
+BufferPool &bufferPool();
+
+//---
+
+class Inflater {
+ public:
+  explicit Inflater(Format format=Format::ZLIB);
+
+ ~Inflater();
+
+  Inflater(const Inflater &) = delete;
+  Inflater &operator=(const Inflater &) = delete;
+
+  Format format() const { return format_; }
+
+  //! chunk size used when streaming or output size is not known
+  size_t chunkSize() const { return chunkSize_; }
+  void setChunkSize(size_t n) { chunkSize_ = (n > 0 ? n : 1); }
+
+  //! inflate into odata of known size (outLen set to number of bytes written)
+  bool inflate(const unsigned char *idata, size_t ilen,
+               unsigned char *odata, size_t olen, size_t *outLen=nullptr);
+
+  //! inflate appending to odata (output size not known)
+  bool inflate(const unsigned char *idata, size_t ilen, Bytes &odata);
+
+  //! inflate input chunks from read passing output chunks to write
+  bool inflate(const ReadFunc &read, const WriteFunc &write);
+
+  const std::string &errorMsg() const { return errorMsg_; }
+
+ private:
+  bool begin();
+
+  bool fail(const std::string &msg);
+
+ private:
+  struct Stream;
+
+  Format                  format_    { Format::ZLIB };
+  size_t                  chunkSize_ { 65536 };
+  std::unique_ptr<Stream> stream_;
+  std::string             errorMsg_;
+};
+
+//---
+
+class Deflater {
+ public:
+  //! level is zlib compression level (0-9, -1 is zlib default)
+  explicit Deflater(Format format=Format::ZLIB, int level=-1);
+
+ ~Deflater();
+
+  Deflater(const Deflater &) = delete;
+  Deflater &operator=(const Deflater &) = delete;
+
+  Format format() const { return format_; }
+
+  int level() const { return level_; }
+
+  //! chunk size used when streaming
+  size_t chunkSize() const { return chunkSize_; }
+  void setChunkSize(size_t n) { chunkSize_ = (n > 0 ? n : 1); }
+
+  //! compress whole input appending to odata
+  bool deflate(const unsigned char *idata, size_t ilen, Bytes &odata);
+
+  //! compress input chunks from read passing output chunks to write
+  bool deflate(const ReadFunc &read, const WriteFunc &write);
+
+  const std::string &errorMsg() const { return errorMsg_; }
+
+ private:
+  bool begin();
+
+  bool fail(const std::string &msg);
+
+ private:
+  struct Stream;
+
+  Format                  format_    { Format::ZLIB };
+  int                     level_     { -1 };
+  size_t                  chunkSize_ { 65536 };
+  std::unique_ptr<Stream> stream_;
+  std::string             errorMsg_;
+};
+
+//---
+
+//! inflate zlib data of known output size (uses per thread Inflater)
 bool
 deflate_bytes(const std::vector<unsigned char> &idata, unsigned int idataLen,
               std::vector<unsigned char> &odata, unsigned int odataLen);
 
+bool
+deflate_bytes(const unsigned char *idata, unsigned int idataLen,
+              unsigned char *odata, unsigned int odataLen);
+
 }
 
 #endif
@@ -82,6 +82,7 @@ class CImport3DS : public CImportBase {
   bool        readMapCoords       (CImport3DSChunk *chunk, CGeomObject3D *object);
   bool        readChunk           (CImport3DSChunk *chunk);
   bool        skipChunk           (CImport3DSChunk *chunk);
+  bool        readData            (CImport3DSChunk *chunk, size_t n, std::vector<uchar> &data);
   bool        readChar            (CImport3DSChunk *chunk, uchar *c);
   bool        readShort           (CImport3DSChunk *chunk, ushort *s);
   bool        readLong            (CImport3DSChunk *chunk, uint *l);
@@ -98,7 +99,6 @@ class CImport3DS : public CImportBase {
  private:
   using MaterialList        = std::vector<CGeomMaterial *>;
   using FaceList            = std::vector<uint>;
-  using VertexFaceList      = std::map<uint, FaceList>;
   using SmoothGroupFaceList = std::map<uint, FaceList>;
 
   CFile*              file_     { nullptr };
@@ -106,11 +106,13 @@ class CImport3DS : public CImportBase {
   SceneP              pscene_;
   CGeomMaterial*      material_ { nullptr };
   MaterialList        materials_;
-  VertexFaceList      vertexFaceList_;
   SmoothGroupFaceList smoothGroupFaceList_;
 
   char *buffer_    { nullptr };
   uint  bufferMax_ { 0 };
+
+  // chunk data buffer (reused for bulk array reads)
+  std::vector<uchar> chunkData_;
 };
 
 #endif
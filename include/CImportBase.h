@@ -98,6 +98,16 @@ class CImportBase {
 
   //---
 
+  //! parse memory mapped file in place (for importers which support it)
+  bool isMapFile() const { return mapFile_; }
+  void setMapFile(bool b) { mapFile_ = b; }
+
+  //! number of parse threads (for importers which support it, 0 is one per core)
+  uint numThreads() const { return numThreads_; }
+  void setNumThreads(uint n) { numThreads_ = n; }
+
+  //---
+
   virtual bool read(CFile &file) = 0;
 
   virtual CGeomScene3D &getScene() = 0;
@@ -162,6 +172,10 @@ class CImportBase {
   bool        flipTexture_ { false };
   std::string textureDir_;
 
+  bool mapFile_ { false };
+
+  uint numThreads_ { 1 };
+
   using FileNameMap = std::map<std::string, std::string>;
 
   FileNameMap fileNameMap_;
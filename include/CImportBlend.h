@@ -7,6 +7,9 @@
 #include <CMatrix3D.h>
 #include <CShadeType3D.h>
 #include <CRGBA.h>
+#include <CDeflate.h>
+
+#include <unordered_map>
 
 class CImportBlend : public CImportBase {
  public:
@@ -54,14 +57,27 @@ class CImportBlend : public CImportBase {
   struct StructVar {
     uint typeInd;
     uint nameInd;
+    uint pos  { 0 };
+    uint size { 0 };
   };
 
   struct Struct {
     uint typeInd;
+    uint len { 0 };
 
     std::vector<StructVar> vars;
   };
 
+  //! indexed block header (data at offset in file data)
+  struct Block {
+    char     code[5] { };
+    uint64_t old     { 0 };
+    uint     sdna    { 0 };
+    ulong    offset  { 0 };
+    ulong    size    { 0 };
+    ulong    count   { 0 };
+  };
+
   struct MPoly {
     int   loopstart;
     int   totloop;
@@ -109,18 +125,33 @@ class CImportBlend : public CImportBase {
   };
 
  private:
-  bool readBlock(char *code);
-  bool processBlock(char *code);
+  bool decompress(CDeflate::Bytes &bytes) const;
+
+  bool readHeader();
+
+  bool indexBlocks();
+
+  bool readMeshes();
+
+  void readMesh(const Block &block, const Struct &s, Mesh *mesh, std::vector<bool> &used);
+  bool readMeshData(const Block &block, Mesh *mesh);
+
+  const Block *pointerBlock(const uchar *data, uint *ind) const;
+
+  const StructVar *findVar(const Struct &s, const std::string &name) const;
 
   bool readSDNA(const uchar *buffer, ulong size);
 
-  void printData(const Name &n, const Type &t, uchar *data) const;
+  void printBlock(const Block &block) const;
+
+  void printData(const Name &n, const Type &t, const uchar *data) const;
 
   void decodeNameData(Name &type) const;
 
-  uint   decodeInteger(const uchar *data) const;
-  ushort decodeShort  (const uchar *data) const;
-  float  decodeFloat  (const uchar *data) const;
+  uint     decodeInteger(const uchar *data) const;
+  ushort   decodeShort  (const uchar *data) const;
+  float    decodeFloat  (const uchar *data) const;
+  uint64_t decodePointer(const uchar *data) const;
 
  private:
   CGeomScene3D*  scene_   { nullptr };
@@ -135,18 +166,22 @@ class CImportBlend : public CImportBase {
 
   bool legacy_ { true };
 
-  uchar *buffer_     { nullptr };
-  ulong  bufferSize_ { 0 };
+  // file data (mapped or read in one pass) and block index
+  const uchar* data_       { nullptr };
+  ulong        dataSize_   { 0 };
+  ulong        headerSize_ { 0 };
+
+  using Blocks    = std::vector<Block>;
+  using PtrBlocks = std::unordered_map<uint64_t, uint>;
 
-  char *name_    { nullptr };
-  uint  nameLen_ { 0 };
+  Blocks    blocks_;
+  PtrBlocks ptrBlocks_;
 
   std::vector<Name>    names_;
   std::vector<Type>    types_;
   std::vector<Struct>  structs_;
   std::map<uint, uint> typeStruct_;
 
-  Mesh*               mesh_ { nullptr };
   std::vector<Mesh *> meshes_;
 };
 
@@ -8,7 +8,7 @@
 #include <cassert>
 #include <memory>
 
-class CXMLTag;
+class CImportXMLTag;
 
 class CImportDAE : public CImportBase {
  public:
@@ -421,98 +421,98 @@ class CImportDAE : public CImportBase {
   LibraryEffect* getMaterialEffect(const std::string &name) const;
   std::string    getEffectTexture(LibraryEffect *effect, const std::string &texture);
 
-  bool readAsset(const std::string &parentName, CXMLTag *tag);
+  bool readAsset(const std::string &parentName, CImportXMLTag *tag);
 
-  bool readLibraryImages(const std::string &parentName, CXMLTag *tag);
-  bool readLibraryImage(const std::string &parentName, CXMLTag *tag, ImageP &image);
+  bool readLibraryImages(const std::string &parentName, CImportXMLTag *tag);
+  bool readLibraryImage(const std::string &parentName, CImportXMLTag *tag, ImageP &image);
 
-  bool readLibraryMaterials(const std::string &parentName, CXMLTag *tag);
-  bool readLibraryMaterial(const std::string &parentName, CXMLTag *tag, MaterialP &material);
+  bool readLibraryMaterials(const std::string &parentName, CImportXMLTag *tag);
+  bool readLibraryMaterial(const std::string &parentName, CImportXMLTag *tag, MaterialP &material);
 
-  bool readLibraryEffects(const std::string &parentName, CXMLTag *tag);
-  bool readLibraryEffect(const std::string &parentName, CXMLTag *tag, LibraryEffectP &effect);
-  bool readLibraryEffectProfileCommon(const std::string &parentName, CXMLTag *tag,
+  bool readLibraryEffects(const std::string &parentName, CImportXMLTag *tag);
+  bool readLibraryEffect(const std::string &parentName, CImportXMLTag *tag, LibraryEffectP &effect);
+  bool readLibraryEffectProfileCommon(const std::string &parentName, CImportXMLTag *tag,
                                       LibraryEffectP &effect);
-  bool readLibraryEffectProfileParam(const std::string &parentName, CXMLTag *tag, NewParam &param,
+  bool readLibraryEffectProfileParam(const std::string &parentName, CImportXMLTag *tag, NewParam &param,
                                      LibraryEffectP &effect);
-  bool readLibraryEffectProfileTechnique(const std::string &parentName, CXMLTag *tag,
+  bool readLibraryEffectProfileTechnique(const std::string &parentName, CImportXMLTag *tag,
                                          LibraryEffectP &effect);
-  bool readLibraryEffectProfilePhong(const std::string &parentName, CXMLTag *tag,
+  bool readLibraryEffectProfilePhong(const std::string &parentName, CImportXMLTag *tag,
                                      LibraryEffectP &effect);
-  bool readLibraryEffectProfileExtra(const std::string &parentName, CXMLTag *tag,
+  bool readLibraryEffectProfileExtra(const std::string &parentName, CImportXMLTag *tag,
                                      LibraryEffectP &effect);
-  bool readLibraryEffectProfileTechExtra(const std::string &parentName, CXMLTag *tag,
+  bool readLibraryEffectProfileTechExtra(const std::string &parentName, CImportXMLTag *tag,
                                          LibraryEffectP &effect);
-  bool readLibraryEffectProfileDisplacement(const std::string &parentName, CXMLTag *tag,
+  bool readLibraryEffectProfileDisplacement(const std::string &parentName, CImportXMLTag *tag,
                                             LibraryEffectP &effect);
-  bool readLibraryEffectProfileSurface(const std::string &parentName, CXMLTag *tag,
+  bool readLibraryEffectProfileSurface(const std::string &parentName, CImportXMLTag *tag,
                                        Surface &surface);
-  bool readLibraryEffectSampler2D(const std::string &parentName, CXMLTag *tag, NewParam &param,
+  bool readLibraryEffectSampler2D(const std::string &parentName, CImportXMLTag *tag, NewParam &param,
                                   Sampler2D &sampler);
 
-  bool readAmbient(const std::string &parentName, CXMLTag *tag);
-  bool readDiffuse(const std::string &parentName, CXMLTag *tag, LibraryEffectP &effect);
-  bool readEmission(const std::string &parentName, CXMLTag *tag, LibraryEffectP &effect);
-  bool readSpecular(const std::string &parentName, CXMLTag *tag, LibraryEffectP &effect);
-  bool readShininess(const std::string &parentName, CXMLTag *tag);
-  bool readReflective(const std::string &parentName, CXMLTag *tag);
-  bool readReflectivity(const std::string &parentName, CXMLTag *tag);
-  bool readTransparent(const std::string &parentName, CXMLTag *tag, LibraryEffectP &effect);
-  bool readTransparency(const std::string &parentName, CXMLTag *tag);
-
-  bool readTexture(const std::string &parentName, CXMLTag *tag, Texture &texture);
-  bool readTextureExtra(const std::string &parentName, CXMLTag *tag, Texture &texture);
-  bool readTextureTechnique(const std::string &parentName, CXMLTag *tag, Texture &texture);
-  bool readTextureWrapU(const std::string &parentName, CXMLTag *tag, Texture &texture);
-  bool readTextureWrapV(const std::string &parentName, CXMLTag *tag, Texture &texture);
-  bool readTextureBlendMode(const std::string &parentName, CXMLTag *tag, Texture &texture);
-  bool readTextureOffsets(const std::string &parentName, CXMLTag *tag, Texture &texture);
-  bool readTextureAmount(const std::string &parentName, CXMLTag *tag, Texture &texture);
-
-  bool readLibraryGeometries(const std::string &parentName, CXMLTag *tag);
-  bool readLibraryGeometry(const std::string &parentName, CXMLTag *tag);
-
-  bool readGeometryMesh(const std::string &parentName, CXMLTag *tag, Geometry *geometry);
-  bool readGeometryMeshSource(const std::string &parentName, CXMLTag *tag, MeshSourceP &meshSource);
-  bool readGeometryMeshVertices(const std::string &parentName, CXMLTag *tag,
+  bool readAmbient(const std::string &parentName, CImportXMLTag *tag);
+  bool readDiffuse(const std::string &parentName, CImportXMLTag *tag, LibraryEffectP &effect);
+  bool readEmission(const std::string &parentName, CImportXMLTag *tag, LibraryEffectP &effect);
+  bool readSpecular(const std::string &parentName, CImportXMLTag *tag, LibraryEffectP &effect);
+  bool readShininess(const std::string &parentName, CImportXMLTag *tag);
+  bool readReflective(const std::string &parentName, CImportXMLTag *tag);
+  bool readReflectivity(const std::string &parentName, CImportXMLTag *tag);
+  bool readTransparent(const std::string &parentName, CImportXMLTag *tag, LibraryEffectP &effect);
+  bool readTransparency(const std::string &parentName, CImportXMLTag *tag);
+
+  bool readTexture(const std::string &parentName, CImportXMLTag *tag, Texture &texture);
+  bool readTextureExtra(const std::string &parentName, CImportXMLTag *tag, Texture &texture);
+  bool readTextureTechnique(const std::string &parentName, CImportXMLTag *tag, Texture &texture);
+  bool readTextureWrapU(const std::string &parentName, CImportXMLTag *tag, Texture &texture);
+  bool readTextureWrapV(const std::string &parentName, CImportXMLTag *tag, Texture &texture);
+  bool readTextureBlendMode(const std::string &parentName, CImportXMLTag *tag, Texture &texture);
+  bool readTextureOffsets(const std::string &parentName, CImportXMLTag *tag, Texture &texture);
+  bool readTextureAmount(const std::string &parentName, CImportXMLTag *tag, Texture &texture);
+
+  bool readLibraryGeometries(const std::string &parentName, CImportXMLTag *tag);
+  bool readLibraryGeometry(const std::string &parentName, CImportXMLTag *tag);
+
+  bool readGeometryMesh(const std::string &parentName, CImportXMLTag *tag, Geometry *geometry);
+  bool readGeometryMeshSource(const std::string &parentName, CImportXMLTag *tag, MeshSourceP &meshSource);
+  bool readGeometryMeshVertices(const std::string &parentName, CImportXMLTag *tag,
                                 MeshVerticesP &meshVertices);
-  bool readGeometryMeshPolylist(const std::string &parentName, CXMLTag *tag,
+  bool readGeometryMeshPolylist(const std::string &parentName, CImportXMLTag *tag,
                                 MeshPolyListP &polyList);
-  bool readGeometryMeshTriangles(const std::string &parentName, CXMLTag *tag,
+  bool readGeometryMeshTriangles(const std::string &parentName, CImportXMLTag *tag,
                                 MeshTrianglesP &triangles);
 
-  bool readTechniqueCommon(const std::string &parentName, CXMLTag *tag,
+  bool readTechniqueCommon(const std::string &parentName, CImportXMLTag *tag,
                            TechniqueCommon &techniqueCommon);
-  bool readTechniqueCommonAccessor(const std::string &parentName, CXMLTag *tag,
+  bool readTechniqueCommonAccessor(const std::string &parentName, CImportXMLTag *tag,
                                    TechniqueCommon &techniqueCommon);
 
-  bool readLibraryControllers(const std::string &parentName, CXMLTag *tag);
-  bool readLibraryController(const std::string &parentName, CXMLTag *tag);
-  bool readLibraryControllerSkin(const std::string &parentName, CXMLTag *tag, Skin &skin);
-  bool readLibraryControllerSkinSource(const std::string &parentName, CXMLTag *tag, Skin &skin);
-  bool readLibraryControllerSkinJoints(const std::string &parentName, CXMLTag *tag, Skin &skin);
-  bool readLibraryControllerSkinWeights(const std::string &parentName, CXMLTag *tag, Skin &skin);
+  bool readLibraryControllers(const std::string &parentName, CImportXMLTag *tag);
+  bool readLibraryController(const std::string &parentName, CImportXMLTag *tag);
+  bool readLibraryControllerSkin(const std::string &parentName, CImportXMLTag *tag, Skin &skin);
+  bool readLibraryControllerSkinSource(const std::string &parentName, CImportXMLTag *tag, Skin &skin);
+  bool readLibraryControllerSkinJoints(const std::string &parentName, CImportXMLTag *tag, Skin &skin);
+  bool readLibraryControllerSkinWeights(const std::string &parentName, CImportXMLTag *tag, Skin &skin);
 
-  bool readLibraryAnimations(const std::string &parentName, CXMLTag *tag);
-  bool readLibraryAnimation(const std::string &parentName, CXMLTag *tag);
-  bool readLibraryAnimationSource(const std::string &parentName, CXMLTag *tag,
+  bool readLibraryAnimations(const std::string &parentName, CImportXMLTag *tag);
+  bool readLibraryAnimation(const std::string &parentName, CImportXMLTag *tag);
+  bool readLibraryAnimationSource(const std::string &parentName, CImportXMLTag *tag,
                                   Animation &animation);
-  bool readLibraryAnimationSampler(const std::string &parentName, CXMLTag *tag,
+  bool readLibraryAnimationSampler(const std::string &parentName, CImportXMLTag *tag,
                                   Animation &animation);
 
-  bool readLibraryVisualScenes(const std::string &parentName, CXMLTag *tag);
-  bool readLibraryVisualScene(const std::string &parentName, CXMLTag *tag);
-
-  bool readInput(const std::string &parentName, CXMLTag *tag, Input &input);
-  bool readFloatArray(const std::string &parentName, CXMLTag *tag, FloatArray &array);
-  bool readNameArray(const std::string &parentName, CXMLTag *tag, NameArray &array);
-  bool readFloat(const std::string &parentName, CXMLTag *tag, Float &f);
-  bool readColor(const std::string &parentName, CXMLTag *tag, Color &c);
-  bool readNode(const std::string &parentName, CXMLTag *tag, VisualScene &scene, Node *node);
-  bool readNodeInstanceController(const std::string &parentName, CXMLTag *tag, Node *node);
-  bool readNodeBindMaterial(const std::string &parentName, CXMLTag *tag, Node *node);
-  bool readNodeBindMaterialCommon(const std::string &parentName, CXMLTag *tag, Node *node);
-  bool readScene(const std::string &parentName, CXMLTag *tag, Scene &scene);
+  bool readLibraryVisualScenes(const std::string &parentName, CImportXMLTag *tag);
+  bool readLibraryVisualScene(const std::string &parentName, CImportXMLTag *tag);
+
+  bool readInput(const std::string &parentName, CImportXMLTag *tag, Input &input);
+  bool readFloatArray(const std::string &parentName, CImportXMLTag *tag, FloatArray &array);
+  bool readNameArray(const std::string &parentName, CImportXMLTag *tag, NameArray &array);
+  bool readFloat(const std::string &parentName, CImportXMLTag *tag, Float &f);
+  bool readColor(const std::string &parentName, CImportXMLTag *tag, Color &c);
+  bool readNode(const std::string &parentName, CImportXMLTag *tag, VisualScene &scene, Node *node);
+  bool readNodeInstanceController(const std::string &parentName, CImportXMLTag *tag, Node *node);
+  bool readNodeBindMaterial(const std::string &parentName, CImportXMLTag *tag, Node *node);
+  bool readNodeBindMaterialCommon(const std::string &parentName, CImportXMLTag *tag, Node *node);
+  bool readScene(const std::string &parentName, CImportXMLTag *tag, Scene &scene);
 
   bool errorMsg(const std::string &name) const;
 
@@ -2,10 +2,16 @@
 #define CIMPORT_DXF_H
 
 #include <CImportBase.h>
+#include <CImportInstance.h>
 #include <CGeomObject3D.h>
 #include <CFile.h>
 
-class CImportDXF : public CImportBase {
+#include <map>
+#include <vector>
+
+// when instancing block references (INSERT) are instances of block geometry read once
+// (see instances) instead of transformed copies of the block added to the scene
+class CImportDXF : public CImportBase, public CImportInstancing {
  private:
   typedef std::vector<CGeomVertex3D *> VertexList;
 
@@ -33,16 +39,47 @@ class CImportDXF : public CImportBase {
     return object_;
   }
 
+ private:
+  struct Insert {
+    std::string block;
+    CPoint3D    point      { 0, 0, 0 };
+    CPoint3D    scale      { 1, 1, 1 };
+    double      rotation   { 0.0 }; // degrees
+    int         numCols    { 1 };
+    int         numRows    { 1 };
+    double      colSpacing { 0.0 };
+    double      rowSpacing { 0.0 };
+  };
+
+  using Inserts = std::vector<Insert>;
+
+  struct Block {
+    std::string    name;
+    CPoint3D       base   { 0, 0, 0 };
+    CGeomObject3D* object { nullptr };
+    Inserts        inserts; // nested block references
+  };
+
+  using Blocks = std::map<std::string, Block>;
+
  private:
   bool readSection();
   bool readHeader();
   bool readTables();
   bool readBlocks();
-  bool readEntities();
+  bool readBlock();
+  bool readEntities(const std::string &endName, Inserts &inserts);
   bool read3DFaceEntity();
   bool readPolyLineEntity();
   bool readVertexEntity(int color);
+  bool readInsertEntity(Insert &insert);
   bool readEntity();
+
+  void addInserts(const Inserts &inserts, const CMatrix3D &parentTransform, int depth);
+  void addBlockInstance(const Block &block, const CMatrix3D &transform);
+
+  CMatrix3D insertTransform(const Insert &insert, const Block &block, int col, int row) const;
+
   bool readLine(std::string &line);
   void unreadLine(std::string line);
   void badLine(std::string line);
@@ -52,10 +89,15 @@ class CImportDXF : public CImportBase {
   SceneP         pscene_;
   CGeomObject3D* object_       { nullptr };
   ObjectP        pobject_;
+  CGeomObject3D* current_      { nullptr }; //!< object entities are added to
+  uint           polyBase_     { 0 };       //!< first vertex of current polyline
   CFile*         file_         { nullptr };
   int            line_num_     { 0 };
   std::string    buffer_;
   bool           buffer_valid_ { false };
+
+  Blocks  blocks_;
+  Inserts inserts_; // top level block references
 };
 
 #endif
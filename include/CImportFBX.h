@@ -5,8 +5,12 @@
 #include <CGeomObject3D.h>
 #include <CFile.h>
 #include <CDeflate.h>
+#include <CImportMapFile.h>
 
+#include <deque>
 #include <optional>
+#include <variant>
+#include <cstring>
 
 class CStrParse;
 
@@ -77,61 +81,42 @@ class CImportFBX : public CImportBase {
   using OptString = std::optional<std::string>;
   using OptColor  = std::optional<CRGBA>;
 
-  template<typename T>
-  static void *createData(const T &t) {
-    auto *t1 = new T(t);
-    return t1;
-  }
-
-  template<typename T>
-  static void deleteData(void *data) {
-    auto *t = reinterpret_cast<T *>(data);
-    delete t;
-  }
-
+  // property value recorded as FBX type code and its bytes in the file memory
+  // (values are decoded when used, arrays are decoded once and cached)
   class PropData {
    public:
     PropData() { }
 
-   ~PropData() {
-      freeData();
+    PropData(uchar code, const uchar *data, ulong len) :
+     code_(code), data_(data), len_(len) {
     }
 
     PropData(const PropData &) = delete;
     const PropData &operator=(const PropData &) = delete;
 
-    const DataType &type() const { return type_; }
-
-    template<typename T>
-    void setData(const T &t) {
-      freeData();
-
-      type_ = CImportFBXUtil::dataType<T>();
-      data_ = createData(t);
-
-      assert(type_ != DataType::INVALID);
-    }
-
-    void freeData() {
-      if      (type() == DataType::BYTE  ) deleteData<uchar      >(data_);
-      else if (type() == DataType::SHORT ) deleteData<short      >(data_);
-      else if (type() == DataType::INT   ) deleteData<int        >(data_);
-      else if (type() == DataType::LONG  ) deleteData<long       >(data_);
-      else if (type() == DataType::FLOAT ) deleteData<float      >(data_);
-      else if (type() == DataType::DOUBLE) deleteData<double     >(data_);
-      else if (type() == DataType::STRING) deleteData<std::string>(data_);
-
-      else if (type() == DataType::BYTE_ARRAY  ) deleteData<std::vector<uchar >>(data_);
-      else if (type() == DataType::SHORT_ARRAY ) deleteData<std::vector<short >>(data_);
-      else if (type() == DataType::INT_ARRAY   ) deleteData<std::vector<int   >>(data_);
-      else if (type() == DataType::LONG_ARRAY  ) deleteData<std::vector<long  >>(data_);
-      else if (type() == DataType::FLOAT_ARRAY ) deleteData<std::vector<float >>(data_);
-      else if (type() == DataType::DOUBLE_ARRAY) deleteData<std::vector<double>>(data_);
-
-      else if (type() != DataType::NONE) assert(false);
-
-      type_ = DataType::NONE;
-      data_ = nullptr;
+    //! FBX type code
+    uchar code() const { return code_; }
+
+    //! property bytes (after type code)
+    const uchar *bytes() const { return data_; }
+    ulong numBytes() const { return len_; }
+
+    DataType type() const {
+      switch (code_) {
+        case 'Y': return DataType::SHORT;
+        case 'I': return DataType::INT;
+        case 'L': return DataType::LONG;
+        case 'F': return DataType::FLOAT;
+        case 'D': return DataType::DOUBLE;
+        case 'S': return DataType::STRING;
+        case 'R': return DataType::BYTE_ARRAY;
+        case 'b': return DataType::BYTE_ARRAY;
+        case 'i': return DataType::INT_ARRAY;
+        case 'l': return DataType::LONG_ARRAY;
+        case 'f': return DataType::FLOAT_ARRAY;
+        case 'd': return DataType::DOUBLE_ARRAY;
+        default : return DataType::NONE;
+      }
     }
 
     template<typename T>
@@ -156,141 +141,99 @@ class CImportFBX : public CImportBase {
       }
     }
 
+    //! scalar value (little endian in file)
     template<typename T>
-    const T &getData() const {
-      return *reinterpret_cast<T *>(data_);
+    T getData() const {
+      T t;
+      memcpy(&t, data_, sizeof(T));
+      return t;
     }
 
+    std::string getString() const {
+      auto len = getData<uint>();
+      auto str = reinterpret_cast<const char *>(data_ + 4);
+      return std::string(str, strnlen(str, len));
+    }
+
+    //! decoded array (decoded on first use)
     template<typename T>
     const std::vector<T> &getArrayData() const {
-      return *reinterpret_cast<std::vector<T> *>(data_);
+      decodeArray();
+      return std::get<std::vector<T>>(array_);
+    }
+
+    //! move decoded array out of property (decoded again if used later)
+    template<typename T>
+    std::vector<T> takeArrayData() {
+      decodeArray();
+      auto a = std::move(std::get<std::vector<T>>(array_));
+      array_ = std::monostate();
+      return a;
     }
 
     friend std::ostream &operator<<(std::ostream &os, const PropData &data) {
-      if      (data.type() == DataType::BYTE)
-        printDataType(os, *reinterpret_cast<uchar *>(data.data_));
-      else if (data.type() == DataType::SHORT)
-        printDataType(os, *reinterpret_cast<short *>(data.data_));
-      else if (data.type() == DataType::INT)
-        printDataType(os, *reinterpret_cast<int *>(data.data_));
-      else if (data.type() == DataType::LONG)
-        printDataType(os, *reinterpret_cast<long *>(data.data_));
-      else if (data.type() == DataType::FLOAT)
-        printDataType(os, *reinterpret_cast<float *>(data.data_));
-      else if (data.type() == DataType::DOUBLE)
-        printDataType(os, *reinterpret_cast<double *>(data.data_));
-      else if (data.type() == DataType::STRING)
-        printDataType(os, *reinterpret_cast<std::string *>(data.data_));
-
-      else if (data.type() == DataType::BYTE_ARRAY)
-        printArray(os, *reinterpret_cast<std::vector<uchar> *>(data.data_));
-      else if (data.type() == DataType::SHORT_ARRAY)
-        printArray(os, *reinterpret_cast<std::vector<short> *>(data.data_));
-      else if (data.type() == DataType::INT_ARRAY)
-        printArray(os, *reinterpret_cast<std::vector<int> *>(data.data_));
-      else if (data.type() == DataType::LONG_ARRAY)
-        printArray(os, *reinterpret_cast<std::vector<long> *>(data.data_));
-      else if (data.type() == DataType::FLOAT_ARRAY)
-        printArray(os, *reinterpret_cast<std::vector<float> *>(data.data_));
-      else if (data.type() == DataType::DOUBLE_ARRAY)
-        printArray(os, *reinterpret_cast<std::vector<double> *>(data.data_));
-
-      else if (data.type() != DataType::NONE)
-        assert(false);
+      switch (data.type()) {
+        case DataType::SHORT       : printDataType(os, data.getData<short  >()); break;
+        case DataType::INT         : printDataType(os, data.getData<int    >()); break;
+        case DataType::LONG        : printDataType(os, data.getData<long   >()); break;
+        case DataType::FLOAT       : printDataType(os, data.getData<float  >()); break;
+        case DataType::DOUBLE      : printDataType(os, data.getData<double >()); break;
+        case DataType::STRING      : printDataType(os, data.getString()); break;
+        case DataType::BYTE_ARRAY  : printArray(os, data.getArrayData<uchar >()); break;
+        case DataType::INT_ARRAY   : printArray(os, data.getArrayData<int   >()); break;
+        case DataType::LONG_ARRAY  : printArray(os, data.getArrayData<long  >()); break;
+        case DataType::FLOAT_ARRAY : printArray(os, data.getArrayData<float >()); break;
+        case DataType::DOUBLE_ARRAY: printArray(os, data.getArrayData<double>()); break;
+        default: break;
+      }
 
       return os;
     }
 
     std::string toString() const {
-      if      (type() == DataType::BYTE)
-        return std::to_string(*reinterpret_cast<uchar *>(data_));
-      else if (type() == DataType::SHORT)
-        return std::to_string(*reinterpret_cast<short *>(data_));
-      else if (type() == DataType::INT)
-        return std::to_string(*reinterpret_cast<int *>(data_));
-      else if (type() == DataType::LONG)
-        return std::to_string(*reinterpret_cast<long *>(data_));
-      else if (type() == DataType::FLOAT)
-        return std::to_string(*reinterpret_cast<float *>(data_));
-      else if (type() == DataType::DOUBLE)
-        return std::to_string(*reinterpret_cast<double *>(data_));
-      else if (type() == DataType::STRING)
-        return *reinterpret_cast<std::string *>(data_);
-      else if (type() == DataType::BYTE_ARRAY) {
-        std::ostringstream os;
-        printArray(os, *reinterpret_cast<std::vector<uchar> *>(data_));
-        return os.str();
-      }
-      else if (type() == DataType::SHORT_ARRAY) {
-        std::ostringstream os;
-        printArray(os, *reinterpret_cast<std::vector<short> *>(data_));
-        return os.str();
-      }
-      else if (type() == DataType::INT_ARRAY) {
-        std::ostringstream os;
-        printArray(os, *reinterpret_cast<std::vector<int> *>(data_));
-        return os.str();
-      }
-      else if (type() == DataType::LONG_ARRAY) {
-        std::ostringstream os;
-        printArray(os, *reinterpret_cast<std::vector<long> *>(data_));
-        return os.str();
-      }
-      else if (type() == DataType::FLOAT_ARRAY) {
-        std::ostringstream os;
-        printArray(os, *reinterpret_cast<std::vector<float> *>(data_));
-        return os.str();
-      }
-      else if (type() == DataType::DOUBLE_ARRAY) {
-        std::ostringstream os;
-        printArray(os, *reinterpret_cast<std::vector<double> *>(data_));
-        return os.str();
+      switch (type()) {
+        case DataType::SHORT : return std::to_string(getData<short >());
+        case DataType::INT   : return std::to_string(getData<int   >());
+        case DataType::LONG  : return std::to_string(getData<long  >());
+        case DataType::FLOAT : return std::to_string(getData<float >());
+        case DataType::DOUBLE: return std::to_string(getData<double>());
+        case DataType::STRING: return getString();
+        case DataType::NONE  : return "";
+        default: {
+          std::ostringstream os;
+          os << *this;
+          return os.str();
+        }
       }
-      else if (type() == DataType::NONE)
-        return "";
-      else
-        assert(false);
-
-      return "";
     }
 
     long toLong() const {
-     if      (type() == DataType::BYTE)
-        return *reinterpret_cast<uchar *>(data_);
-      else if (type() == DataType::SHORT)
-        return *reinterpret_cast<short *>(data_);
-      else if (type() == DataType::INT)
-        return *reinterpret_cast<int *>(data_);
-      else if (type() == DataType::LONG)
-        return *reinterpret_cast<long *>(data_);
-      else
-        assert(false);
+      switch (type()) {
+        case DataType::SHORT: return getData<short>();
+        case DataType::INT  : return getData<int  >();
+        case DataType::LONG : return getData<long >();
+        default: assert(false); break;
+      }
 
       return 0;
     }
 
     double toReal() const {
-     if      (type() == DataType::BYTE)
-        return *reinterpret_cast<uchar *>(data_);
-      else if (type() == DataType::SHORT)
-        return *reinterpret_cast<short *>(data_);
-      else if (type() == DataType::INT)
-        return *reinterpret_cast<int *>(data_);
-      else if (type() == DataType::LONG)
-        return static_cast<double>(*reinterpret_cast<long *>(data_));
-      else if (type() == DataType::FLOAT)
-        return *reinterpret_cast<float *>(data_);
-      else if (type() == DataType::DOUBLE)
-        return *reinterpret_cast<double *>(data_);
-      else
-        assert(false);
+      switch (type()) {
+        case DataType::SHORT : return getData<short>();
+        case DataType::INT   : return getData<int  >();
+        case DataType::LONG  : return static_cast<double>(getData<long>());
+        case DataType::FLOAT : return getData<float >();
+        case DataType::DOUBLE: return getData<double>();
+        default: assert(false); break;
+      }
 
       return 0;
     }
 
     std::vector<int> toIntArray() const {
       if (type() == DataType::INT_ARRAY)
-        return *reinterpret_cast<std::vector<int> *>(data_);
+        return getArrayData<int>();
       else {
         std::vector<int> ia;
         ia.push_back(int(toLong()));
@@ -300,7 +243,7 @@ class CImportFBX : public CImportBase {
 
     std::vector<long> toLongArray() const {
       if (type() == DataType::LONG_ARRAY)
-        return *reinterpret_cast<std::vector<long> *>(data_);
+        return getArrayData<long>();
       else
         assert(false);
 
@@ -309,7 +252,7 @@ class CImportFBX : public CImportBase {
 
     std::vector<float> toFloatArray() const {
       if (type() == DataType::FLOAT_ARRAY)
-        return *reinterpret_cast<std::vector<float> *>(data_);
+        return getArrayData<float>();
       else
         assert(false);
 
@@ -318,7 +261,7 @@ class CImportFBX : public CImportBase {
 
     std::vector<double> toDoubleArray() const {
       if (type() == DataType::DOUBLE_ARRAY)
-        return *reinterpret_cast<std::vector<double> *>(data_);
+        return getArrayData<double>();
       else {
         std::vector<double> da;
         da.push_back(toReal());
@@ -326,9 +269,34 @@ class CImportFBX : public CImportBase {
       }
     }
 
+    //! true if compressed array
+    bool isCompressed() const {
+      if (! (uint(type()) & uint(DataType::ARRAY)) || code_ == 'R')
+        return false;
+
+      uint encoding;
+      memcpy(&encoding, data_ + 4, sizeof(uint));
+      return (encoding != 0);
+    }
+
+    //! compressed data size (arrays only)
+    uint compressedLen() const {
+      uint len;
+      memcpy(&len, data_ + 8, sizeof(uint));
+      return len;
+    }
+
+    //! decode array now (otherwise decoded on first use)
+    void decodeArray() const;
+
    private:
-    DataType type_ { DataType::NONE };
-    void*    data_ { nullptr };
+    using ArrayData = std::variant<std::monostate, std::vector<uchar>, std::vector<int>,
+                                   std::vector<long>, std::vector<float>, std::vector<double>>;
+
+    uchar             code_ { 0 };
+    const uchar*      data_ { nullptr };
+    ulong             len_  { 0 };
+    mutable ArrayData array_;
   };
 
   using PropDataArray    = std::map<uint, PropData *>;
@@ -421,13 +389,11 @@ class CImportFBX : public CImportBase {
     }
   };
 
+  // bounds checked read position in file memory (reads reference memory in place)
   struct FileData {
-    std::vector<uchar> fileMem;
-    const uchar*       fileBytes { nullptr };
-    ulong              filePos { 0 };
-    ulong              fileSize { 0 };
-
-    std::vector<uchar> buffer;
+    const uchar* fileBytes { nullptr };
+    ulong        filePos { 0 };
+    ulong        fileSize { 0 };
 
     int depth { 0 };
 
@@ -435,45 +401,47 @@ class CImportFBX : public CImportBase {
 
     //---
 
-    bool readBytes(uint len) {
+    //! view of next len bytes
+    bool readBytes(ulong len, const uchar* &data) {
       if (filePos + len > fileSize) {
         filePos = fileSize;
         return false;
       }
 
-      buffer.resize(len + 1);
+      data = fileBytes + filePos;
 
-      for (uint i = 0; i < len; ++i)
-        buffer[i] = fileBytes[filePos++];
+      filePos += len;
 
       return true;
     }
 
+    bool skipBytes(ulong len) {
+      const uchar *data;
+      return readBytes(len, data);
+    }
+
     template<typename T>
     bool readData(T *t) {
-      if (! readBytes(sizeof(T)))
+      const uchar *data;
+      if (! readBytes(sizeof(T), data))
         return false;
 
-      *t = *reinterpret_cast<T *>(&buffer[0]);
+      memcpy(t, data, sizeof(T));
 
       return true;
     }
 
     bool readUChar(uchar *c) {
-      if (! readBytes(1))
-        return false;
-
-      *c = buffer[0];
-
-      return true;
+      return readData(c);
     }
 
     bool readUShort(ushort *i) {
-      if (! readBytes(2))
+      const uchar *data;
+      if (! readBytes(2, data))
         return false;
 
-      *i = ((buffer[0] & 0xFF)      ) |
-           ((buffer[1] & 0xFF) <<  8);
+      *i = ushort(((data[0] & 0xFF)      ) |
+                  ((data[1] & 0xFF) <<  8));
 
       return true;
     }
@@ -483,41 +451,41 @@ class CImportFBX : public CImportBase {
     }
 
     bool readUInt(uint *i) {
-      if (! readBytes(4))
+      ulong l;
+      if (! readUInt(&l))
         return false;
 
-      *i = ((buffer[0] & 0xFF)      ) |
-           ((buffer[1] & 0xFF) <<  8) |
-           ((buffer[2] & 0xFF) << 16) |
-           ((buffer[3] & 0xFF) << 24);
+      *i = uint(l);
 
       return true;
     }
 
     bool readUInt(ulong *i) {
-      if (! readBytes(4))
+      const uchar *data;
+      if (! readBytes(4, data))
         return false;
 
-      *i = ((buffer[0] & 0xFF)      ) |
-           ((buffer[1] & 0xFF) <<  8) |
-           ((buffer[2] & 0xFF) << 16) |
-           ((buffer[3] & 0xFF) << 24);
+      *i = (ulong(data[0] & 0xFF)      ) |
+           (ulong(data[1] & 0xFF) <<  8) |
+           (ulong(data[2] & 0xFF) << 16) |
+           (ulong(data[3] & 0xFF) << 24);
 
       return true;
     }
 
     bool readULong(ulong *i) {
-      if (! readBytes(8))
+      const uchar *data;
+      if (! readBytes(8, data))
         return false;
 
-      *i = (ulong(buffer[0] & 0xFF)      ) |
-           (ulong(buffer[1] & 0xFF) <<  8) |
-           (ulong(buffer[2] & 0xFF) << 16) |
-           (ulong(buffer[3] & 0xFF) << 24) |
-           (ulong(buffer[4] & 0xFF) << 32) |
-           (ulong(buffer[5] & 0xFF) << 40) |
-           (ulong(buffer[6] & 0xFF) << 48) |
-           (ulong(buffer[7] & 0xFF) << 56);
+      *i = (ulong(data[0] & 0xFF)      ) |
+           (ulong(data[1] & 0xFF) <<  8) |
+           (ulong(data[2] & 0xFF) << 16) |
+           (ulong(data[3] & 0xFF) << 24) |
+           (ulong(data[4] & 0xFF) << 32) |
+           (ulong(data[5] & 0xFF) << 40) |
+           (ulong(data[6] & 0xFF) << 48) |
+           (ulong(data[7] & 0xFF) << 56);
 
       return true;
     }
@@ -538,17 +506,42 @@ class CImportFBX : public CImportBase {
       return readData(r);
     }
 
+    // string stops at first null (FBX uses "name\0\1class" names)
     bool readStr(uint len, std::string &str) {
-      if (! readBytes(len))
+      const uchar *data;
+      if (! readBytes(len, data))
         return false;
 
-      buffer[len] = '\0';
+      auto *chars = reinterpret_cast<const char *>(data);
 
-      str = std::string(reinterpret_cast<char *>(&buffer[0]));
+      str = std::string(chars, strnlen(chars, len));
 
       return true;
     };
 
+    //! skip array header and data (size of element type is esize)
+    bool skipArrayData(uint esize, char tc) {
+      uint len;
+      if (! readUInt(&len))
+        return errorMsg("Failed to read len for " + ucharStr(tc));
+
+      uint encoding;
+      if (! readUInt(&encoding))
+        return errorMsg("Failed to read encoding for " + ucharStr(tc));
+
+      uint compressedLen;
+      if (! readUInt(&compressedLen))
+        return errorMsg("Failed to read compress for " + ucharStr(tc));
+
+      auto dataLen = (encoding == 0 ? ulong(len)*esize : ulong(compressedLen));
+
+      if (! skipBytes(dataLen))
+        return errorMsg("Failed to read data for " + ucharStr(tc));
+
+      return true;
+    }
+
+    // decode array into data (resized once, compressed data inflated in place)
     template<typename T>
     bool readArrayData(std::vector<T> &data, char tc, int d) {
       depth = d;
@@ -565,46 +558,50 @@ class CImportFBX : public CImportBase {
       if (! readUInt(&compressedLen))
         return errorMsg("Failed to read compress for " + ucharStr(tc));
 
-      infoMsg(" " + std::string(&tc, 1) + " " + std::to_string(encoding) +
-              " " + std::to_string(compressedLen));
+      if (debug)
+        infoMsg(" " + std::string(&tc, 1) + " " + std::to_string(encoding) +
+                " " + std::to_string(compressedLen));
+
+      auto dataLen = ulong(len)*sizeof(T);
+
+      // check declared length against data before allocating it (deflate expands
+      // at most ~1032:1)
+      auto left = fileSize - filePos;
+
+      if (encoding == 0 ? dataLen > left :
+          (compressedLen > left || dataLen > ulong(compressedLen)*1032 + 64))
+        return errorMsg("Invalid len " + std::to_string(len) + " for " + ucharStr(tc));
+
+      data.resize(len);
 
       if (encoding == 0) {
-        std::string vstr;
-        for (uint i = 0; i < len; ++i) {
-          T t;
-          if (! readData(&t))
-            return errorMsg("Failed to read data for " + ucharStr(tc));
-          if (i > 0) vstr += " ";
-          vstr += std::to_string(t);
-        }
-        infoMsg("  [" + std::to_string(len) + "] " + vstr);
+        const uchar *idata;
+        if (! readBytes(dataLen, idata))
+          return errorMsg("Failed to read data for " + ucharStr(tc));
+
+        if (dataLen > 0)
+          memcpy(data.data(), idata, dataLen);
       }
       else {
-        if (! readBytes(compressedLen))
+        const uchar *cdata;
+        if (! readBytes(compressedLen, cdata))
           return errorMsg("Failed to read data for " + ucharStr(tc));
 
-        FileData fileData1;
-
-        fileData1.fileSize = len*sizeof(T);
-        fileData1.fileMem.resize(fileData1.fileSize);
-
-        if (! CDeflate::deflate_bytes(buffer, compressedLen,
-                                      fileData1.fileMem, uint(fileData1.fileSize)))
+        if (dataLen > 0 &&
+            ! CDeflate::deflate_bytes(cdata, compressedLen,
+                                      reinterpret_cast<uchar *>(data.data()), uint(dataLen)))
           return errorMsg("Failed to uncompress data");
+      }
 
-        fileData1.fileBytes = &fileData1.fileMem[0];
-
+      if (debug) {
         std::string vstr;
         for (uint i = 0; i < len; ++i) {
-          T t;
-          if (! fileData1.readData(&t))
-            return errorMsg("Failed to read data for " + ucharStr(tc));
-          data.push_back(t);
           if (i > 0) vstr += " ";
-          vstr += std::to_string(t);
+          vstr += std::to_string(data[i]);
         }
         infoMsg("  [" + std::to_string(len) + "] " + vstr);
       }
+
       return true;
     }
 
@@ -667,6 +664,20 @@ class CImportFBX : public CImportBase {
   bool isHierName() const { return hierName_; }
   void setHierName(bool b) { hierName_ = b; }
 
+  //! report time spent in each binary read phase
+  bool isTiming() const { return timing_; }
+  void setTiming(bool b) { timing_ = b; }
+
+  struct PhaseTimes {
+    double read     { 0.0 };
+    double tree     { 0.0 };
+    double inflate  { 0.0 };
+    double geometry { 0.0 };
+  };
+
+  //! seconds spent in each phase of last binary read
+  const PhaseTimes &phaseTimes() const { return phaseTimes_; }
+
   void addFileMap(const std::string &oldName, const std::string &newName);
 
  private:
@@ -827,6 +838,10 @@ class CImportFBX : public CImportBase {
   bool readScopeData(const std::string &name, uint ni, uint ind, FileData &fileData,
                      const std::string &scopeName, PropDataTree *propDataTree);
 
+  void inflateArrays();
+
+  void printPhaseTimes() const;
+
   void processHierModel(ModelData *modelData, int depth);
 
   void dumpTree(PropDataTree *tree, int depth=0);
@@ -873,11 +888,22 @@ class CImportFBX : public CImportBase {
 
   PropDataTree *propDataTree_ { nullptr };
 
+  // binary file memory (properties reference it) and property records
+  std::vector<uchar>   fileMem_;
+  CImportMapFile       mapFile_;
+  std::deque<PropData> propDatas_;
+
+  // compressed array properties (inflated in parallel after tree is built)
+  std::vector<PropData *> compressedProps_;
+
   uint objectInd_ { 0 };
 
   bool debug_    { false };
   bool dump_     { false };
   bool hierName_ { false };
+  bool timing_   { false };
+
+  PhaseTimes phaseTimes_;
 
   using ConnectionMap = std::map<std::string, std::string>;
 
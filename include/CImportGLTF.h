@@ -2,6 +2,9 @@
 #define CImportGLTF_H
 
 #include <CImportBase.h>
+#include <CImportInstance.h>
+#include <CImportMapFile.h>
+#include <CImportImageCache.h>
 #include <CGeomObject3D.h>
 #include <CGeomAnimationData.h>
 #include <CGLMatrix3D.h>
@@ -11,11 +14,18 @@
 #include <CRotate3D.h>
 
 #include <string>
+#include <string_view>
 #include <vector>
+#include <memory>
 #include <optional>
 #include <iostream>
+#include <cstring>
+#include <cstdint>
 
-class CImportGLTF : public CImportBase {
+// unskinned meshes used by several nodes are built once per glTF mesh. Each node gets
+// a copy of the built mesh, or when instancing references it (see instances) instead
+// of getting its own object
+class CImportGLTF : public CImportBase, public CImportInstancing {
  public:
   struct Color {
     double r { 0.0 };
@@ -184,8 +194,15 @@ class CImportGLTF : public CImportBase {
   using OptReal = std::optional<double>;
   using OptLong = std::optional<long>;
 
+  //! chunk bytes, either owned or a range of the mapped file
   struct ChunkBuffer {
-    std::vector<unsigned char> data;
+    std::vector<unsigned char> owned;
+    const unsigned char*       ref { nullptr };
+    size_t                     len { 0 };
+
+    const unsigned char *data() const { return (ref ? ref : owned.data()); }
+
+    size_t size() const { return (ref ? len : owned.size()); }
   };
 
   struct Chunk {
@@ -283,6 +300,7 @@ class CImportGLTF : public CImportBase {
     long        height { -1 };
 
     mutable CImagePtr image;
+    mutable long      imageId { -1 }; // image cache id (source recorded)
   };
 
   using OptColor  = std::optional<Color>;
@@ -420,6 +438,11 @@ class CImportGLTF : public CImportBase {
     long                 camera { -1 }; // "camera"
     std::vector<IndName> children;      // "children"
 
+    // EXT_mesh_gpu_instancing attribute accessors
+    IndName instanceTranslation; // "TRANSLATION"
+    IndName instanceRotation;    // "ROTATION"
+    IndName instanceScale;       // "SCALE"
+
     // order in skins
     int order { -1 };
 
@@ -496,6 +519,17 @@ class CImportGLTF : public CImportBase {
 
       (*this)[d.indName] = d;
     }
+
+    void add(T &&d, const IndName &indName) {
+      d.indName = indName;
+
+      if (indName.name == "")
+        d.indName.ind = lastInd++;
+
+      auto ind = d.indName;
+
+      (*this)[ind] = std::move(d);
+    }
   };
 
   struct AnimationChannel : IndData {
@@ -572,10 +606,46 @@ class CImportGLTF : public CImportBase {
     IndNameMap<Skin>         skins;
   };
 
-  struct AccessorData {
-    const uchar *data       { nullptr };
-    int          byteStride { 0 };
-    long         byteLength { 0 };
+  //! typed strided view of accessor elements straight into the buffer data (no copy)
+  struct AccessorView {
+    const uchar *data          { nullptr };
+    long         count         { 0 };
+    long         componentType { -1 };
+    int          numComponents { 0 };
+    int          elementSize   { 0 }; // bytes per element
+    int          byteStride    { 0 }; // bytes between elements
+    bool         swap          { false };
+
+    bool isPacked() const { return (byteStride == elementSize); }
+
+    //! component c of element i (little endian)
+    template<typename T>
+    T value(long i, int c=0) const {
+      const auto *p = data + i*byteStride + c*long(sizeof(T));
+
+      uchar b[sizeof(T)];
+
+      for (size_t j = 0; j < sizeof(T); ++j)
+        b[j] = (swap ? p[sizeof(T) - 1 - j] : p[j]);
+
+      T v;
+
+      memcpy(&v, b, sizeof(T));
+
+      return v;
+    }
+
+    //! typed base pointer with stride in units of T (nullptr if not directly addressable)
+    template<typename T>
+    const T *span(long &stride) const {
+      if (swap || byteStride % long(sizeof(T)) != 0 ||
+          reinterpret_cast<uintptr_t>(data) % alignof(T) != 0)
+        return nullptr;
+
+      stride = byteStride/long(sizeof(T));
+
+      return reinterpret_cast<const T *>(data);
+    }
   };
 
   struct MeshData : IndData {
@@ -592,24 +662,36 @@ class CImportGLTF : public CImportBase {
     std::vector<Mat4>   mat4;
   };
 
+  //! primitive arrays (referencing mesh data) and valid triangle indices
+  struct PrimitiveGeom {
+    const Vec3 *positions  { nullptr }; size_t np { 0 };
+    const Vec3 *normals    { nullptr }; size_t nn { 0 };
+    const Vec2 *texCoords0 { nullptr }; size_t nt { 0 };
+    const Vec4 *joints0    { nullptr }; size_t nj { 0 };
+    const Vec4 *weights0   { nullptr }; size_t nw { 0 };
+
+    std::vector<uint>        triangles;
+    std::string              error;
+    std::vector<std::string> warnings;
+  };
+
  private:
-  bool parseJson(const std::string &str, JsonData &json) const;
+  bool parseJson(std::string_view str, JsonData &json) const;
 
   bool processData();
 
   bool processSparseAccessor(const IndName &indName, const Accessor &accessor);
-  bool processAccessor(const IndName &indName, const Accessor &accessor);
+  bool processAccessor(const Accessor &accessor, const AccessorView &view,
+                       MeshData &meshData) const;
+
+  bool readMeshData(const AccessorView &view, MeshData &meshData) const;
 
-  bool readMeshData(const AccessorData &accessorData, MeshData &meshData) const;
+  bool getAccessorView(const IndName &bufferView, long byteOffset, const std::string &type,
+                       long componentType, long count, AccessorView &view);
 
   const uchar *getAccessorBufferData(const IndName &accessorBufferView, long accessorByteOffset,
                                      long &byteLength, int &byteStride);
 
-  float  readFloat(const uchar *data, long i) const;
-  ushort readShort(const uchar *data, long i) const;
-  uint   readInt  (const uchar *data, long i) const;
-  uchar  readByte (const uchar *data, long i) const;
-
   bool getChunk(long ind, Chunk* &chunk) const;
 
   void processSkins();
@@ -629,26 +711,43 @@ class CImportGLTF : public CImportBase {
   bool processNodeMesh(Node *node);
 
   void initNodeData(Node *node, CGeomNodeData &nodeData) const;
+  void initNodesData();
 
   bool createNodeObject(Node *node, const CMatrix3D &m1);
-  void createNodeObj(Node *node);
+  void createNodeObj(Node *node, CGeomObject3D *meshObject=nullptr);
+
+  bool getNodeInstanceTransforms(const Node *node, std::vector<CMatrix3D> &transforms) const;
+
+  bool createNodeInstances(Node *node, const std::vector<CMatrix3D> &transforms);
+  void expandNodeInstances(Node *node, const std::vector<CMatrix3D> &transforms);
+
+  CGeomObject3D *getMeshObject(const Mesh &mesh);
 
   CMatrix3D calcNodeTransform(Node *node) const;
 
   CMatrix3D calcNodeGlobalTransform(Node *node) const;
 
-  bool processMesh(Node *node, const Mesh &mesh);
+  bool processMesh(CGeomObject3D *object, const IndName &skinName, const Mesh &mesh);
+
+  void preparePrimitive(const Primitive &primitive, PrimitiveGeom &geom) const;
+
+  const PrimitiveGeom *getPrimitiveGeom(const Primitive &primitive) const;
+
+  void dumpPrimitive(const Primitive &primitive) const;
 
   bool resolveImage(const Image &image);
+  bool recordImage(const Image &image);
+  void prefetchMaterialImages(const IndName &materialName);
   bool getImageData(const Image &image, const uchar* &data, long &len);
+  bool getImageFile(const Image &image, std::string &filename) const;
 
-  bool getBufferView(const IndName &indName, BufferView &bufferView) const;
-  bool getBuffer    (const IndName &indName, Buffer &buffer) const;
+  bool getBufferView(const IndName &indName, const BufferView* &bufferView) const;
+  bool getBuffer    (const IndName &indName, const Buffer* &buffer) const;
   bool getMaterial  (const IndName &indName, Material* &material) const;
   bool getTexture   (const IndName &indName, Texture* &texture) const;
   bool getNode      (const IndName &indName, Node* &node) const;
-  bool getAccessor  (const IndName &indName, Accessor &accessor) const;
-  bool getMesh      (const IndName &indName, Mesh &mesh) const;
+  bool getAccessor  (const IndName &indName, const Accessor* &accessor) const;
+  bool getMesh      (const IndName &indName, const Mesh* &mesh) const;
 
   bool resolveTexture(const IndName &textureName, Texture *texture);
 
@@ -707,6 +806,17 @@ class CImportGLTF : public CImportBase {
   // meshes
   IndNameMap<MeshData> meshDatas_;
 
+  // primitive geometry prepared for node meshes (during read)
+  std::map<const Primitive *, PrimitiveGeom> primitiveGeoms_;
+
+  //---
+
+  // shared mesh objects (built once per mesh)
+  std::map<const Mesh *, CGeomObject3D *> meshObjects_;
+
+  // number of unskinned nodes using each mesh
+  std::map<IndName, int> meshUseCount_;
+
   //---
 
   // uris
@@ -725,6 +835,20 @@ class CImportGLTF : public CImportBase {
 
   mutable UriDataMap uriDataMap_;
 
+  using MapFileP = std::unique_ptr<CImportMapFile>;
+
+  std::vector<MapFileP> uriMapFiles_;
+
+  //---
+
+  // mapped file (chunks reference its data)
+  CImportMapFile mapFile_;
+
+  //---
+
+  // images (decoded on first use, destroyed before the data they reference)
+  CImportImageCache imageCache_;
+
   //---
 
   // joints
@@ -0,0 +1,119 @@
+#ifndef CImportImageCache_H
+#define CImportImageCache_H
+
+#include <CImagePtr.h>
+#include <CFileType.h>
+
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Deferred image decoding.
+//
+// Importers record where an image comes from (file or encoded data) and only decode
+// it when the image is first used. Recorded images can be queued for decoding on
+// background worker threads, and at most maxImages decoded images are kept (least
+// recently used images are dropped and decoded again from their source if needed).
+class CImportImageCache {
+ public:
+  using Id = uint;
+
+  CImportImageCache() { }
+
+ ~CImportImageCache();
+
+  CImportImageCache(const CImportImageCache &) = delete;
+  CImportImageCache &operator=(const CImportImageCache &) = delete;
+
+  //! background decode threads (0 decodes on first use in calling thread)
+  uint numWorkers() const { return numWorkers_; }
+  void setNumWorkers(uint n);
+
+  //! max decoded images kept (0 is unlimited)
+  size_t maxImages() const { return maxImages_; }
+  void setMaxImages(size_t n) { maxImages_ = n; }
+
+  //! record image file (same file returns same id)
+  Id addFile(const std::string &filename, bool flipH=false);
+
+  //! record encoded image data (data must stay valid while cache exists)
+  Id addData(const uchar *data, long len, CFileType type, bool flipH=false);
+
+  size_t numImages() const;
+
+  const std::string &filename(Id id) const;
+
+  bool isDecoded(Id id) const;
+
+  //! queue image for decode on worker thread (no-op without workers)
+  void prefetch(Id id);
+
+  //! decoded image (decoded now or waits for worker if not done), null on failure
+  CImagePtr image(Id id);
+
+  //! stop workers and drop all images
+  void clear();
+
+ private:
+  enum class State {
+    SOURCE,
+    QUEUED,
+    DECODING,
+    DECODED,
+    FAILED
+  };
+
+  struct Source {
+    std::string  filename;
+    const uchar* data  { nullptr };
+    long         len   { 0 };
+    CFileType    type  { CFILE_TYPE_NONE };
+    bool         flipH { false };
+  };
+
+  struct Entry {
+    Source    source;
+    State     state   { State::SOURCE };
+    CImagePtr image;
+    size_t    lastUse { 0 };
+  };
+
+  static CImagePtr decode(const Source &source);
+
+  void startWorkers();
+  void stopWorkers();
+
+  void workerLoop();
+
+  void finish(Id id, const CImagePtr &image);
+
+  void evict();
+
+ private:
+  using Entries = std::deque<Entry>;
+  using FileIds = std::map<std::string, Id>;
+  using Queue   = std::deque<Id>;
+  using Threads = std::vector<std::thread>;
+
+  Entries entries_;
+  FileIds fileIds_;
+
+  uint   numWorkers_ { 0 };
+  size_t maxImages_  { 256 };
+  size_t numDecoded_ { 0 };
+  size_t useCount_   { 0 };
+
+  Queue   queue_;
+  Threads workers_;
+  bool    stop_ { false };
+
+  mutable std::mutex      mutex_;
+  std::condition_variable queueCond_;
+  std::condition_variable doneCond_;
+};
+
+#endif
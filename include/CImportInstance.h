@@ -0,0 +1,66 @@
+#ifndef CImportInstance_H
+#define CImportInstance_H
+
+#include <CMatrix3D.h>
+#include <CRGBA.h>
+
+#include <optional>
+#include <string>
+#include <vector>
+
+class CGeomObject3D;
+class CGeomMaterial;
+
+// object drawn from a shared mesh
+struct CImportInstance {
+  std::string          name;
+  CGeomObject3D*       mesh      { nullptr }; //!< shared mesh (scene primitive)
+  bool                 owned     { false };   //!< mesh copied for this instance
+  int                  node      { -1 };      //!< source node index (-1 if none)
+  CMatrix3D            transform { CMatrix3D::identity() }; //!< global transform
+  CGeomMaterial*       material  { nullptr }; //!< material override
+  std::optional<CRGBA> faceColor;             //!< face color override
+  std::optional<bool>  shadowed;              //!< shadowed override
+};
+
+// instances of one mesh (drawn with a single instanced draw)
+struct CImportInstanceGroup {
+  CGeomObject3D*                       mesh { nullptr };
+  std::vector<const CImportInstance *> instances;
+};
+
+// Shared mesh instancing for importers.
+//
+// When instancing is on the importer records an instance (shared mesh plus transform
+// and overrides) for each repeated object instead of adding a copy of the mesh to the
+// scene. The shared meshes are owned by the scene as primitives.
+//
+// Instancing is off by default. Instances are not scene objects so it is only for
+// callers that draw instanceGroups() themselves (the qsrc/qcamera viewers draw scene
+// objects only and load with instancing off).
+class CImportInstancing {
+ public:
+  using Instance       = CImportInstance;
+  using Instances      = std::vector<Instance>;
+  using InstanceGroup  = CImportInstanceGroup;
+  using InstanceGroups = std::vector<InstanceGroup>;
+
+ public:
+  CImportInstancing() { }
+
+  virtual ~CImportInstancing() { }
+
+  bool isInstancing() const { return instancing_; }
+  void setInstancing(bool b) { instancing_ = b; }
+
+  const Instances &instances() const { return instances_; }
+
+  //! instances grouped by mesh (in first use order)
+  InstanceGroups instanceGroups() const;
+
+ protected:
+  bool      instancing_ { false };
+  Instances instances_;
+};
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef CImportMapFile_H
+#define CImportMapFile_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstddef>
+
+// Read only view of a whole file.
+//
+// The file is memory mapped when the platform supports it, otherwise it is read
+// into an owned buffer, so callers can always parse the contents in place.
+class CImportMapFile {
+ public:
+  CImportMapFile() { }
+
+  explicit CImportMapFile(const std::string &filename, bool map=true) { open(filename, map); }
+
+ ~CImportMapFile() { close(); }
+
+  CImportMapFile(const CImportMapFile &) = delete;
+  CImportMapFile &operator=(const CImportMapFile &) = delete;
+
+  //! open file (map false reads whole file into memory with a single read)
+  bool open(const std::string &filename, bool map=true);
+
+  void close();
+
+  bool isOpen() const { return open_; }
+
+  //! true if data is mapped (false if read into memory)
+  bool isMapped() const { return mapped_; }
+
+  const unsigned char *data() const { return data_; }
+
+  const char *chars() const { return reinterpret_cast<const char *>(data_); }
+
+  size_t size() const { return size_; }
+
+  std::string_view view() const { return std::string_view(chars(), size_); }
+
+  //! drop mapped pages before pos (already parsed) from resident memory
+  void releaseTo(size_t pos);
+
+ private:
+  bool readFile(int fd);
+
+ private:
+  using Buffer = std::vector<unsigned char>;
+
+  bool                 open_   { false };
+  bool                 mapped_ { false };
+  const unsigned char* data_   { nullptr };
+  size_t               size_   { 0 };
+  size_t               released_ { 0 };
+  Buffer               buffer_;
+};
+
+#endif
@@ -2,9 +2,12 @@
 #define CIMPORT_OBJ_H
 
 #include <CImportBase.h>
+#include <CImportImageCache.h>
 #include <CGeomObject3D.h>
 #include <CFile.h>
 
+#include <string_view>
+
 class CImportObj : public CImportBase {
  public:
   CImportObj(CGeomScene3D *scene=nullptr, const std::string &name="obj");
@@ -14,6 +17,19 @@ class CImportObj : public CImportBase {
   bool isSplitByMaterial() const { return splitByMaterial_; }
   void setSplitByMaterial(bool b) { splitByMaterial_ = b; }
 
+  //! report time spent in each threaded read phase
+  bool isTiming() const { return timing_; }
+  void setTiming(bool b) { timing_ = b; }
+
+  struct PhaseTimes {
+    double decode  { 0.0 }; //!< chunk decode (parallel)
+    double resolve { 0.0 }; //!< relative index resolve (parallel)
+    double merge   { 0.0 }; //!< add chunk records to objects (serial)
+  };
+
+  //! seconds spent in each phase of last threaded read
+  const PhaseTimes &phaseTimes() const { return phaseTimes_; }
+
   bool read(CFile &file) override;
 
   CGeomScene3D &getScene() override { return *scene_; }
@@ -37,6 +53,20 @@ class CImportObj : public CImportBase {
 
  private:
   struct Material;
+  struct MapImage;
+  struct ChunkData;
+
+  bool readLines();
+  bool readMapped(std::string_view data);
+  bool readParallel(std::string_view data);
+
+  void parseChunk(std::string_view data, ChunkData &chunk) const;
+  void mergeChunk(const ChunkData &chunk);
+
+  bool parseVertex       (std::string_view line);
+  bool parseTextureVertex(std::string_view line);
+  bool parseVertexNormal (std::string_view line);
+  bool parseFace         (std::string_view line);
 
   bool readVertex(const std::string &line);
   bool readTextureVertex(const std::string &line);
@@ -45,18 +75,26 @@ class CImportObj : public CImportBase {
   bool readGroupName(const std::string &line);
   bool readFace(const std::string &line);
 
+  void setObjectName(const std::string &name);
+  void useMaterial(const std::string &name);
+
+  bool addFace();
+
   bool readMaterialFile(const std::string &filename);
 
   Material *addMaterial(const std::string &name);
 
+  void setMapImage(MapImage &map, const std::string &filename);
+
  private:
   using OptColor = std::optional<CRGBA>;
   using OptReal  = std::optional<double>;
   using OptInt   = std::optional<int>;
 
   struct MapImage {
-    std::string name;  // empty when unset
-    CImagePtr   image;
+    std::string           name;  // empty when unset
+    CImportImageCache::Id id { 0 };
+    CImagePtr             image; // set on first use
   };
 
   struct Material {
@@ -90,6 +128,8 @@ class CImportObj : public CImportBase {
   };
 
   using Materials     = std::map<std::string, Material *>;
+  using FaceVertices  = std::vector<uint>;
+  using FaceIndices   = std::vector<long>;
 //using TexturePoints = std::vector<CPoint3D>;
 //using NormalPoints  = std::vector<CPoint3D>;
 
@@ -110,8 +150,22 @@ class CImportObj : public CImportBase {
 //TexturePoints  texturePoints_;
 //NormalPoints   normalPoints_;
 
+  // current face data (reused between faces)
+  FaceVertices           faceVertices_;
+  FaceIndices            faceTexturePoints_;
+  FaceIndices            faceNormals_;
+  FaceVertices           faceVertices1_;
+  std::vector<CPoint2D>  faceTexturePoints1_;
+  std::vector<CVector3D> faceNormals1_;
+
   int  numObjects_      { 0 };
   bool splitByMaterial_ { true };
+  bool timing_          { false };
+
+  PhaseTimes phaseTimes_;
+
+  // material images
+  CImportImageCache imageCache_;
 
   mutable CFile* file_ { nullptr };
 };
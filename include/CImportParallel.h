@@ -0,0 +1,66 @@
+#ifndef CImportParallel_H
+#define CImportParallel_H
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <cstddef>
+
+namespace CImportParallel {
+
+//! resolve requested thread count (0 is one per hardware core)
+inline unsigned int numThreads(unsigned int n) {
+  if (n == 0)
+    n = std::thread::hardware_concurrency();
+
+  return (n > 0 ? n : 1);
+}
+
+//! call func(i) for i in [0, n) using up to numThreads threads
+//! (items are handed out one at a time so uneven items balance out)
+template<typename FUNC>
+void parallelFor(size_t n, unsigned int numThreads, FUNC func) {
+  if (n == 0)
+    return;
+
+  auto nt = size_t(CImportParallel::numThreads(numThreads));
+
+  if (nt > n)
+    nt = n;
+
+  if (nt <= 1) {
+    for (size_t i = 0; i < n; ++i)
+      func(i);
+
+    return;
+  }
+
+  std::atomic<size_t> next { 0 };
+
+  auto worker = [&]() {
+    for (;;) {
+      auto i = next.fetch_add(1);
+
+      if (i >= n)
+        break;
+
+      func(i);
+    }
+  };
+
+  std::vector<std::thread> threads;
+
+  threads.reserve(nt - 1);
+
+  for (size_t i = 1; i < nt; ++i)
+    threads.emplace_back(worker);
+
+  worker();
+
+  for (auto &thread : threads)
+    thread.join();
+}
+
+}
+
+#endif
@@ -5,6 +5,7 @@
 #include <CGeomObject3D.h>
 #include <CFile.h>
 
+#include <algorithm>
 #include <set>
 
 class CImportPly : public CImportBase {
@@ -21,6 +22,112 @@ class CImportPly : public CImportBase {
     DOUBLE
   };
 
+ public:
+  // packed per channel (SoA) vertex values
+  struct VertexData {
+    enum Channel {
+      X, Y, Z,
+      R, G, B, A,
+      NX, NY, NZ,
+      S, T,
+      NUM_CHANNELS
+    };
+
+    using Values = std::vector<float>;
+
+    void clear() {
+      for (int c = 0; c < NUM_CHANNELS; ++c) {
+        channels[c].clear();
+
+        has[c] = false;
+      }
+
+      size = 0;
+    }
+
+    void resize(size_t n) {
+      for (int c = 0; c < NUM_CHANNELS; ++c) {
+        if (has[c])
+          channels[c].resize(n);
+      }
+
+      size = n;
+    }
+
+    //! append vertex i of vertices (same channels)
+    void append(const VertexData &vertices, size_t i) {
+      for (int c = 0; c < NUM_CHANNELS; ++c) {
+        if (has[c])
+          channels[c].push_back(vertices.channels[c][i]);
+      }
+
+      ++size;
+    }
+
+    //! append all vertices
+    void append(const VertexData &vertices) {
+      for (int c = 0; c < NUM_CHANNELS; ++c) {
+        has[c] = vertices.has[c];
+
+        if (has[c]) {
+          channels[c].resize(size);
+
+          channels[c].insert(channels[c].end(),
+                             vertices.channels[c].begin(), vertices.channels[c].end());
+        }
+      }
+
+      size += vertices.size;
+    }
+
+    size_t size { 0 };
+    Values channels[NUM_CHANNELS];
+    bool   has     [NUM_CHANNELS] { };
+  };
+
+  // flat face vertex index lists
+  struct FaceData {
+    using Starts  = std::vector<size_t>;
+    using Indices = std::vector<int>;
+
+    void clear() { starts.clear(); inds.clear(); }
+
+    size_t size() const { return starts.size(); }
+
+    size_t numInds(size_t i) const {
+      return (i + 1 < starts.size() ? starts[i + 1] : inds.size()) - starts[i];
+    }
+
+    const int *faceInds(size_t i) const { return &inds[starts[i]]; }
+
+    //! append all faces
+    void append(const FaceData &faces) {
+      auto offset = inds.size();
+
+      for (auto start : faces.starts)
+        starts.push_back(start + offset);
+
+      inds.insert(inds.end(), faces.inds.begin(), faces.inds.end());
+    }
+
+    Starts  starts;
+    Indices inds;
+  };
+
+  //! receives decoded element batches from readStream
+  //! (batch data is only valid for the call and may be moved from,
+  //!  return false to stop reading)
+  class StreamProc {
+   public:
+    StreamProc() { }
+
+    virtual ~StreamProc() { }
+
+    virtual bool vertices(VertexData &, size_t /*first*/) { return true; }
+
+    virtual bool faces(FaceData &, size_t /*first*/) { return true; }
+  };
+
  public:
   static bool stringToFormat(const std::string &format, FormatType &formatType);
 
@@ -28,8 +135,26 @@ class CImportPly : public CImportBase {
 
  ~CImportPly();
 
+  //! number of vertices/faces per readStream batch
+  size_t batchSize() const { return batchSize_; }
+  void setBatchSize(size_t n) { batchSize_ = std::max(n, size_t(1)); }
+
+  //! voxel grid decimation (keep first point in each voxel) on read
+  double decimateVoxelSize() const { return decimateVoxelSize_; }
+  void setDecimateVoxelSize(double r) { decimateVoxelSize_ = r; }
+
+  //! max decimated points (voxel size is doubled until points fit)
+  size_t decimateMaxPoints() const { return decimateMaxPoints_; }
+  void setDecimateMaxPoints(size_t n) { decimateMaxPoints_ = n; }
+
+  bool isDecimate() const { return (decimateVoxelSize_ > 0.0 || decimateMaxPoints_ > 0); }
+
   bool read(CFile &file) override;
 
+  //! read elements from mapped file in batches without building object
+  //! (memory use is bounded by batch size)
+  bool readStream(CFile &file, StreamProc &proc);
+
   CGeomScene3D &getScene() override { return *scene_; }
 
   CGeomObject3D &getObject() { return *object_; }
@@ -48,25 +173,6 @@ class CImportPly : public CImportBase {
   }
 
  private:
-  struct Vertex {
-    double x  { 0.0 };
-    double y  { 0.0 };
-    double z  { 0.0 };
-    double r  { 1.0 };
-    double g  { 1.0 };
-    double b  { 1.0 };
-    double a  { 0.0 };
-    double nx { 0.0 };
-    double ny { 0.0 };
-    double nz { 0.0 };
-    double s  { 0.0 };
-    double t  { 0.0 };
-  };
-
-  struct Face {
-    std::vector<int> inds;
-  };
-
   struct TexturePoint {
     uchar tx { 0 };
     float u  { 0.0f };
@@ -79,8 +185,6 @@ class CImportPly : public CImportBase {
     std::vector<int> inds;
   };
 
-  using Vertices      = std::vector<Vertex>;
-  using Faces         = std::vector<Face>;
   using TexturePoints = std::vector<TexturePoint>;
   using TextureFaces  = std::vector<TextureFace>;
 
@@ -109,16 +213,68 @@ class CImportPly : public CImportBase {
   using ElementCount      = std::map<std::string, int>;
   using ElementProperties = std::map<std::string, Properties>;
 
+  //---
+
+  // binary decode plan compiled from header
+  enum class ElementType {
+    NONE,
+    VERTEX,
+    FACE,
+    TEXTURE_VERTEX,
+    TEXTURE_FACE
+  };
+
+  // property target (vertex channel or named value)
+  enum Target {
+    TARGET_NONE      = -1,
+    TARGET_TX        = VertexData::NUM_CHANNELS,
+    TARGET_TN,
+    TARGET_U,
+    TARGET_V,
+    TARGET_INDICES
+  };
+
+  struct PropertyPlan {
+    FormatType type      { FormatType::NONE }; // value (or list item) type
+    FormatType countType { FormatType::NONE }; // list count type
+    bool       list      { false };
+    size_t     offset    { 0 };                // offset in record (fixed size records)
+    int        target    { TARGET_NONE };
+    float      scale     { 1.0f };             // normalize integer colors
+  };
+
+  using PropertyPlans = std::vector<PropertyPlan>;
+
+  struct ElementPlan {
+    std::string   name;
+    ElementType   type   { ElementType::NONE };
+    size_t        count  { 0 };
+    size_t        stride { 0 }; // record size (0 if has list properties)
+    PropertyPlans props;
+  };
+
+  using ElementPlans = std::vector<ElementPlan>;
+
  private:
-  bool readAscii();
-  bool readBinary();
+  class VoxelGrid;
+
+  bool readHeader();
+
+  bool readElements(StreamProc &proc, size_t batchSize, bool map);
+
+  bool readAscii(StreamProc &proc, size_t batchSize);
+  bool readBinary(StreamProc &proc, size_t batchSize, bool map);
 
   Properties &getElementProperties(const std::string &name);
 
-  bool readFloat(float *f) const;
-  bool readInt  (int   *i) const;
-  bool readUInt (uint  *i) const;
-  bool readUChar(uchar *i) const;
+  bool compilePlans();
+
+  bool decodeFixed(const ElementPlan &plan, const uchar *data, size_t n);
+  bool decodeVertices(const ElementPlan &plan, const uchar *data, size_t n, VertexData &vertices) const;
+  bool decodeVariable(const ElementPlan &plan, const uchar *data, const uchar *end,
+                      size_t n, size_t &len, FaceData &faces);
+
+  void buildObject();
 
  private:
   CGeomScene3D*  scene_   { nullptr };
@@ -131,10 +287,18 @@ class CImportPly : public CImportBase {
   ElementCount      elementCount_;
   ElementProperties elementProperties_;
 
+  bool ascii_      { false };
   bool big_endian_ { false };
 
-  Vertices      vertices_;
-  Faces         faces_;
+  size_t batchSize_         { 1024*1024 };
+  double decimateVoxelSize_ { 0.0 };
+  size_t decimateMaxPoints_ { 0 };
+
+  ElementPlans plans_;
+  bool         swap_ { false };
+
+  VertexData    vertices_;
+  FaceData      faces_;
   TexturePoints texturePoints_;
   TextureFaces  textureFaces_;
 };
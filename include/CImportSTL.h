@@ -6,6 +6,7 @@
 #include <CFile.h>
 
 #include <set>
+#include <unordered_map>
 
 class CImportSTL : public CImportBase {
  public:
@@ -31,6 +32,33 @@ class CImportSTL : public CImportBase {
 
  ~CImportSTL();
 
+  //! collect set of triangle z values (binary files)
+  bool isCollectZVals() const { return collectZVals_; }
+  void setCollectZVals(bool b) { collectZVals_ = b; }
+
+  const ZVals &zvals() const { return zvals_; }
+
+  //! bounding box of binary file points
+  const Vector &minV() const { return minV_; }
+  const Vector &maxV() const { return maxV_; }
+
+  //---
+
+  //! weld (share) vertices with matching positions (within weld tolerance)
+  bool isWeldVertices() const { return weldVertices_; }
+  void setWeldVertices(bool b) { weldVertices_ = b; }
+
+  //! max per axis distance between welded positions (0 for exact match)
+  double weldTolerance() const { return weldTolerance_; }
+  void setWeldTolerance(double r) { weldTolerance_ = r; }
+
+  //! number of triangle vertices read and number of vertices added after welding
+  uint numInputVertices() const { return numInputVertices_; }
+  uint numWeldVertices() const { return uint(weldPoints_.size()); }
+
+  //! print vertex reduction and memory saved by welding of last read (if welding)
+  void printWeldStats() const;
+
   bool read(CFile &file) override;
 
   CGeomScene3D &getScene() override { return *scene_; }
@@ -54,6 +82,10 @@ class CImportSTL : public CImportBase {
   bool readBinary();
   bool readAscii();
 
+  int addVertex(const CPoint3D &p);
+
+  bool addTriangle(int i1, int i2, int i3, const CVector3D &n);
+
  private:
   CGeomScene3D*  scene_   { nullptr };
   SceneP         pscene_;
@@ -67,7 +99,40 @@ class CImportSTL : public CImportBase {
   Vector minV_;
   Vector maxV_;
 
+  bool  collectZVals_ { false };
   ZVals zvals_;
+
+  //---
+
+  // spatial hash cell for vertex welding
+  struct WeldCell {
+    int x { 0 };
+    int y { 0 };
+    int z { 0 };
+
+    bool operator==(const WeldCell &c) const { return (x == c.x && y == c.y && z == c.z); }
+  };
+
+  struct WeldCellHash {
+    size_t operator()(const WeldCell &c) const {
+      return (size_t(c.x)*73856093) ^ (size_t(c.y)*19349663) ^ (size_t(c.z)*83492791);
+    }
+  };
+
+  using WeldCells = std::unordered_map<WeldCell, int, WeldCellHash>;
+  using WeldInds  = std::vector<int>;
+  using WeldPts   = std::vector<CPoint3D>;
+
+  bool   weldVertices_  { false };
+  double weldTolerance_ { 0.0 };
+
+  WeldCells weldCells_;   // cell to first welded point in cell
+  WeldPts   weldPoints_;  // welded point positions
+  WeldInds  weldNext_;    // next welded point in same cell (-1 for end)
+  WeldInds  weldVertex_;  // object vertex of welded point
+
+  uint numInputVertices_ { 0 };
+  uint numDegenerate_    { 0 };
 };
 
 #endif
@@ -2,6 +2,7 @@
 #define CIMPORT_SCENE_H
 
 #include <CImportBase.h>
+#include <CImportInstance.h>
 
 #include <CFile.h>
 #include <CMatrix3D.h>
@@ -9,6 +10,7 @@
 
 #include <map>
 #include <optional>
+#include <vector>
 
 class CGeomScene3D;
 class CGeomObject3D;
@@ -18,7 +20,9 @@ class CGeomVertex3D;
 class CGeomTexture;
 class CGeomMaterial;
 
-class CImportScene : public CImportBase {
+// when instancing scene objects reference shared primitive meshes (see instances)
+// instead of being added to the scene as copies
+class CImportScene : public CImportBase, public CImportInstancing {
  public:
   CImportScene(CGeomScene3D *scene=nullptr, const std::string &name="scene");
 
@@ -38,6 +42,9 @@ class CImportScene : public CImportBase {
 
   bool write(CFile *file, CGeomScene3D *scene) const override;
 
+  //! mesh of instance to edit (shared mesh is copied on first edit)
+  CGeomObject3D *editInstance(size_t i);
+
  private:
   struct TransformData {
     CMatrix3D               matrix { CMatrix3D::identity() };
@@ -62,6 +69,7 @@ class CImportScene : public CImportBase {
   TransformData  readTransformData();
   CGeomObject3D *getObject(const std::string &name);
   CGeomObject3D *getPrimitive(const std::string &name);
+  CGeomObject3D *builtinPrimitive(const std::string &name);
 
   CGeomMaterial *getMaterial(const std::string &name) const;
 
@@ -86,7 +94,9 @@ class CImportScene : public CImportBase {
   void errorMsg(const std::string &msg) const;
 
  private:
-  using NameObjMap = std::map<std::string, CGeomObject3D *>;
+  using NameObjMap      = std::map<std::string, CGeomObject3D *>;
+  using NameInstanceMap = std::map<std::string, Instance>;
+  using Objects    = std::vector<CGeomObject3D *>;
   using Names      = std::vector<std::string>;
   using Materials  = std::vector<CGeomMaterial *>;
   using Textures   = std::vector<CGeomTexture *>;
@@ -97,11 +107,15 @@ class CImportScene : public CImportBase {
   SceneP        pscene_;
   NameObjMap    objects_;
   NameObjMap    primitives_;
+  NameObjMap    builtins_;
+  Objects       unsharedBuiltins_; //!< builtins not owned by scene
   Names         colors_;
   Textures      textures_;
   Materials     materials_;
   int           orientation_ { 1 };
 
+  NameInstanceMap objectInstances_;
+
   mutable CFile* file_ { nullptr };
 };
 
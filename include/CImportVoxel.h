@@ -5,6 +5,13 @@
 #include <CGeomObject3D.h>
 #include <CFile.h>
 
+class CVoxel;
+
+// Import MagicaVoxel model.
+//
+// By default the voxels are meshed from an occupancy grid: faces between two solid
+// voxels are culled and the visible faces in each slice are greedily merged into
+// rectangles of the same color. Otherwise each voxel is added as a box.
 class CImportVoxel : public CImportBase {
  public:
   CImportVoxel(CGeomScene3D *scene=nullptr, const std::string &name="vox");
@@ -13,6 +20,10 @@ class CImportVoxel : public CImportBase {
 
   bool read(CFile &file) override;
 
+  //! merge visible voxel faces (false adds a box per voxel)
+  bool isGreedyMesh() const { return greedyMesh_; }
+  void setGreedyMesh(bool b) { greedyMesh_ = b; }
+
   CGeomScene3D &getScene() override { return *scene_; }
 
   CGeomObject3D &getObject() { return *object_; }
@@ -30,12 +41,18 @@ class CImportVoxel : public CImportBase {
     return object_;
   }
 
+ private:
+  void addBoxes(const CVoxel &voxel, const CPoint3D &center, double scale);
+
+  void addGreedyMesh(const CVoxel &voxel, const CPoint3D &center, double scale);
+
  private:
   CGeomScene3D*  scene_  { nullptr };
   SceneP         pscene_;
   CGeomObject3D* object_ { nullptr };
   ObjectP        pobject_;
   CFile*         file_   { nullptr };
+  bool           greedyMesh_ { true };
 };
 
 #endif
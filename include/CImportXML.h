@@ -0,0 +1,152 @@
+#ifndef CImportXML_H
+#define CImportXML_H
+
+#include <functional>
+#include <set>
+#include <string>
+#include <vector>
+#include <cstddef>
+
+class CImportXMLTag;
+
+class CImportXMLOption {
+ public:
+  CImportXMLOption(const std::string &name, const std::string &value) :
+   name_(name), value_(value) {
+  }
+
+  const std::string &getName () const { return name_ ; }
+  const std::string &getValue() const { return value_; }
+
+ private:
+  std::string name_;
+  std::string value_;
+};
+
+class CImportXMLToken {
+ public:
+  explicit CImportXMLToken(CImportXMLTag *tag) : tag_(tag) { }
+
+ ~CImportXMLToken();
+
+  CImportXMLToken(const CImportXMLToken &) = delete;
+  CImportXMLToken &operator=(const CImportXMLToken &) = delete;
+
+  bool isTag() const { return (tag_ != nullptr); }
+
+  CImportXMLTag *getTag() const { return tag_; }
+
+ private:
+  CImportXMLTag *tag_ { nullptr };
+};
+
+class CImportXMLTag {
+ public:
+  using Options  = std::vector<CImportXMLOption *>;
+  using Children = std::vector<CImportXMLToken *>;
+  using Reals    = std::vector<double>;
+  using Ints     = std::vector<int>;
+
+  CImportXMLTag(CImportXMLTag *parent, const std::string &name) :
+   parent_(parent), name_(name) {
+  }
+
+ ~CImportXMLTag();
+
+  CImportXMLTag(const CImportXMLTag &) = delete;
+  CImportXMLTag &operator=(const CImportXMLTag &) = delete;
+
+  CImportXMLTag *getParent() const { return parent_; }
+
+  const std::string &getName() const { return name_; }
+
+  const Options &getOptions() const { return options_; }
+  size_t getNumOptions() const { return options_.size(); }
+
+  const Children &getChildren() const { return children_; }
+  size_t getNumChildren() const { return children_.size(); }
+  size_t getNumTagChildren() const { return children_.size(); }
+
+  //! text content (trimmed, empty for number array tags)
+  const std::string &getText() const { return text_; }
+
+  //! numbers parsed from text of real/int array tags
+  const Reals &getReals() const { return reals_; }
+  const Ints  &getInts () const { return ints_ ; }
+
+  Reals takeReals() { return std::move(reals_); }
+  Ints  takeInts () { return std::move(ints_ ); }
+
+ private:
+  friend class CImportXML;
+
+  CImportXMLTag* parent_ { nullptr };
+  std::string    name_;
+  Options        options_;
+  Children       children_;
+  std::string    text_;
+  Reals          reals_;
+  Ints           ints_;
+};
+
+//---
+
+// Streaming XML reader.
+//
+// Parses the document in a single pass and hands each complete child of the root tag
+// to a callback, deleting it afterwards, so the whole document tree is never held in
+// memory. Text of tags registered as number arrays is parsed straight into numbers
+// (sized from a "count" attribute when present) and never stored as text.
+class CImportXML {
+ public:
+  using TagFunc = std::function<bool (CImportXMLTag *tag)>;
+
+  CImportXML() { }
+
+  //! tags whose text is parsed as real/int numbers
+  void addRealArrayTag(const std::string &name) { realTags_.insert(name); }
+  void addIntArrayTag (const std::string &name) { intTags_ .insert(name); }
+
+  //! parse data calling rootFunc for root tag (options only) and childFunc for each
+  //! complete child of root (a false return stops the read)
+  bool read(const char *data, size_t len, const TagFunc &rootFunc, const TagFunc &childFunc);
+
+  const std::string &errorMsg() const { return errorMsg_; }
+
+ private:
+  enum class ArrayType {
+    NONE,
+    REAL,
+    INT
+  };
+
+  bool skipMisc();
+  bool skipTo(const char *str);
+
+  bool readStartTag(CImportXMLTag *parent, CImportXMLTag* &tag, bool &empty);
+  bool readEndTag(const CImportXMLTag *tag);
+  bool readContent(CImportXMLTag *tag, const TagFunc *childFunc);
+  bool readText(CImportXMLTag *tag);
+  bool readNumbers(CImportXMLTag *tag, ArrayType type);
+
+  bool readName(std::string &name);
+  void decodeText(const char *s, const char *e, std::string &str) const;
+
+  void skipSpace();
+  bool isNext(const char *str) const;
+
+  bool fail(const std::string &msg);
+
+ private:
+  using Names = std::set<std::string>;
+
+  const char* data_ { nullptr };
+  const char* pos_  { nullptr };
+  const char* end_  { nullptr };
+  Names       realTags_;
+  Names       intTags_;
+  size_t      numErrors_ { 0 };
+  std::string errorMsg_;
+};
+
+#endif
@@ -0,0 +1,104 @@
+#ifndef CSGMesh_H
+#define CSGMesh_H
+
+#include <CSG.h>
+
+#include <vector>
+
+namespace CSG {
+
+struct MeshOptions {
+  uint   numThreads { 1 };     //!< number of threads (0 for one per core)
+  bool   robust     { false }; //!< snapped exact plane tests and coplanar merge
+  double snapSize   { 1e-5 };  //!< robust grid size (coarsened for large coordinates)
+};
+
+// Index based CSG solid.
+//
+// Polygons are index ranges into a shared vertex array rather than lists of heap
+// allocated vertices. Each operation copies its operands into a per operation arena
+// (flat vertex, index, polygon and node arrays) where the BSP trees are built and
+// clipped iteratively, so deep trees can't overflow the stack and all memory used by
+// the operation is freed when it returns.
+//
+// With more than one thread the trees are built and clipped in parallel: the top of
+// each tree is built serially and larger subtrees below it (and chunks of clipped
+// nodes) are processed as separate tasks and merged back in a fixed order, so the
+// result is identical to the serial one.
+//
+// In robust mode vertices are snapped to a grid and split against exact (integer)
+// planes, fragments collapsed by snapping are dropped and coplanar fragments with the
+// same tag are merged after each operation. This stops slivers and cracks from
+// building up and keeps polygon counts bounded over long chains of operations.
+//
+// Each polygon has a tag (e.g. a color index) which is kept by the polygons split
+// from it.
+class Mesh {
+ public:
+  struct Vertex {
+    Vector pos;
+    Vector normal;
+  };
+
+  struct Polygon {
+    uint first { 0 }; //!< first index in indices
+    uint count { 0 }; //!< number of indices
+    uint tag   { 0 };
+  };
+
+  using Vertices = std::vector<Vertex>;
+  using Indices  = std::vector<uint>;
+  using Polygons = std::vector<Polygon>;
+  using Options  = MeshOptions;
+
+  Mesh() { }
+
+  uint addVertex(const Vector &pos, const Vector &normal);
+
+  //! add convex polygon from vertex indices (at least 3)
+  void addPolygon(const Indices &inds, uint tag=0);
+
+  //! set tag of all polygons
+  void setTag(uint tag);
+
+  const Vertices &vertices() const { return vertices_; }
+  const Indices  &indices () const { return indices_ ; }
+  const Polygons &polygons() const { return polygons_; }
+
+  uint numPolygons() const { return uint(polygons_.size()); }
+
+  const Vertex &polygonVertex(const Polygon &polygon, uint i) const {
+    return vertices_[indices_[polygon.first + i]];
+  }
+
+  //! space in either solid
+  Mesh unionOp(const Mesh &mesh, const Options &options=Options()) const;
+
+  //! space in this solid but not mesh
+  Mesh subtractOp(const Mesh &mesh, const Options &options=Options()) const;
+
+  //! space in both solids
+  Mesh intersectOp(const Mesh &mesh, const Options &options=Options()) const;
+
+  //! solid and empty space switched
+  Mesh inverseOp() const;
+
+  //---
+
+  static Mesh cube(const Vector &center=Vector(0, 0, 0), double radius=1.0);
+
+  static Mesh sphere(const Vector &center=Vector(0, 0, 0), double radius=1.0,
+                     int slices=48, int stacks=32);
+
+  static Mesh cylinder(const Vector &start=Vector(0, -1, 0), const Vector &end=Vector(0, 1, 0),
+                       double r=1.0, int slices=48);
+
+ private:
+  Vertices vertices_;
+  Indices  indices_;
+  Polygons polygons_;
+};
+
+}
+
+#endif
@@ -190,3 +190,8 @@ unix:LIBS += \
 -lCMath -lCRGBName -lCStrUtil -lCRegExp -lCOS \
 -lglut -lGLU \
 -ljpeg -lpng -ltre -lz
+
+# must match libCImportModel build (make ZSTD=1)
+contains(ZSTD, 1) {
+  LIBS += -lzstd
+}
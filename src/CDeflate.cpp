@@ -1,40 +1,514 @@
 #include <CDeflate.h>
 #include <zlib.h>
 
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
 namespace CDeflate {
 
+namespace {
+
+int windowBits(Format format, bool inflate) {
+  switch (format) {
+    case Format::GZIP: return 15 + 16;
+    case Format::RAW : return -15;
+    case Format::AUTO: return (inflate ? 15 + 32 : 15);
+    default          : return 15;
+  }
+}
+
+std::string zlibMsg(const z_stream &zs, int rc) {
+  if (zs.msg)
+    return zs.msg;
+
+  return "zlib error " + std::to_string(rc);
+}
+
+}
+
+//---
+
+BufferPool &
+bufferPool()
+{
+  static BufferPool pool;
+
+  return pool;
+}
+
+Bytes
+BufferPool::
+acquire(size_t n)
+{
+  Bytes bytes;
+
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    // smallest free buffer large enough, otherwise largest (grown by resize)
+    auto pb = buffers_.end();
+
+    for (auto p = buffers_.begin(); p != buffers_.end(); ++p) {
+      if (pb == buffers_.end()) {
+        pb = p;
+        continue;
+      }
+
+      auto fits  = ((*p ).capacity() >= n);
+      auto fitsB = ((*pb).capacity() >= n);
+
+      if      (fits && ! fitsB)
+        pb = p;
+      else if (fits && fitsB) {
+        if ((*p).capacity() < (*pb).capacity())
+          pb = p;
+      }
+      else if (! fits && ! fitsB) {
+        if ((*p).capacity() > (*pb).capacity())
+          pb = p;
+      }
+    }
+
+    if (pb != buffers_.end()) {
+      bytes = std::move(*pb);
+
+      buffers_.erase(pb);
+    }
+  }
+
+  bytes.resize(n);
+
+  return bytes;
+}
+
+void
+BufferPool::
+release(Bytes &&bytes)
+{
+  if (bytes.capacity() == 0)
+    return;
+
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  if (buffers_.size() >= maxBuffers_)
+    return;
+
+  buffers_.push_back(std::move(bytes));
+}
+
+size_t
+BufferPool::
+numBuffers() const
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  return buffers_.size();
+}
+
+void
+BufferPool::
+clear()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  buffers_.clear();
+}
+
+//---
+
+struct Inflater::Stream {
+  z_stream zs;
+  bool     init { false };
+};
+
+Inflater::
+Inflater(Format format) :
+ format_(format)
+{
+}
+
+Inflater::
+~Inflater()
+{
+  if (stream_ && stream_->init)
+    inflateEnd(&stream_->zs);
+}
+
+// initialize stream on first use, reset it (keeping allocated state) after that
 bool
-deflate_bytes(const std::vector<unsigned char> &idata, unsigned int idataLen,
-              std::vector<unsigned char> &odata, unsigned int odataLen)
+Inflater::
+begin()
+{
+  errorMsg_ = "";
+
+  if (! stream_) {
+    stream_ = std::make_unique<Stream>();
+
+    memset(&stream_->zs, 0, sizeof(stream_->zs));
+  }
+
+  auto &zs = stream_->zs;
+
+  zs.next_in  = Z_NULL;
+  zs.avail_in = 0;
+
+  if (! stream_->init) {
+    auto rc = inflateInit2(&zs, windowBits(format_, true));
+
+    if (rc != Z_OK)
+      return fail(zlibMsg(zs, rc));
+
+    stream_->init = true;
+  }
+  else {
+    auto rc = inflateReset(&zs);
+
+    if (rc != Z_OK)
+      return fail(zlibMsg(zs, rc));
+  }
+
+  return true;
+}
+
+bool
+Inflater::
+inflate(const unsigned char *idata, size_t ilen,
+        unsigned char *odata, size_t olen, size_t *outLen)
+{
+  if (outLen)
+    *outLen = 0;
+
+  if (ilen > UINT_MAX || olen > UINT_MAX)
+    return fail("Data too large");
+
+  if (! begin())
+    return false;
+
+  auto &zs = stream_->zs;
+
+  zs.next_in   = const_cast<unsigned char *>(idata);
+  zs.avail_in  = uInt(ilen);
+  zs.next_out  = odata;
+  zs.avail_out = uInt(olen);
+
+  auto rc = ::inflate(&zs, Z_FINISH);
+
+  if (outLen)
+    *outLen = olen - zs.avail_out;
+
+  if (rc == Z_STREAM_END)
+    return true;
+
+  if (rc == Z_BUF_ERROR || rc == Z_OK)
+    return fail(zs.avail_out == 0 ? "Output buffer too small" : "Truncated input");
+
+  return fail(zlibMsg(zs, rc));
+}
+
+bool
+Inflater::
+inflate(const unsigned char *idata, size_t ilen, Bytes &odata)
 {
-  ulong ilen = idataLen;
-  ulong olen = odataLen;
-  if (uncompress(odata.data(), &olen, idata.data(), ilen) != Z_OK)
+  if (ilen > UINT_MAX)
+    return fail("Data too large");
+
+  if (! begin())
     return false;
 
-#if 0
+  auto &zs = stream_->zs;
+
+  zs.next_in  = const_cast<unsigned char *>(idata);
+  zs.avail_in = uInt(ilen);
+
+  auto used = odata.size();
+
+  for (;;) {
+    auto n = std::min(chunkSize_, size_t(UINT_MAX));
+
+    odata.resize(used + n);
+
+    zs.next_out  = odata.data() + used;
+    zs.avail_out = uInt(n);
+
+    auto rc = ::inflate(&zs, Z_NO_FLUSH);
+
+    used += n - zs.avail_out;
+
+    if (rc == Z_STREAM_END)
+      break;
+
+    if (rc != Z_OK) {
+      odata.resize(used);
+
+      return fail(rc == Z_BUF_ERROR ? "Truncated input" : zlibMsg(zs, rc));
+    }
+  }
+
+  odata.resize(used);
+
+  return true;
+}
+
+bool
+Inflater::
+inflate(const ReadFunc &read, const WriteFunc &write)
+{
+  if (! begin())
+    return false;
+
+  auto &zs = stream_->zs;
+
+  auto n = std::min(chunkSize_, size_t(UINT_MAX));
+
+  auto ibuffer = bufferPool().acquire(n);
+  auto obuffer = bufferPool().acquire(n);
+
+  bool rc        = true;
+  bool needInput = true;
+
+  for (;;) {
+    // output may still be pending when last call filled output buffer
+    if (needInput && zs.avail_in == 0) {
+      auto len = read(ibuffer.data(), n);
+
+      if (len == 0) {
+        rc = fail("Truncated input");
+        break;
+      }
+
+      zs.next_in  = ibuffer.data();
+      zs.avail_in = uInt(std::min(len, n));
+    }
+
+    zs.next_out  = obuffer.data();
+    zs.avail_out = uInt(n);
+
+    auto zrc = ::inflate(&zs, Z_NO_FLUSH);
+
+    // buffer error is no progress (more input needed)
+    if (zrc != Z_OK && zrc != Z_STREAM_END && zrc != Z_BUF_ERROR) {
+      rc = fail(zlibMsg(zs, zrc));
+      break;
+    }
+
+    auto olen = n - zs.avail_out;
+
+    if (olen > 0 && ! write(obuffer.data(), olen)) {
+      rc = fail("Write failed");
+      break;
+    }
+
+    if (zrc == Z_STREAM_END)
+      break;
+
+    needInput = (zs.avail_out != 0);
+  }
+
+  bufferPool().release(std::move(ibuffer));
+  bufferPool().release(std::move(obuffer));
+
+  return rc;
+}
+
+bool
+Inflater::
+fail(const std::string &msg)
+{
+  errorMsg_ = msg;
+
+  return false;
+}
+
+//---
+
+struct Deflater::Stream {
   z_stream zs;
-  memset(&zs, 0, sizeof(zs));
+  bool     init { false };
+};
+
+Deflater::
+Deflater(Format format, int level) :
+ format_(format), level_(level)
+{
+}
+
+Deflater::
+~Deflater()
+{
+  if (stream_ && stream_->init)
+    deflateEnd(&stream_->zs);
+}
+
+// initialize stream on first use, reset it (keeping allocated state) after that
+bool
+Deflater::
+begin()
+{
+  errorMsg_ = "";
+
+  if (! stream_) {
+    stream_ = std::make_unique<Stream>();
 
-  if (deflateInit(&zs) != Z_OK)
+    memset(&stream_->zs, 0, sizeof(stream_->zs));
+  }
+
+  auto &zs = stream_->zs;
+
+  zs.next_in  = Z_NULL;
+  zs.avail_in = 0;
+
+  if (! stream_->init) {
+    auto rc = deflateInit2(&zs, level_, Z_DEFLATED, windowBits(format_, false),
+                           8, Z_DEFAULT_STRATEGY);
+
+    if (rc != Z_OK)
+      return fail(zlibMsg(zs, rc));
+
+    stream_->init = true;
+  }
+  else {
+    auto rc = deflateReset(&zs);
+
+    if (rc != Z_OK)
+      return fail(zlibMsg(zs, rc));
+  }
+
+  return true;
+}
+
+bool
+Deflater::
+deflate(const unsigned char *idata, size_t ilen, Bytes &odata)
+{
+  if (ilen > UINT_MAX)
+    return fail("Data too large");
+
+  if (! begin())
     return false;
 
-  zs.next_in  = const_cast<unsigned char *>(idata.data());
-  zs.avail_in = idataLen;
+  auto &zs = stream_->zs;
+
+  auto n = size_t(deflateBound(&zs, uLong(ilen)));
+
+  if (n > UINT_MAX)
+    return fail("Data too large");
+
+  auto used = odata.size();
+
+  odata.resize(used + n);
+
+  zs.next_in   = const_cast<unsigned char *>(idata);
+  zs.avail_in  = uInt(ilen);
+  zs.next_out  = odata.data() + used;
+  zs.avail_out = uInt(n);
 
-//auto buffer_size = deflateBound(&zs, dataLen);
-//std::vector<unsigned char> out_buffer(buffer_size);
-//zs.next_out = out_buffer.data();
-//zs.avail_out = static_cast<unsigned int>(buffer_size);
+  auto rc = ::deflate(&zs, Z_FINISH);
 
-  zs.next_out  = odata.data();
-  zs.avail_out = odataLen;
+  odata.resize(used + n - zs.avail_out);
 
-  deflate(&zs, Z_FINISH);
-  deflateEnd(&zs);
-#endif
+  if (rc != Z_STREAM_END)
+    return fail(zlibMsg(zs, rc));
 
   return true;
 }
 
+bool
+Deflater::
+deflate(const ReadFunc &read, const WriteFunc &write)
+{
+  if (! begin())
+    return false;
+
+  auto &zs = stream_->zs;
+
+  auto n = std::min(chunkSize_, size_t(UINT_MAX));
+
+  auto ibuffer = bufferPool().acquire(n);
+  auto obuffer = bufferPool().acquire(n);
+
+  bool rc  = true;
+  bool end = false;
+
+  for (;;) {
+    if (zs.avail_in == 0 && ! end) {
+      auto len = read(ibuffer.data(), n);
+
+      end = (len == 0);
+
+      zs.next_in  = ibuffer.data();
+      zs.avail_in = uInt(std::min(len, n));
+    }
+
+    auto flush = (end ? Z_FINISH : Z_NO_FLUSH);
+
+    int  zrc;
+    bool written = true;
+
+    // drain all output for this input
+    do {
+      zs.next_out  = obuffer.data();
+      zs.avail_out = uInt(n);
+
+      zrc = ::deflate(&zs, flush);
+
+      if (zrc == Z_STREAM_ERROR)
+        break;
+
+      auto olen = n - zs.avail_out;
+
+      if (olen > 0 && ! write(obuffer.data(), olen)) {
+        written = false;
+        break;
+      }
+    } while (zs.avail_out == 0);
+
+    if (zrc == Z_STREAM_ERROR) {
+      rc = fail(zlibMsg(zs, zrc));
+      break;
+    }
+
+    if (! written) {
+      rc = fail("Write failed");
+      break;
+    }
+
+    if (zrc == Z_STREAM_END)
+      break;
+  }
+
+  bufferPool().release(std::move(ibuffer));
+  bufferPool().release(std::move(obuffer));
+
+  return rc;
+}
+
+bool
+Deflater::
+fail(const std::string &msg)
+{
+  errorMsg_ = msg;
+
+  return false;
+}
+
+//---
+
+bool
+deflate_bytes(const std::vector<unsigned char> &idata, unsigned int idataLen,
+              std::vector<unsigned char> &odata, unsigned int odataLen)
+{
+  return deflate_bytes(idata.data(), idataLen, odata.data(), odataLen);
+}
+
+bool
+deflate_bytes(const unsigned char *idata, unsigned int idataLen,
+              unsigned char *odata, unsigned int odataLen)
+{
+  // one reusable stream per thread (callers may inflate in parallel)
+  thread_local Inflater inflater(Format::ZLIB);
+
+  return inflater.inflate(idata, idataLen, odata, odataLen);
+}
+
 }
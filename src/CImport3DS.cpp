@@ -2,7 +2,9 @@
 #include <CGeometry3D.h>
 #include <CMathGeom3D.h>
 
+#include <algorithm>
 #include <deque>
+#include <cstring>
 
 #define M3D_VERSION_ID       0x0002
 #define FLT_COLOR_24_ID      0x0010
@@ -125,6 +127,31 @@ chunk_names[] = {
   { 0                  , nullptr           , },
 };
 
+// little endian values from chunk data (independent of host byte order)
+static ushort
+getShort(const uchar *p)
+{
+  return ushort(p[0] | (p[1] << 8));
+}
+
+static uint
+getLong(const uchar *p)
+{
+  return uint(p[0]) | (uint(p[1]) << 8) | (uint(p[2]) << 16) | (uint(p[3]) << 24);
+}
+
+static float
+getFloat(const uchar *p)
+{
+  auto l = getLong(p);
+
+  float f;
+
+  memcpy(&f, &l, sizeof(float));
+
+  return f;
+}
+
 CImport3DS::
 CImport3DS(CGeomScene3D *scene, const std::string &) :
  scene_(scene)
@@ -758,14 +785,19 @@ CImport3DS::
 readPointArray(CImport3DSChunk *chunk, CGeomObject3D *object)
 {
   ushort num_points;
-  readShort(chunk, &num_points);
+  if (! readShort(chunk, &num_points))
+    return false;
+
+  // x, y, z floats per point
+  if (! readData(chunk, size_t(num_points)*12, chunkData_))
+    return false;
 
-  for (int i = 0; i < num_points; ++i) {
-    float x, y, z;
+  const auto *data = chunkData_.data();
 
-    readFloat(chunk, &x);
-    readFloat(chunk, &y);
-    readFloat(chunk, &z);
+  for (int i = 0; i < num_points; ++i, data += 12) {
+    auto x = getFloat(data    );
+    auto y = getFloat(data + 4);
+    auto z = getFloat(data + 8);
 
     if (isDebug()) {
       auto pad = getChunkPad(chunk);
@@ -787,12 +819,11 @@ bool
 CImport3DS::
 readFaceArray(CImport3DSChunk *chunk, CGeomObject3D *object)
 {
-  vertexFaceList_.clear();
-
   uint num_vertices = object->getNumVertices();
 
   ushort num_faces;
-  readShort(chunk, &num_faces);
+  if (! readShort(chunk, &num_faces))
+    return false;
 
   if (isDebug()) {
     auto pad = getChunkPad(chunk);
@@ -800,23 +831,35 @@ readFaceArray(CImport3DSChunk *chunk, CGeomObject3D *object)
     std::cout << pad  << "Num faces " << num_faces << "\n";
   }
 
+  // three point numbers and flags per face (followed by material/smooth group chunks)
+  if (! readData(chunk, size_t(num_faces)*8, chunkData_))
+    return false;
+
+  // sum of face normals per vertex
+  std::vector<CVector3D> vertexNormals(num_vertices, CVector3D(0, 0, 0));
+  std::vector<uint>      vertexNumFaces(num_vertices, 0);
+
+  const auto *data = chunkData_.data();
+
   ushort point_num[3];
 
-  for (int i = 0; i < num_faces; ++i) {
-    std::vector<uint> vertices;
+  for (int i = 0; i < num_faces; ++i, data += 8) {
+    uint vertices[3];
+
+    bool valid = true;
 
     for (int j = 0; j < 3; j++) {
-      readShort(chunk, &point_num[j]);
+      point_num[j] = getShort(data + 2*j);
 
       if (point_num[j] < num_vertices)
-        vertices.push_back(point_num[j]);
-      else
+        vertices[j] = point_num[j];
+      else {
         std::cerr << "Invalid Point Num " << point_num[j] << "\n";
+        valid = false;
+      }
     }
 
-    ushort flags; // point flags
-
-    readShort(chunk, &flags);
+    ushort flags = getShort(data + 6); // point flags
 
     if (isDebug()) {
       auto pad = getChunkPad(chunk);
@@ -831,6 +874,9 @@ readFaceArray(CImport3DSChunk *chunk, CGeomObject3D *object)
       std::cout << "\n";
     }
 
+    if (! valid)
+      continue;
+
     auto &vertex1 = object->getVertex(vertices[0]);
     auto &vertex2 = object->getVertex(vertices[1]);
     auto &vertex3 = object->getVertex(vertices[2]);
@@ -843,7 +889,7 @@ readFaceArray(CImport3DSChunk *chunk, CGeomObject3D *object)
     if (orient == CPolygonOrientation::ANTICLOCKWISE)
       std::swap(vertices[0], vertices[2]);
 
-    uint face_num = object->addFace(vertices);
+    uint face_num = object->addITriangle(vertices[0], vertices[1], vertices[2]);
 
     CGeomFace3D &face = object->getFace(face_num);
 
@@ -853,26 +899,21 @@ readFaceArray(CImport3DSChunk *chunk, CGeomObject3D *object)
 
     face.setNormal(normal);
 
-    for (int j = 0; j < 3; j++)
-      vertexFaceList_[point_num[j]].push_back(face_num);
+    for (int j = 0; j < 3; j++) {
+      vertexNormals [point_num[j]] += normal;
+      vertexNumFaces[point_num[j]] += 1;
+    }
   }
 
-  for (const auto &pvf : vertexFaceList_) {
-    auto &vertex = object->getVertex(pvf.first);
-
-    CVector3D normal(0, 0, 0);
-
-    for (const auto &pf1 : pvf.second) {
-      auto &face = object->getFace(pf1);
-
-      normal += face.getNormal();
-    }
+  for (uint i = 0; i < num_vertices; ++i) {
+    if (vertexNumFaces[i] == 0)
+      continue;
 
-    normal /= int(pvf.second.size());
+    auto normal = vertexNormals[i];
 
     normal.normalize();
 
-    vertex.setNormal(normal);
+    object->getVertex(i).setNormal(normal);
   }
 
   return true;
@@ -891,16 +932,16 @@ readMshMatGroup(CImport3DSChunk *chunk, CGeomObject3D *object)
   }
 
   ushort num_faces;
-  readShort(chunk, &num_faces);
+  if (! readShort(chunk, &num_faces))
+    return false;
 
-  std::vector<ushort> face_nums;
+  if (! readData(chunk, size_t(num_faces)*2, chunkData_))
+    return false;
 
-  for (ushort i = 0; i < num_faces; ++i) {
-    ushort face_num;
-    readShort(chunk, &face_num);
+  std::vector<ushort> face_nums(num_faces);
 
-    face_nums.push_back(face_num);
-  }
+  for (ushort i = 0; i < num_faces; ++i)
+    face_nums[i] = getShort(&chunkData_[2*i]);
 
   if (isDebug()) {
     auto pad = getChunkPad(chunk);
@@ -960,11 +1001,11 @@ readSmoothGroup(CImport3DSChunk *chunk)
     std::cout << pad << "Num Faces: " << num_faces << "\n";
   }
 
-  for (ushort i = 0; i < num_faces; ++i) {
-    uint smooth;
+  if (! readData(chunk, size_t(num_faces)*4, chunkData_))
+    return false;
 
-    if (! readLong(chunk, &smooth))
-      return false;
+  for (ushort i = 0; i < num_faces; ++i) {
+    auto smooth = getLong(&chunkData_[4*i]);
 
     if (smooth == 0) continue;
 
@@ -1041,10 +1082,15 @@ readMapCoords(CImport3DSChunk *chunk, CGeomObject3D *object)
   if (! readShort(chunk, &n))
     return false;
 
-  for (int i = 0; i < int(n); ++i) {
-    float x, y;
-    readFloat(chunk, &x);
-    readFloat(chunk, &y);
+  // u, v floats per texture point
+  if (! readData(chunk, size_t(n)*8, chunkData_))
+    return false;
+
+  const auto *data = chunkData_.data();
+
+  for (int i = 0; i < int(n); ++i, data += 8) {
+    auto x = getFloat(data    );
+    auto y = getFloat(data + 4);
 
     if (isDebug()) {
       auto pad = getChunkPad(chunk);
@@ -1106,17 +1152,43 @@ skipChunk(CImport3DSChunk *chunk)
                  " (" << chunk->left << ")\n";
   }
 
-  int c;
+  // seek past chunk data (clamped to end of file)
+  auto pos  = ulong(file_->getPos());
+  auto size = ulong(file_->getSize());
 
-  while (chunk->left > 0) {
-    c = file_->getC();
+  auto pos1 = std::min(pos + chunk->left, size);
 
-    if (c == EOF)
-      break;
+  file_->setPos(pos1);
 
-    adjustChunkLeft(chunk, sizeof(uchar));
+  adjustChunkLeft(chunk, int(chunk->left));
+
+  return true;
+}
+
+// read n bytes of chunk data with a single read
+bool
+CImport3DS::
+readData(CImport3DSChunk *chunk, size_t n, std::vector<uchar> &data)
+{
+  // on failure skip rest of chunk so stream stays aligned for following chunks
+  if (n > chunk->left) {
+    std::cerr << "Chunk data too short for " << getChunkName(chunk) << "\n";
+    skipChunk(chunk);
+    return false;
   }
 
+  data.resize(n);
+
+  auto pos = file_->getPos();
+
+  if (n > 0 && ! file_->read(&data[0], n)) {
+    file_->setPos(pos);
+    skipChunk(chunk);
+    return false;
+  }
+
+  adjustChunkLeft(chunk, int(n));
+
   return true;
 }
 
@@ -1,9 +1,83 @@
 #include <CImportBlend.h>
 #include <CGeometry3D.h>
 #include <CGeomScene3D.h>
+#include <CImportMapFile.h>
+#include <CDeflate.h>
+
+#ifdef CIMPORT_ZSTD
+#include <zstd.h>
+#endif
+
+#include <cstring>
 
 namespace {
 
+#ifdef CIMPORT_ZSTD
+// decompress all frames (Blender writes seekable format: independent frames followed
+// by a skippable seek table frame, which the stream decoder steps over).
+// Note: whole file is decompressed into memory, frames are not streamed on demand
+// so peak memory is compressed plus uncompressed size
+bool zstdDecompress(const uchar *data, ulong len, CDeflate::Bytes &bytes,
+                    std::string &errorMsg) {
+  auto *dctx = ZSTD_createDCtx();
+
+  if (! dctx) {
+    errorMsg = "Failed to create context";
+    return false;
+  }
+
+  bytes.reserve(4*len);
+
+  ZSTD_inBuffer input { data, len, 0 };
+
+  auto chunkSize = ZSTD_DStreamOutSize();
+
+  size_t used = 0;
+  size_t rc   = 0;
+
+  while (input.pos < input.size) {
+    bytes.resize(used + chunkSize);
+
+    ZSTD_outBuffer output { bytes.data() + used, chunkSize, 0 };
+
+    rc = ZSTD_decompressStream(dctx, &output, &input);
+
+    used += output.pos;
+
+    if (ZSTD_isError(rc)) {
+      errorMsg = ZSTD_getErrorName(rc);
+      break;
+    }
+  }
+
+  // flush remaining output
+  while (! ZSTD_isError(rc) && rc != 0) {
+    bytes.resize(used + chunkSize);
+
+    ZSTD_outBuffer output { bytes.data() + used, chunkSize, 0 };
+
+    rc = ZSTD_decompressStream(dctx, &output, &input);
+
+    if (! ZSTD_isError(rc) && output.pos == 0) {
+      errorMsg = "Truncated input";
+      rc       = size_t(-1);
+      break;
+    }
+
+    used += output.pos;
+
+    if (ZSTD_isError(rc))
+      errorMsg = ZSTD_getErrorName(rc);
+  }
+
+  bytes.resize(used);
+
+  ZSTD_freeDCtx(dctx);
+
+  return (errorMsg == "");
+}
+#endif
+
 struct LargeBHead8 {
   int      code   { 0 };
   int      SDNAnr { 0 };
@@ -37,6 +111,8 @@ CImportBlend(CGeomScene3D *scene, const std::string &name) :
 CImportBlend::
 ~CImportBlend()
 {
+  for (auto *mesh : meshes_)
+    delete mesh;
 }
 
 bool
@@ -45,138 +121,35 @@ read(CFile &file)
 {
   file_ = &file;
 
-  uchar header[18];
+  // whole file is mapped (or read with a single read) and blocks are decoded in place
+  CImportMapFile mapFile;
 
-  if (! file_->read(header, 12)) {
-    std::cerr << "Failed to read header\n";
+  if (! mapFile.open(file_->getPath(), isMapFile())) {
+    std::cerr << "Failed to read file\n";
     return false;
   }
 
-  header[13] = '\0';
-
-  if (strncmp(reinterpret_cast<char *>(&header[0]), "BLENDER", 6) != 0) {
-    std::cerr << "Invalid header\n";
-    return false;
-  }
-
-  // legacy
-  if (header[7] == '_' || header[7] == '-') {
-    if      (header[7] == '_')
-      pointerSize_ = 4;
-    else if (header[7] == '-')
-      pointerSize_ = 8;
-
-    if      (header[8] == 'v')
-      littleEndian_ = true;
-    else if (header[8] == 'V')
-      littleEndian_ = false;
-    else {
-      std::cerr << "Invalid endian char\n";
-      return false;
-    }
-
-    if (! isdigit(header[9]) || ! isdigit(header[10]) || ! isdigit(header[11])) {
-      std::cerr << "Invalid version\n";
-      return false;
-    }
-
-    legacy_ = true;
-  }
-  else {
-    if (! isdigit(header[7]) || ! isdigit(header[8])) {
-      std::cerr << "Invalid version\n";
-      return false;
-    }
-
-    char headerSizeStr[3];
-    memcpy(headerSizeStr, &header[7], 2);
-    headerSizeStr[2] = '\0';
-
-    int header_size = atoi(headerSizeStr);
-    if (header_size != 17) {
-      std::cerr << "Invalid header size\n";
-      return false;
-    }
-
-    file_->rewind();
-    if (! file_->read(header, 17)) {
-      std::cerr << "Failed to read header\n";
-      return false;
-    }
-
-    header[18] = '\0';
-
-    if (header[9] != '-') {
-      std::cerr << "Invalid pointer size char\n";
-      return false;
-    }
-
-    pointerSize_ = 8;
-
-    if (! isdigit(header[10]) || ! isdigit(header[11])) {
-      std::cerr << "Invalid version\n";
-      return false;
-    }
-
-    if (header[12] != 'v') {
-      std::cerr << "Invalid endian char\n";
-      return false;
-    }
-
-    littleEndian_ = true;
-
-    if (! isdigit(header[13]) || ! isdigit(header[14]) || ! isdigit(header[15])) {
-      std::cerr << "Invalid version\n";
-      return false;
-    }
-
-    legacy_ = false;
-  }
-
-  //---
-
-  // read DNA
-  char code[5];
+  data_     = mapFile.data();
+  dataSize_ = mapFile.size();
 
-  while (! file_->eof()) {
-    if (! readBlock(code)) {
-      std::cerr << "Failed to read block\n";
-      return false;
-    }
+  // compressed files are decompressed in memory (blocks are read from decompressed data)
+  CDeflate::Bytes bytes;
 
-    if (strncmp(&code[0], "ENDB", 4) == 0)
-      break;
-  }
-
-  //---
-
-  file_->rewind();
+  if (! decompress(bytes))
+    return false;
 
-  if (legacy_) {
-    if (! file_->read(header, 12)) {
-      std::cerr << "Failed to read header\n";
-      return false;
-    }
-  }
-  else {
-    if (! file_->read(header, 17)) {
-      std::cerr << "Failed to read header\n";
-      return false;
-    }
+  if (! bytes.empty()) {
+    data_     = bytes.data();
+    dataSize_ = bytes.size();
   }
 
-  //---
+  bool rc = (readHeader() && indexBlocks() && readMeshes());
 
-  // process data using DNA
-  while (! file_->eof()) {
-    if (! processBlock(code)) {
-      std::cerr << "Failed to process block\n";
-      return false;
-    }
+  data_     = nullptr;
+  dataSize_ = 0;
 
-    if (strncmp(&code[0], "ENDB", 4) == 0)
-      break;
-  }
+  if (! rc)
+    return false;
 
   //---
 
@@ -273,342 +246,452 @@ read(CFile &file)
   return true;
 }
 
+// decompress gzip or zstd data into bytes (bytes left empty if data not compressed)
 bool
 CImportBlend::
-readBlock(char *code)
+decompress(CDeflate::Bytes &bytes) const
 {
-  ulong size = 0;
+  auto isMagic = [&](const uchar *magic, ulong len) {
+    return (dataSize_ >= len && memcmp(data_, magic, len) == 0);
+  };
 
-  if (legacy_) {
-    uchar header[25];
+  static const uchar gzipMagic[] = { 0x1F, 0x8B };
+  static const uchar zstdMagic[] = { 0x28, 0xB5, 0x2F, 0xFD };
 
-    if (pointerSize_ == 4) {
-      if (! file_->read(header, 20)) {
-        std::cerr << "Failed to read block header\n";
-        return false;
-      }
+  if      (isMagic(gzipMagic, sizeof(gzipMagic))) {
+    CDeflate::Inflater inflater(CDeflate::Format::GZIP);
+
+    bytes.reserve(4*dataSize_);
+
+    if (! inflater.inflate(data_, dataSize_, bytes)) {
+      std::cerr << "Failed to decompress gzip data: " << inflater.errorMsg() << "\n";
+      return false;
     }
-    else {
-      if (! file_->read(header, 24)) {
-        std::cerr << "Failed to read block header\n";
-        return false;
-      }
+  }
+  else if (isMagic(zstdMagic, sizeof(zstdMagic))) {
+#ifdef CIMPORT_ZSTD
+    std::string errorMsg;
+
+    if (! zstdDecompress(data_, dataSize_, bytes, errorMsg)) {
+      std::cerr << "Failed to decompress zstd data: " << errorMsg << "\n";
+      return false;
     }
+#else
+    std::cerr << "Zstd compressed file not supported (build with ZSTD=1)\n";
+    return false;
+#endif
+  }
+
+  if (isDebug() && ! bytes.empty())
+    std::cerr << "Decompressed " << dataSize_ << " to " << bytes.size() << " bytes\n";
+
+  return true;
+}
+
+bool
+CImportBlend::
+readHeader()
+{
+  if (dataSize_ < 12) {
+    std::cerr << "Failed to read header\n";
+    return false;
+  }
 
-    memcpy(&code[0], &header[0], 4); // 0-3
-    code[4] = '\0';
+  const auto *header = data_;
 
-    size = decodeInteger(&header[4]); // 4-7
+  if (strncmp(reinterpret_cast<const char *>(&header[0]), "BLENDER", 6) != 0) {
+    std::cerr << "Invalid header\n";
+    return false;
   }
-  else {
-    LargeBHead8 lheader;
 
-    if (! file_->read(reinterpret_cast<uchar *>(&lheader), sizeof(lheader))) {
-      std::cerr << "Failed to read header structure\n";
+  // legacy
+  if (header[7] == '_' || header[7] == '-') {
+    if      (header[7] == '_')
+      pointerSize_ = 4;
+    else if (header[7] == '-')
+      pointerSize_ = 8;
+
+    if      (header[8] == 'v')
+      littleEndian_ = true;
+    else if (header[8] == 'V')
+      littleEndian_ = false;
+    else {
+      std::cerr << "Invalid endian char\n";
       return false;
     }
 
-    memcpy(code, &lheader.code, 4);
-    code[4] = '\0';
+    if (! isdigit(header[9]) || ! isdigit(header[10]) || ! isdigit(header[11])) {
+      std::cerr << "Invalid version\n";
+      return false;
+    }
 
-    size = lheader.len;
+    legacy_     = true;
+    headerSize_ = 12;
   }
+  else {
+    if (! isdigit(header[7]) || ! isdigit(header[8])) {
+      std::cerr << "Invalid version\n";
+      return false;
+    }
 
-  if (isDebug())
-    std::cerr << "Code: " << code << "\n";
+    int header_size = (header[7] - '0')*10 + (header[8] - '0');
+    if (header_size != 17) {
+      std::cerr << "Invalid header size\n";
+      return false;
+    }
 
-  // pointer (8-11 or 8-15)
-//auto index = decodeInteger(&header[pointerSize_ == 4 ? 12 : 16]); // 12-15 or 16-19
-//auto count = decodeInteger(&header[pointerSize_ == 4 ? 16 : 20]); // 16-19 or 20-23
+    if (dataSize_ < 17) {
+      std::cerr << "Failed to read header\n";
+      return false;
+    }
 
-#if 0
-  std::cerr << "Code:" << code << " Size:" << size <<
-               " Index: " << index << " Count: " << count << "\n";
-#endif
+    if (header[9] != '-') {
+      std::cerr << "Invalid pointer size char\n";
+      return false;
+    }
 
-  if (size > 0) {
-    if (bufferSize_ < size) {
-      delete [] buffer_;
+    pointerSize_ = 8;
 
-      bufferSize_ = size;
+    if (! isdigit(header[10]) || ! isdigit(header[11])) {
+      std::cerr << "Invalid version\n";
+      return false;
+    }
 
-      buffer_ = new uchar [bufferSize_ + 1];
+    if (header[12] != 'v') {
+      std::cerr << "Invalid endian char\n";
+      return false;
     }
 
-    if (! file_->read(buffer_, size)) {
-      std::cerr << "Failed to read block memory\n";
+    littleEndian_ = true;
+
+    if (! isdigit(header[13]) || ! isdigit(header[14]) || ! isdigit(header[15])) {
+      std::cerr << "Invalid version\n";
       return false;
     }
-  }
 
-  if (strncmp(reinterpret_cast<char *>(&code[0]), "DNA1", 4) == 0)
-    readSDNA(buffer_, size);
+    legacy_     = false;
+    headerSize_ = 17;
+  }
 
   return true;
 }
 
+// index all block headers in one pass (reading DNA when found)
 bool
 CImportBlend::
-processBlock(char *code)
+indexBlocks()
 {
-  ulong size  = 0;
-  ulong index = 0;
-  ulong count = 0;
+  blocks_   .clear();
+  ptrBlocks_.clear();
 
-  if (legacy_) {
-    uchar header[25];
+  ulong pos = headerSize_;
 
-    if (pointerSize_ == 4) {
-      if (! file_->read(header, 20)) {
+  bool hasDNA = false;
+
+  while (pos < dataSize_) {
+    Block block;
+
+    if (legacy_) {
+      ulong headerSize = (pointerSize_ == 4 ? 20 : 24);
+
+      if (pos + headerSize > dataSize_) {
         std::cerr << "Failed to read block header\n";
         return false;
       }
+
+      const auto *header = &data_[pos];
+
+      memcpy(block.code, &header[0], 4); // 0-3
+
+      block.size  = decodeInteger(&header[4]); // 4-7
+      block.old   = decodePointer(&header[8]); // 8-11 or 8-15
+      block.sdna  = decodeInteger(&header[pointerSize_ == 4 ? 12 : 16]); // 12-15 or 16-19
+      block.count = decodeInteger(&header[pointerSize_ == 4 ? 16 : 20]); // 16-19 or 20-23
+
+      pos += headerSize;
     }
     else {
-      if (! file_->read(header, 24)) {
-        std::cerr << "Failed to read block header\n";
+      LargeBHead8 lheader;
+
+      if (pos + sizeof(lheader) > dataSize_) {
+        std::cerr << "Failed to read header structure\n";
         return false;
       }
-    }
 
-    memcpy(&code[0], &header[0], 4); // 0-3
-    code[4] = '\0';
+      memcpy(&lheader, &data_[pos], sizeof(lheader));
 
-    size = decodeInteger(&header[4]); // 4-7
+      memcpy(block.code, &lheader.code, 4);
 
-    // pointer (8-11 or 8-15)
-    index = decodeInteger(&header[pointerSize_ == 4 ? 12 : 16]); // 12-15 or 16-19
-    count = decodeInteger(&header[pointerSize_ == 4 ? 16 : 20]); // 16-19 or 20-23
-  }
-  else {
-    LargeBHead8 lheader;
+      block.size  = ulong(lheader.len);
+      block.old   = lheader.old;
+      block.sdna  = uint(lheader.SDNAnr);
+      block.count = ulong(lheader.nr);
 
-    if (! file_->read(reinterpret_cast<uchar *>(&lheader), sizeof(lheader))) {
-      std::cerr << "Failed to read header structure\n";
-      return false;
+      pos += sizeof(lheader);
     }
 
-    memcpy(code, &lheader.code, 4);
-    code[4] = '\0';
+    block.offset = pos;
 
-    size  = lheader.len;
-    index = lheader.SDNAnr;
-    count = lheader.nr;
-  }
+    if (block.size > dataSize_ - pos) {
+      std::cerr << "Failed to read block memory\n";
+      return false;
+    }
 
-  if (isDebug())
-    std::cerr << "Code: " << code << "\n";
+    pos += block.size;
 
-  if (size > 0) {
-    if (bufferSize_ < size) {
-      delete [] buffer_;
+    if (isDebug())
+      std::cerr << "Code: " << block.code << "\n";
 
-      bufferSize_ = size;
+    if      (strncmp(block.code, "DNA1", 4) == 0) {
+      if (! readSDNA(&data_[block.offset], block.size))
+        return false;
 
-      buffer_ = new uchar [bufferSize_ + 1];
+      hasDNA = true;
     }
+    else if (strncmp(block.code, "ENDB", 4) == 0)
+      break;
 
-    if (! file_->read(buffer_, size)) {
-      std::cerr << "Failed to read buffer memory\n";
-      return false;
-    }
+    if (block.old)
+      ptrBlocks_[block.old] = uint(blocks_.size());
+
+    blocks_.push_back(block);
   }
 
-  //---
+  if (! hasDNA) {
+    std::cerr << "Missing DNA\n";
+    return false;
+  }
 
-  // skip DNA
-  if (strncmp(reinterpret_cast<char *>(&code[0]), "DNA1", 4) == 0)
-    return true;
+  return true;
+}
 
-  //---
+// read meshes from indexed blocks (mesh data is found from mesh pointers, or for files
+// without them from the data blocks following the mesh)
+bool
+CImportBlend::
+readMeshes()
+{
+  std::vector<bool> used(blocks_.size());
 
-  const auto &s = structs_[index];
-  const auto &t = types_[s.typeInd];
+  Mesh *mesh = nullptr;
 
-  if (isDebug())
-    std::cerr << t.name << " #" << count << " (" << size << ")\n";
+  uint nb = uint(blocks_.size());
 
-  uint pos       = 0;
-  uint structLen = 0;
+  for (uint i = 0; i < nb; ++i) {
+    const auto &block = blocks_[i];
 
-  struct VarData {
-    uint ind  { 0 };
-    uint pos  { 0 };
-    uint size { 0 };
-  };
+    if (strncmp(block.code, "DNA1", 4) == 0)
+      continue;
 
-  std::map<std::string, VarData> varDataMap;
+    if (block.sdna >= structs_.size()) {
+      std::cerr << "Invalid block struct " << block.sdna << "\n";
+      return false;
+    }
 
-  while (pos < size) {
-    uint iv = 0;
+    if (isDebug())
+      printBlock(block);
 
-    for (const auto &v : s.vars) {
-      const auto &t1 = types_[v.typeInd];
-      const auto &n1 = names_[v.nameInd];
+    const auto &s = structs_[block.sdna];
+    const auto &t = types_[s.typeInd];
 
-      VarData varData;
+    if (t.name == "Mesh") {
+      mesh = new Mesh;
 
-      varData.ind = iv;
-      varData.pos = pos;
+      meshes_.push_back(mesh);
 
-      if (n1.data.isPtr)
-        varData.size = pointerSize_*n1.data.dimLen;
-      else
-        varData.size = t1.len*n1.data.dimLen;
+      readMesh(block, s, mesh, used);
+    }
+    else if (mesh && ! used[i])
+      used[i] = readMeshData(block, mesh);
+  }
 
-      varDataMap[n1.name] = varData;
+  return true;
+}
 
-      if (isDebug()) {
-        std::cerr << "  " << pos << ":" << " " << t1.name << " (" << t1.len << ") ";
+void
+CImportBlend::
+readMesh(const Block &block, const Struct &s, Mesh *mesh, std::vector<bool> &used)
+{
+  const auto *data = &data_[block.offset];
 
-        std::cerr << n1.name << " ";
+  auto readPoint = [&](const std::string &name, CPoint3D &p) {
+    const auto *v = findVar(s, name);
 
-        printData(n1, t1, &buffer_[pos]);
+    if (v && v->size == 12 && v->pos + 12 <= block.size) {
+      auto x = decodeFloat(&data[v->pos    ]);
+      auto y = decodeFloat(&data[v->pos + 4]);
+      auto z = decodeFloat(&data[v->pos + 8]);
 
-        std::cerr << "\n";
-      }
+      p = CPoint3D(x, y, z);
+    }
+  };
 
-      pos += varData.size;
+  readPoint("loc" , mesh->loc );
+  readPoint("size", mesh->size);
 
-      ++iv;
-    }
+  // resolve data pointers through block index
+  for (const auto *name : {"mvert", "medge", "mface", "mpoly", "mloop", "mloopuv"}) {
+    const auto *v = findVar(s, name);
 
-    if (structLen == 0)
-      structLen = pos;
-  }
+    if (! v || v->size != pointerSize_ || v->pos + pointerSize_ > block.size)
+      continue;
 
-  //---
+    uint ind;
 
-  if      (t.name == "Mesh") {
-    mesh_ = new Mesh;
+    const auto *block1 = pointerBlock(&data[v->pos], &ind);
 
-    auto pl = varDataMap.find("loc");
+    if (block1 && ! used[ind])
+      used[ind] = readMeshData(*block1, mesh);
+  }
+}
 
-    if (pl != varDataMap.end()) {
-      const auto &v = (*pl).second;
+// read mesh data block (returns false if not mesh data)
+bool
+CImportBlend::
+readMeshData(const Block &block, Mesh *mesh)
+{
+  if (block.sdna >= structs_.size())
+    return false;
 
-      assert(v.size == 12);
+  const auto &s = structs_[block.sdna];
+  const auto &t = types_[s.typeInd];
 
-      auto x = decodeFloat(&buffer_[v.pos    ]);
-      auto y = decodeFloat(&buffer_[v.pos + 4]);
-      auto z = decodeFloat(&buffer_[v.pos + 8]);
+  const auto *data = &data_[block.offset];
 
-      mesh_->loc = CPoint3D(x, y, z);
-    }
+  ulong structLen = s.len;
 
-    auto ps = varDataMap.find("size");
+  if (structLen == 0)
+    return false;
 
-    if (ps != varDataMap.end()) {
-      const auto &v = (*ps).second;
+  auto n = block.size/structLen;
 
-      assert(v.size == 12);
+  auto copyData = [&](auto &values) {
+    using T = typename std::remove_reference_t<decltype(values)>::value_type;
 
-      auto x = decodeFloat(&buffer_[v.pos    ]);
-      auto y = decodeFloat(&buffer_[v.pos + 4]);
-      auto z = decodeFloat(&buffer_[v.pos + 8]);
+    assert(structLen == sizeof(T));
 
-      mesh_->size = CPoint3D(x, y, z);
-    }
+    values.resize(n);
 
-    meshes_.push_back(mesh_);
-  }
-  else if (t.name == "MVert") {
-    assert(mesh_ && s.vars.size() >= 4 && structLen >= 16);
+    memcpy(values.data(), data, n*sizeof(T));
+  };
+
+  if      (t.name == "MVert") {
+    assert(s.vars.size() >= 4 && structLen >= 16);
 
-    ulong nv   = size/structLen;
-    uint  pos1 = 0;
+    mesh->points.resize(n);
 
-    for (uint i = 0; i < nv; ++i) {
-      auto x = decodeFloat(&buffer_[pos1    ]);
-      auto y = decodeFloat(&buffer_[pos1 + 4]);
-      auto z = decodeFloat(&buffer_[pos1 + 8]);
+    for (ulong i = 0; i < n; ++i) {
+      const auto *data1 = &data[i*structLen];
 
-      mesh_->points.push_back(CPoint3D(x, y, z));
+      auto x = decodeFloat(&data1[0]);
+      auto y = decodeFloat(&data1[4]);
+      auto z = decodeFloat(&data1[8]);
 
-      pos1 += structLen;
+      mesh->points[i] = CPoint3D(x, y, z);
     }
   }
   else if (t.name == "MEdge") {
-    assert(mesh_ && structLen == sizeof(MEdge));
+    copyData(mesh->medge);
+  }
+  else if (t.name == "MLoop") {
+    copyData(mesh->mloop);
+  }
+  else if (t.name == "MLoopUV") {
+    copyData(mesh->mloopUV);
+  }
+  else if (t.name == "MFace") {
+    assert(structLen >= 12);
 
-    auto np   = size/structLen;
-    uint pos1 = 0;
+    mesh->mface.resize(n);
 
-    mesh_->medge.resize(np);
+    for (ulong i = 0; i < n; ++i) {
+      const auto *data1 = &data[i*structLen];
 
-    for (uint i = 0; i < np; ++i) {
-      memcpy(&mesh_->medge[i], &buffer_[pos1], sizeof(MEdge));
+      auto *mface = &mesh->mface[i];
 
-      pos1 += structLen;
+      mface->v1 = decodeInteger(&data1[0]);
+      mface->v2 = decodeInteger(&data1[4]);
+      mface->v3 = decodeInteger(&data1[8]);
     }
   }
-  else if (t.name == "MLoop") {
-    assert(mesh_ && structLen == sizeof(MLoop));
+  else if (t.name == "MPoly") {
+    copyData(mesh->mpoly);
+  }
+  else
+    return false;
 
-    auto np   = size/structLen;
-    uint pos1 = 0;
+  return true;
+}
 
-    mesh_->mloop.resize(np);
+// block for pointer value stored at data (null if not found)
+const CImportBlend::Block *
+CImportBlend::
+pointerBlock(const uchar *data, uint *ind) const
+{
+  auto ptr = decodePointer(data);
 
-    for (uint i = 0; i < np; ++i) {
-      memcpy(&mesh_->mloop[i], &buffer_[pos1], sizeof(MLoop));
+  if (! ptr)
+    return nullptr;
 
-      pos1 += structLen;
-    }
-  }
-  else if (t.name == "MLoopUV") {
-    assert(mesh_ && structLen == sizeof(MLoopUV));
+  auto p = ptrBlocks_.find(ptr);
 
-    auto np   = size/structLen;
-    uint pos1 = 0;
+  if (p == ptrBlocks_.end())
+    return nullptr;
 
-    mesh_->mloopUV.resize(np);
+  *ind = (*p).second;
 
-    for (uint i = 0; i < np; ++i) {
-      memcpy(&mesh_->mloopUV[i], &buffer_[pos1], sizeof(MLoopUV));
+  return &blocks_[*ind];
+}
 
-      pos1 += structLen;
-    }
+const CImportBlend::StructVar *
+CImportBlend::
+findVar(const Struct &s, const std::string &name) const
+{
+  for (const auto &v : s.vars) {
+    if (names_[v.nameInd].data.name == name)
+      return &v;
   }
-  else if (t.name == "MFace") {
-    assert(mesh_ && structLen >= 12);
 
-    auto np   = size/structLen;
-    uint pos1 = 0;
+  return nullptr;
+}
+
+void
+CImportBlend::
+printBlock(const Block &block) const
+{
+  if (block.sdna >= structs_.size())
+    return;
 
-    mesh_->mface.resize(np);
+  const auto &s = structs_[block.sdna];
+  const auto &t = types_[s.typeInd];
 
-    for (uint i = 0; i < np; ++i) {
-      auto *mface = &mesh_->mface[i];
+  std::cerr << t.name << " #" << block.count << " (" << block.size << ")\n";
 
-      mface->v1 = decodeInteger(&buffer_[pos1    ]);
-      mface->v2 = decodeInteger(&buffer_[pos1 + 4]);
-      mface->v3 = decodeInteger(&buffer_[pos1 + 8]);
+  if (s.len == 0)
+    return;
 
-      pos1 += structLen;
-    }
-  }
-  else if (t.name == "MPoly") {
-    assert(mesh_ && structLen == sizeof(MPoly));
+  const auto *data = &data_[block.offset];
 
-    auto np   = size/structLen;
-    uint pos1 = 0;
+  for (ulong pos = 0; pos + s.len <= block.size; pos += s.len) {
+    for (const auto &v : s.vars) {
+      const auto &t1 = types_[v.typeInd];
+      const auto &n1 = names_[v.nameInd];
+
+      std::cerr << "  " << pos + v.pos << ":" << " " << t1.name << " (" << t1.len << ") ";
 
-    mesh_->mpoly.resize(np);
+      std::cerr << n1.name << " ";
 
-    for (uint i = 0; i < np; ++i) {
-      memcpy(&mesh_->mpoly[i], &buffer_[pos1], sizeof(MPoly));
+      if (v.pos + v.size <= s.len)
+        printData(n1, t1, &data[pos + v.pos]);
 
-      pos1 += structLen;
+      std::cerr << "\n";
     }
   }
-
-  return true;
 }
 
 void
 CImportBlend::
-printData(const Name &n, const Type &t, uchar *data) const
+printData(const Name &n, const Type &t, const uchar *data) const
 {
   if (n.data.isPtr)
     return;
@@ -682,28 +765,19 @@ readSDNA(const uchar *buffer, ulong size)
     return i;
   };
 
+  std::string name;
+
   auto readName = [&]() {
     auto pos1 = pos;
 
     while (pos1 < size && buffer[pos1] != '\0')
       ++pos1;
 
-    auto len = pos1 - pos;
+    name.assign(reinterpret_cast<const char *>(&buffer[pos]), pos1 - pos);
 
     if (pos1 < size)
       ++pos1;
 
-    if (nameLen_ < len) {
-      delete [] name_;
-
-      nameLen_ = len;
-
-      name_ = new char [nameLen_ + 1];
-    }
-
-    memcpy(&name_[0], &buffer[pos], len);
-    name_[len] = '\0';
-
     pos = pos1;
   };
 
@@ -731,13 +805,9 @@ readSDNA(const uchar *buffer, ulong size)
   for (uint i = 0; i < n; ++i) {
     readName();
 
-    //std::cerr << "  " << i << ":" << name_ << "\n";
-
-    Name name;
-
-    name.name = name_;
+    //std::cerr << "  " << i << ":" << name << "\n";
 
-    names_[i] = name;
+    names_[i].name = name;
 
     decodeNameData(names_[i]);
   }
@@ -764,9 +834,9 @@ readSDNA(const uchar *buffer, ulong size)
   for (uint i = 0; i < nt; ++i) {
     readName();
 
-    //std::cerr << "  " << i << ":" << name_ << "\n";
+    //std::cerr << "  " << i << ":" << name << "\n";
 
-    types_[i].name = name_;
+    types_[i].name = name;
   }
 
   pos = align4(pos);
@@ -817,13 +887,34 @@ readSDNA(const uchar *buffer, ulong size)
 
     s.vars.resize(count);
 
+    // var offsets (struct is packed)
+    uint varPos = 0;
+
     for (ushort j = 0; j < count; ++j) {
       auto &v = s.vars[j];
 
       v.typeInd = readShort();
       v.nameInd = readShort();
+
+      if (v.typeInd >= nt || v.nameInd >= n) {
+        std::cerr << "Invalid SDNA struct var\n";
+        return false;
+      }
+
+      const auto &nameData = names_[v.nameInd].data;
+
+      if (nameData.isPtr)
+        v.size = pointerSize_*nameData.dimLen;
+      else
+        v.size = types_[v.typeInd].len*nameData.dimLen;
+
+      v.pos = varPos;
+
+      varPos += v.size;
     }
 
+    s.len = (s.typeInd < nt ? types_[s.typeInd].len : varPos);
+
     typeStruct_[s.typeInd] = i;
   }
 
@@ -934,3 +1025,19 @@ decodeFloat(const uchar *data) const
 
   return *reinterpret_cast<float *>(&i);
 }
+
+uint64_t
+CImportBlend::
+decodePointer(const uchar *data) const
+{
+  if (pointerSize_ == 4)
+    return decodeInteger(data);
+
+  uint64_t lo = decodeInteger(&data[0]);
+  uint64_t hi = decodeInteger(&data[4]);
+
+  if (! littleEndian_)
+    std::swap(lo, hi);
+
+  return (hi << 32) | lo;
+}
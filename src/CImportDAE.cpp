@@ -3,10 +3,9 @@
 #include <CGeomScene3D.h>
 #include <CGeomNodeData.h>
 
-#include <CXML.h>
-#include <CXMLToken.h>
+#include <CImportXML.h>
+#include <CImportMapFile.h>
 #include <CStrUtil.h>
-#include <CThrow.h>
 
 CImportDAE::
 CImportDAE(CGeomScene3D *scene, const std::string &name) :
@@ -39,61 +38,54 @@ read(CFile &file)
 {
   file_ = &file;
 
-  if (! file_->open(CFileBase::Mode::READ))
-    return false;
-
-  CXML     xml;
-  CXMLTag *tag;
-
-  {
-  CThrowScope throwScope(CTHROW_PRINT);
+  CImportMapFile mapFile;
 
-  if (! xml.read(file_, &tag) || ! tag)
+  if (! mapFile.open(file_->getPath(), isMapFile()))
     return false;
-  }
 
-  if (tag->getName() != "COLLADA")
-    return false;
+  // document is streamed (each library is read and dropped when complete) and
+  // number arrays are parsed straight from the text into numbers
+  CImportXML xml;
 
-  //---
+  xml.addRealArrayTag("float_array");
 
-  // handle options
-  const auto &options = tag->getOptions();
+  xml.addIntArrayTag("p");
+  xml.addIntArrayTag("vcount");
+  xml.addIntArrayTag("v");
 
-  auto num_options = tag->getNumOptions();
+  auto readRoot = [&](CImportXMLTag *tag) {
+    if (tag->getName() != "COLLADA")
+      return false;
 
-  for (size_t j = 0; j < num_options; ++j) {
-    auto *option = options[j];
+    //---
 
-    const auto &opt_name = option->getName ();
+    // handle options
+    const auto &options = tag->getOptions();
 
-    if      (opt_name == "xmlns") {
-      SKIP(opt_name);
-    }
-    else if (opt_name == "version") {
-      SKIP(opt_name);
-    }
-    else if (opt_name == "xmlns:xsi") {
-      SKIP(opt_name);
-    }
-    else
-      errorMsg("Unrecognised option '" + opt_name + "'");
-  }
-
-  //---
+    auto num_options = tag->getNumOptions();
 
-  auto children = tag->getChildren();
+    for (size_t j = 0; j < num_options; ++j) {
+      auto *option = options[j];
 
-  auto num_children = tag->getNumChildren();
-
-  for (size_t i = 0; i < num_children; ++i) {
-    const auto *token = children[i];
+      const auto &opt_name = option->getName ();
 
-    if (! token->isTag())
-      continue;
+      if      (opt_name == "xmlns") {
+        SKIP(opt_name);
+      }
+      else if (opt_name == "version") {
+        SKIP(opt_name);
+      }
+      else if (opt_name == "xmlns:xsi") {
+        SKIP(opt_name);
+      }
+      else
+        errorMsg("Unrecognised option '" + opt_name + "'");
+    }
 
-    auto *tag1 = token->getTag();
+    return true;
+  };
 
+  auto readChild = [&](CImportXMLTag *tag1) {
     const auto &name1 = tag1->getName();
 
   //auto num_options1 = tag1->getNumOptions();
@@ -133,11 +125,16 @@ read(CFile &file)
     }
     else
       errorMsg("Unrecognised tag '" + name1 + "'");
-  }
 
-  //---
+    return true;
+  };
 
-  delete tag;
+  if (! xml.read(mapFile.chars(), mapFile.size(), readRoot, readChild)) {
+    if (xml.errorMsg() != "")
+      errorMsg(xml.errorMsg());
+
+    return false;
+  }
 
   //---
 
@@ -892,7 +889,7 @@ getEffectTexture(LibraryEffect *effect, const std::string &texture)
 
 bool
 CImportDAE::
-readAsset(const std::string &parentName, CXMLTag *tag)
+readAsset(const std::string &parentName, CImportXMLTag *tag)
 {
   auto num_options = tag->getNumOptions();
   assert(num_options == 0);
@@ -975,7 +972,7 @@ readAsset(const std::string &parentName, CXMLTag *tag)
 
 bool
 CImportDAE::
-readLibraryImages(const std::string &parentName, CXMLTag *tag)
+readLibraryImages(const std::string &parentName, CImportXMLTag *tag)
 {
   auto num_options = tag->getNumOptions();
   assert(num_options == 0);
@@ -1017,7 +1014,7 @@ readLibraryImages(const std::string &parentName, CXMLTag *tag)
 
 bool
 CImportDAE::
-readLibraryMaterials(const std::string &parentName, CXMLTag *tag)
+readLibraryMaterials(const std::string &parentName, CImportXMLTag *tag)
 {
   auto num_options = tag->getNumOptions();
   assert(num_options == 0);
@@ -1059,7 +1056,7 @@ readLibraryMaterials(const std::string &parentName, CXMLTag *tag)
 
 bool
 CImportDAE::
-readLibraryEffects(const std::string &parentName, CXMLTag *tag)
+readLibraryEffects(const std::string &parentName, CImportXMLTag *tag)
 {
   auto num_options = tag->getNumOptions();
   assert(num_options == 0);
@@ -1098,7 +1095,7 @@ readLibraryEffects(const std::string &parentName, CXMLTag *tag)
 
 bool
 CImportDAE::
-readLibraryImage(const std::string &parentName, CXMLTag *tag, ImageP &image)
+readLibraryImage(const std::string &parentName, CImportXMLTag *tag, ImageP &image)
 {
   auto num_options = tag->getNumOptions();
 
@@ -1162,7 +1159,7 @@ readLibraryImage(const std::string &parentName, CXMLTag *tag, ImageP &image)
 
 bool
 CImportDAE::
-readLibraryMaterial(const std::string &parentName, CXMLTag *tag, MaterialP &material)
+readLibraryMaterial(const std::string &parentName, CImportXMLTag *tag, MaterialP &material)
 {
   auto num_options = tag->getNumOptions();
 
@@ -1232,7 +1229,7 @@ readLibraryMaterial(const std::string &parentName, CXMLTag *tag, MaterialP &mate
 
 bool
 CImportDAE::
-readLibraryEffect(const std::string &parentName, CXMLTag *tag, LibraryEffectP &effect)
+readLibraryEffect(const std::string &parentName, CImportXMLTag *tag, LibraryEffectP &effect)
 {
   auto num_options = tag->getNumOptions();
 
@@ -1284,7 +1281,7 @@ readLibraryEffect(const std::string &parentName, CXMLTag *tag, LibraryEffectP &e
 
 bool
 CImportDAE::
-readLibraryEffectProfileCommon(const std::string &parentName, CXMLTag *tag, LibraryEffectP &effect)
+readLibraryEffectProfileCommon(const std::string &parentName, CImportXMLTag *tag, LibraryEffectP &effect)
 {
   auto num_options = tag->getNumOptions();
   assert(num_options == 0);
@@ -1324,7 +1321,7 @@ readLibraryEffectProfileCommon(const std::string &parentName, CXMLTag *tag, Libr
 
 bool
 CImportDAE::
-readLibraryEffectProfileParam(const std::string &parentName, CXMLTag *tag, NewParam &param,
+readLibraryEffectProfileParam(const std::string &parentName, CImportXMLTag *tag, NewParam &param,
                               LibraryEffectP &effect)
 {
   auto num_options = tag->getNumOptions();
@@ -1385,7 +1382,7 @@ readLibraryEffectProfileParam(const std::string &parentName, CXMLTag *tag, NewPa
 
 bool
 CImportDAE::
-readLibraryEffectProfileTechnique(const std::string &parentName, CXMLTag *tag,
+readLibraryEffectProfileTechnique(const std::string &parentName, CImportXMLTag *tag,
                                   LibraryEffectP &effect)
 {
   auto children = tag->getChildren();
@@ -1425,7 +1422,7 @@ readLibraryEffectProfileTechnique(const std::string &parentName, CXMLTag *tag,
 
 bool
 CImportDAE::
-readLibraryEffectProfilePhong(const std::string &parentName, CXMLTag *tag,
+readLibraryEffectProfilePhong(const std::string &parentName, CImportXMLTag *tag,
                               LibraryEffectP &effect)
 {
   auto num_options = tag->getNumOptions();
@@ -1485,7 +1482,7 @@ readLibraryEffectProfilePhong(const std::string &parentName, CXMLTag *tag,
 
 bool
 CImportDAE::
-readLibraryEffectProfileExtra(const std::string &parentName, CXMLTag *tag,
+readLibraryEffectProfileExtra(const std::string &parentName, CImportXMLTag *tag,
                               LibraryEffectP &effect)
 {
   auto children = tag->getChildren();
@@ -1516,7 +1513,7 @@ readLibraryEffectProfileExtra(const std::string &parentName, CXMLTag *tag,
 
 bool
 CImportDAE::
-readLibraryEffectProfileTechExtra(const std::string &parentName, CXMLTag *tag,
+readLibraryEffectProfileTechExtra(const std::string &parentName, CImportXMLTag *tag,
                                   LibraryEffectP &effect)
 {
   auto num_options = tag->getNumOptions();
@@ -1569,7 +1566,7 @@ readLibraryEffectProfileTechExtra(const std::string &parentName, CXMLTag *tag,
 
 bool
 CImportDAE::
-readLibraryEffectProfileDisplacement(const std::string &parentName, CXMLTag *tag,
+readLibraryEffectProfileDisplacement(const std::string &parentName, CImportXMLTag *tag,
                                      LibraryEffectP &effect)
 {
   auto num_options = tag->getNumOptions();
@@ -1607,7 +1604,7 @@ readLibraryEffectProfileDisplacement(const std::string &parentName, CXMLTag *tag
 
 bool
 CImportDAE::
-readAmbient(const std::string &parentName, CXMLTag *tag)
+readAmbient(const std::string &parentName, CImportXMLTag *tag)
 {
   auto num_options = tag->getNumOptions();
   assert(num_options == 0);
@@ -1645,7 +1642,7 @@ readAmbient(const std::string &parentName, CXMLTag *tag)
 
 bool
 CImportDAE::
-readDiffuse(const std::string &parentName, CXMLTag *tag, LibraryEffectP &effect)
+readDiffuse(const std::string &parentName, CImportXMLTag *tag, LibraryEffectP &effect)
 {
   auto num_options = tag->getNumOptions();
   assert(num_options == 0);
@@ -1682,7 +1679,7 @@ readDiffuse(const std::string &parentName, CXMLTag *tag, LibraryEffectP &effect)
 
 bool
 CImportDAE::
-readEmission(const std::string &parentName, CXMLTag *tag, LibraryEffectP &effect)
+readEmission(const std::string &parentName, CImportXMLTag *tag, LibraryEffectP &effect)
 {
   auto num_options = tag->getNumOptions();
   assert(num_options == 0);
@@ -1719,7 +1716,7 @@ readEmission(const std::string &parentName, CXMLTag *tag, LibraryEffectP &effect
 
 bool
 CImportDAE::
-readSpecular(const std::string &parentName, CXMLTag *tag, LibraryEffectP &effect)
+readSpecular(const std::string &parentName, CImportXMLTag *tag, LibraryEffectP &effect)
 {
   auto num_options = tag->getNumOptions();
   assert(num_options == 0);
@@ -1756,7 +1753,7 @@ readSpecular(const std::string &parentName, CXMLTag *tag, LibraryEffectP &effect
 
 bool
 CImportDAE::
-readShininess(const std::string &parentName, CXMLTag *tag)
+readShininess(const std::string &parentName, CImportXMLTag *tag)
 {
   auto num_options = tag->getNumOptions();
   assert(num_options == 0);
@@ -1794,7 +1791,7 @@ readShininess(const std::string &parentName, CXMLTag *tag)
 
 bool
 CImportDAE::
-readReflective(const std::string &parentName, CXMLTag *tag)
+readReflective(const std::string &parentName, CImportXMLTag *tag)
 {
   auto num_options = tag->getNumOptions();
   assert(num_options == 0);
@@ -1832,7 +1829,7 @@ readReflective(const std::string &parentName, CXMLTag *tag)
 
 bool
 CImportDAE::
-readReflectivity(const std::string &parentName, CXMLTag *tag)
+readReflectivity(const std::string &parentName, CImportXMLTag *tag)
 {
   auto num_options = tag->getNumOptions();
   assert(num_options == 0);
@@ -1870,7 +1867,7 @@ readReflectivity(const std::string &parentName, CXMLTag *tag)
 
 bool
 CImportDAE::
-readTransparent(const std::string &parentName, CXMLTag *tag, LibraryEffectP &effect)
+readTransparent(const std::string &parentName, CImportXMLTag *tag, LibraryEffectP &effect)
 {
   auto num_options = tag->getNumOptions();
 
@@ -1921,7 +1918,7 @@ readTransparent(const std::string &parentName, CXMLTag *tag, LibraryEffectP &eff
 
 bool
 CImportDAE::
-readTexture(const std::string &parentName, CXMLTag *tag, Texture &texture)
+readTexture(const std::string &parentName, CImportXMLTag *tag, Texture &texture)
 {
   auto num_options = tag->getNumOptions();
 
@@ -1975,7 +1972,7 @@ readTexture(const std::string &parentName, CXMLTag *tag, Texture &texture)
 
 bool
 CImportDAE::
-readTextureExtra(const std::string &parentName, CXMLTag *tag, Texture &texture)
+readTextureExtra(const std::string &parentName, CImportXMLTag *tag, Texture &texture)
 {
   auto num_options = tag->getNumOptions();
 
@@ -2026,7 +2023,7 @@ readTextureExtra(const std::string &parentName, CXMLTag *tag, Texture &texture)
 
 bool
 CImportDAE::
-readTextureTechnique(const std::string &parentName, CXMLTag *tag, Texture &texture)
+readTextureTechnique(const std::string &parentName, CImportXMLTag *tag, Texture &texture)
 {
   TextureTechnique technique;
 
@@ -2087,7 +2084,7 @@ readTextureTechnique(const std::string &parentName, CXMLTag *tag, Texture &textu
 
 bool
 CImportDAE::
-readTextureWrapU(const std::string &parentName, CXMLTag *tag, Texture & /*texture*/)
+readTextureWrapU(const std::string &parentName, CImportXMLTag *tag, Texture & /*texture*/)
 {
   TextureWrap wrap;
 
@@ -2132,7 +2129,7 @@ readTextureWrapU(const std::string &parentName, CXMLTag *tag, Texture & /*textur
 
 bool
 CImportDAE::
-readTextureWrapV(const std::string &parentName, CXMLTag *tag, Texture & /*texture*/)
+readTextureWrapV(const std::string &parentName, CImportXMLTag *tag, Texture & /*texture*/)
 {
   TextureWrap wrap;
 
@@ -2177,7 +2174,7 @@ readTextureWrapV(const std::string &parentName, CXMLTag *tag, Texture & /*textur
 
 bool
 CImportDAE::
-readTextureBlendMode(const std::string &parentName, CXMLTag *tag, Texture & /*texture*/)
+readTextureBlendMode(const std::string &parentName, CImportXMLTag *tag, Texture & /*texture*/)
 {
   auto num_options = tag->getNumOptions();
 
@@ -2215,7 +2212,7 @@ readTextureBlendMode(const std::string &parentName, CXMLTag *tag, Texture & /*te
 
 bool
 CImportDAE::
-readTextureOffsets(const std::string &parentName, CXMLTag *tag, Texture &texture)
+readTextureOffsets(const std::string &parentName, CImportXMLTag *tag, Texture &texture)
 {
   auto num_options = tag->getNumOptions();
 
@@ -2306,7 +2303,7 @@ readTextureOffsets(const std::string &parentName, CXMLTag *tag, Texture &texture
 
 bool
 CImportDAE::
-readTextureAmount(const std::string &parentName, CXMLTag *tag, Texture & /*texture*/)
+readTextureAmount(const std::string &parentName, CImportXMLTag *tag, Texture & /*texture*/)
 {
   auto num_options = tag->getNumOptions();
 
@@ -2344,7 +2341,7 @@ readTextureAmount(const std::string &parentName, CXMLTag *tag, Texture & /*textu
 
 bool
 CImportDAE::
-readTransparency(const std::string &parentName, CXMLTag *tag)
+readTransparency(const std::string &parentName, CImportXMLTag *tag)
 {
   auto num_options = tag->getNumOptions();
   assert(num_options == 0);
@@ -2382,7 +2379,7 @@ readTransparency(const std::string &parentName, CXMLTag *tag)
 
 bool
 CImportDAE::
-readLibraryEffectProfileSurface(const std::string &parentName, CXMLTag *tag, Surface &surface)
+readLibraryEffectProfileSurface(const std::string &parentName, CImportXMLTag *tag, Surface &surface)
 {
   auto num_options = tag->getNumOptions();
 
@@ -2442,7 +2439,7 @@ readLibraryEffectProfileSurface(const std::string &parentName, CXMLTag *tag, Sur
 
 bool
 CImportDAE::
-readLibraryEffectSampler2D(const std::string &parentName, CXMLTag *tag, NewParam &param,
+readLibraryEffectSampler2D(const std::string &parentName, CImportXMLTag *tag, NewParam &param,
                            Sampler2D &sampler)
 {
   auto num_options = tag->getNumOptions();
@@ -2500,7 +2497,7 @@ readLibraryEffectSampler2D(const std::string &parentName, CXMLTag *tag, NewParam
 
 bool
 CImportDAE::
-readLibraryGeometries(const std::string &parentName, CXMLTag *tag)
+readLibraryGeometries(const std::string &parentName, CImportXMLTag *tag)
 {
   auto num_options = tag->getNumOptions();
   assert(num_options == 0);
@@ -2535,7 +2532,7 @@ readLibraryGeometries(const std::string &parentName, CXMLTag *tag)
 
 bool
 CImportDAE::
-readLibraryGeometry(const std::string &parentName, CXMLTag *tag)
+readLibraryGeometry(const std::string &parentName, CImportXMLTag *tag)
 {
   auto *geometry = new Geometry;
 
@@ -2591,7 +2588,7 @@ readLibraryGeometry(const std::string &parentName, CXMLTag *tag)
 
 bool
 CImportDAE::
-readGeometryMesh(const std::string &parentName, CXMLTag *tag, Geometry *geometry)
+readGeometryMesh(const std::string &parentName, CImportXMLTag *tag, Geometry *geometry)
 {
   auto num_options = tag->getNumOptions();
   assert(num_options == 0);
@@ -2666,7 +2663,7 @@ readGeometryMesh(const std::string &parentName, CXMLTag *tag, Geometry *geometry
 
 bool
 CImportDAE::
-readGeometryMeshSource(const std::string &parentName, CXMLTag *tag, MeshSourceP &meshSource)
+readGeometryMeshSource(const std::string &parentName, CImportXMLTag *tag, MeshSourceP &meshSource)
 {
   auto num_options = tag->getNumOptions();
 
@@ -2723,7 +2720,7 @@ readGeometryMeshSource(const std::string &parentName, CXMLTag *tag, MeshSourceP
 
 bool
 CImportDAE::
-readGeometryMeshVertices(const std::string &parentName, CXMLTag *tag, MeshVerticesP &meshVertices)
+readGeometryMeshVertices(const std::string &parentName, CImportXMLTag *tag, MeshVerticesP &meshVertices)
 {
   auto num_options = tag->getNumOptions();
 
@@ -2782,7 +2779,7 @@ readGeometryMeshVertices(const std::string &parentName, CXMLTag *tag, MeshVertic
 
 bool
 CImportDAE::
-readGeometryMeshPolylist(const std::string &parentName, CXMLTag *tag, MeshPolyListP &polyList)
+readGeometryMeshPolylist(const std::string &parentName, CImportXMLTag *tag, MeshPolyListP &polyList)
 {
   auto num_options = tag->getNumOptions();
 
@@ -2846,40 +2843,17 @@ readGeometryMeshPolylist(const std::string &parentName, CXMLTag *tag, MeshPolyLi
     else if (name == "vcount") {
       assert(num_options1 == 0);
 
-      const auto &value = tag1->getText();
-
-      std::vector<std::string> words;
-      CStrUtil::toWords(value, words);
-
-      for (const auto &word : words) {
-        int ii;
-        if (! CStrUtil::toInteger(word, &ii))
-          errorMsg("Invalid integer '" + word + "'");
-
-        polyList->vcount.push_back(ii);
+      polyList->vcount = tag1->takeInts();
 
+      for (auto ii : polyList->vcount)
         polyList->vsum += ii;
-      }
 
       assert(tag1->getNumTagChildren() == 0);
     }
     else if (name == "p") {
       assert(num_options1 == 0);
 
-      const auto &value = tag1->getText();
-
-      std::vector<std::string> words;
-      CStrUtil::toWords(value, words);
-
-      std::vector<int> ints;
-
-      for (const auto &word : words) {
-        int ii;
-        if (! CStrUtil::toInteger(word, &ii))
-          errorMsg("Invalid integer '" + word + "'");
-
-        polyList->p.push_back(ii);
-      }
+      polyList->p = tag1->takeInts();
 
       assert(tag1->getNumTagChildren() == 0);
     }
@@ -2892,7 +2866,7 @@ readGeometryMeshPolylist(const std::string &parentName, CXMLTag *tag, MeshPolyLi
 
 bool
 CImportDAE::
-readGeometryMeshTriangles(const std::string &parentName, CXMLTag *tag, MeshTrianglesP &triangles)
+readGeometryMeshTriangles(const std::string &parentName, CImportXMLTag *tag, MeshTrianglesP &triangles)
 {
   auto num_options = tag->getNumOptions();
 
@@ -2956,20 +2930,7 @@ readGeometryMeshTriangles(const std::string &parentName, CXMLTag *tag, MeshTrian
     else if (name == "p") {
       assert(num_options1 == 0);
 
-      const auto &value = tag1->getText();
-
-      std::vector<std::string> words;
-      CStrUtil::toWords(value, words);
-
-      std::vector<int> ints;
-
-      for (const auto &word : words) {
-        int ii;
-        if (! CStrUtil::toInteger(word, &ii))
-          errorMsg("Invalid integer '" + word + "'");
-
-        triangles->p.push_back(ii);
-      }
+      triangles->p = tag1->takeInts();
 
       assert(tag1->getNumTagChildren() == 0);
     }
@@ -2982,7 +2943,7 @@ readGeometryMeshTriangles(const std::string &parentName, CXMLTag *tag, MeshTrian
 
 bool
 CImportDAE::
-readTechniqueCommon(const std::string &parentName, CXMLTag *tag, TechniqueCommon &techniqueCommon)
+readTechniqueCommon(const std::string &parentName, CImportXMLTag *tag, TechniqueCommon &techniqueCommon)
 {
   auto num_options = tag->getNumOptions();
   assert(num_options == 0);
@@ -3017,7 +2978,7 @@ readTechniqueCommon(const std::string &parentName, CXMLTag *tag, TechniqueCommon
 
 bool
 CImportDAE::
-readTechniqueCommonAccessor(const std::string &parentName, CXMLTag *tag,
+readTechniqueCommonAccessor(const std::string &parentName, CImportXMLTag *tag,
                             TechniqueCommon &techniqueCommon)
 {
   auto num_options = tag->getNumOptions();
@@ -3104,7 +3065,7 @@ readTechniqueCommonAccessor(const std::string &parentName, CXMLTag *tag,
 
 bool
 CImportDAE::
-readLibraryControllers(const std::string &parentName, CXMLTag *tag)
+readLibraryControllers(const std::string &parentName, CImportXMLTag *tag)
 {
   auto num_options = tag->getNumOptions();
   assert(num_options == 0);
@@ -3137,7 +3098,7 @@ readLibraryControllers(const std::string &parentName, CXMLTag *tag)
 
 bool
 CImportDAE::
-readLibraryController(const std::string &parentName, CXMLTag *tag)
+readLibraryController(const std::string &parentName, CImportXMLTag *tag)
 {
   auto *controller = new LibraryController;
 
@@ -3197,7 +3158,7 @@ readLibraryController(const std::string &parentName, CXMLTag *tag)
 
 bool
 CImportDAE::
-readLibraryControllerSkin(const std::string &parentName, CXMLTag *tag, Skin &skin)
+readLibraryControllerSkin(const std::string &parentName, CImportXMLTag *tag, Skin &skin)
 {
   auto num_options = tag->getNumOptions();
 
@@ -3280,7 +3241,7 @@ readLibraryControllerSkin(const std::string &parentName, CXMLTag *tag, Skin &ski
 
 bool
 CImportDAE::
-readLibraryControllerSkinSource(const std::string &parentName, CXMLTag *tag, Skin &skin)
+readLibraryControllerSkinSource(const std::string &parentName, CImportXMLTag *tag, Skin &skin)
 {
   Source source;
 
@@ -3343,7 +3304,7 @@ readLibraryControllerSkinSource(const std::string &parentName, CXMLTag *tag, Ski
 
 bool
 CImportDAE::
-readLibraryControllerSkinJoints(const std::string &parentName, CXMLTag *tag, Skin &skin)
+readLibraryControllerSkinJoints(const std::string &parentName, CImportXMLTag *tag, Skin &skin)
 {
   SkinJoint joint;
 
@@ -3387,7 +3348,7 @@ readLibraryControllerSkinJoints(const std::string &parentName, CXMLTag *tag, Ski
 
 bool
 CImportDAE::
-readLibraryControllerSkinWeights(const std::string &parentName, CXMLTag *tag, Skin &skin)
+readLibraryControllerSkinWeights(const std::string &parentName, CImportXMLTag *tag, Skin &skin)
 {
   SkinWeights weights;
 
@@ -3438,36 +3399,14 @@ readLibraryControllerSkinWeights(const std::string &parentName, CXMLTag *tag, Sk
     else if (name == "vcount") {
       assert(num_options1 == 0);
 
-      const auto &value = tag1->getText();
-
-      std::vector<std::string> words;
-      CStrUtil::toWords(value, words);
-
-      for (const auto &word : words) {
-        int ii;
-        if (! CStrUtil::toInteger(word, &ii))
-          errorMsg("Invalid integer '" + word + "'");
-
-        weights.vcount.push_back(ii);
-      }
+      weights.vcount = tag1->takeInts();
 
       assert(tag1->getNumTagChildren() == 0);
     }
     else if (name == "v") {
       assert(num_options1 == 0);
 
-      const auto &value = tag1->getText();
-
-      std::vector<std::string> words;
-      CStrUtil::toWords(value, words);
-
-      for (const auto &word : words) {
-        int ii;
-        if (! CStrUtil::toInteger(word, &ii))
-          errorMsg("Invalid integer '" + word + "'");
-
-        weights.v.push_back(ii);
-      }
+      weights.v = tag1->takeInts();
 
       assert(tag1->getNumTagChildren() == 0);
     }
@@ -3482,7 +3421,7 @@ readLibraryControllerSkinWeights(const std::string &parentName, CXMLTag *tag, Sk
 
 bool
 CImportDAE::
-readLibraryAnimations(const std::string &parentName, CXMLTag *tag)
+readLibraryAnimations(const std::string &parentName, CImportXMLTag *tag)
 {
   auto num_options = tag->getNumOptions();
   assert(num_options == 0);
@@ -3517,7 +3456,7 @@ readLibraryAnimations(const std::string &parentName, CXMLTag *tag)
 
 bool
 CImportDAE::
-readLibraryAnimation(const std::string &parentName, CXMLTag *tag)
+readLibraryAnimation(const std::string &parentName, CImportXMLTag *tag)
 {
   Animation animation;
 
@@ -3608,7 +3547,7 @@ readLibraryAnimation(const std::string &parentName, CXMLTag *tag)
 
 bool
 CImportDAE::
-readLibraryAnimationSource(const std::string &parentName, CXMLTag *tag, Animation &animation)
+readLibraryAnimationSource(const std::string &parentName, CImportXMLTag *tag, Animation &animation)
 {
   Source source;
 
@@ -3669,7 +3608,7 @@ readLibraryAnimationSource(const std::string &parentName, CXMLTag *tag, Animatio
 
 bool
 CImportDAE::
-readLibraryAnimationSampler(const std::string &parentName, CXMLTag *tag, Animation &animation)
+readLibraryAnimationSampler(const std::string &parentName, CImportXMLTag *tag, Animation &animation)
 {
   AnimationSampler sampler;
 
@@ -3725,7 +3664,7 @@ readLibraryAnimationSampler(const std::string &parentName, CXMLTag *tag, Animati
 
 bool
 CImportDAE::
-readInput(const std::string &parentName, CXMLTag *tag, Input &input)
+readInput(const std::string &parentName, CImportXMLTag *tag, Input &input)
 {
   auto num_options = tag->getNumOptions();
 
@@ -3765,7 +3704,7 @@ readInput(const std::string &parentName, CXMLTag *tag, Input &input)
 
 bool
 CImportDAE::
-readFloatArray(const std::string &parentName, CXMLTag *tag, FloatArray &array)
+readFloatArray(const std::string &parentName, CImportXMLTag *tag, FloatArray &array)
 {
   auto num_options = tag->getNumOptions();
 
@@ -3788,18 +3727,11 @@ readFloatArray(const std::string &parentName, CXMLTag *tag, FloatArray &array)
       errorMsg("Unrecognised " + parentName + " option '" + opt_name + "'");
   }
 
-  const auto &value = tag->getText();
-
-  std::vector<std::string> words;
-  CStrUtil::toWords(value, words);
+  array.values = tag->takeReals();
 
-  for (const auto &word : words) {
-    double r;
-    if (! CStrUtil::toReal(word, &r))
-      std::cerr << "Invalid " << parentName << " value '" << word << "'\n";
-
-    array.values.push_back(r);
-  }
+  if (array.count >= 0 && int(array.values.size()) != array.count)
+    errorMsg("Bad " + parentName + " size " + std::to_string(array.values.size()) +
+             " for count " + std::to_string(array.count));
 
   assert(tag->getNumTagChildren() == 0);
 
@@ -3808,7 +3740,7 @@ readFloatArray(const std::string &parentName, CXMLTag *tag, FloatArray &array)
 
 bool
 CImportDAE::
-readNameArray(const std::string &parentName, CXMLTag *tag, NameArray &array)
+readNameArray(const std::string &parentName, CImportXMLTag *tag, NameArray &array)
 {
   auto num_options = tag->getNumOptions();
 
@@ -3846,7 +3778,7 @@ readNameArray(const std::string &parentName, CXMLTag *tag, NameArray &array)
 
 bool
 CImportDAE::
-readColor(const std::string &parentName, CXMLTag *tag, Color &c)
+readColor(const std::string &parentName, CImportXMLTag *tag, Color &c)
 {
   auto num_options = tag->getNumOptions();
 
@@ -3888,7 +3820,7 @@ readColor(const std::string &parentName, CXMLTag *tag, Color &c)
 
 bool
 CImportDAE::
-readFloat(const std::string &parentName, CXMLTag *tag, Float &f)
+readFloat(const std::string &parentName, CImportXMLTag *tag, Float &f)
 {
   auto num_options = tag->getNumOptions();
 
@@ -3919,7 +3851,7 @@ readFloat(const std::string &parentName, CXMLTag *tag, Float &f)
 
 bool
 CImportDAE::
-readLibraryVisualScenes(const std::string &parentName, CXMLTag *tag)
+readLibraryVisualScenes(const std::string &parentName, CImportXMLTag *tag)
 {
   auto num_options = tag->getNumOptions();
   assert(num_options == 0);
@@ -3954,7 +3886,7 @@ readLibraryVisualScenes(const std::string &parentName, CXMLTag *tag)
 
 bool
 CImportDAE::
-readLibraryVisualScene(const std::string &parentName, CXMLTag *tag)
+readLibraryVisualScene(const std::string &parentName, CImportXMLTag *tag)
 {
   VisualScene scene;
 
@@ -4017,7 +3949,7 @@ readLibraryVisualScene(const std::string &parentName, CXMLTag *tag)
 
 bool
 CImportDAE::
-readNode(const std::string &parentName, CXMLTag *tag, VisualScene &scene, Node *parentNode)
+readNode(const std::string &parentName, CImportXMLTag *tag, VisualScene &scene, Node *parentNode)
 {
   auto *node = new Node;
 
@@ -4154,7 +4086,7 @@ readNode(const std::string &parentName, CXMLTag *tag, VisualScene &scene, Node *
 
 bool
 CImportDAE::
-readNodeInstanceController(const std::string &parentName, CXMLTag *tag, Node *node)
+readNodeInstanceController(const std::string &parentName, CImportXMLTag *tag, Node *node)
 {
   auto num_options = tag->getNumOptions();
 
@@ -4220,7 +4152,7 @@ readNodeInstanceController(const std::string &parentName, CXMLTag *tag, Node *no
 
 bool
 CImportDAE::
-readNodeBindMaterial(const std::string &parentName, CXMLTag *tag, Node *node)
+readNodeBindMaterial(const std::string &parentName, CImportXMLTag *tag, Node *node)
 {
   auto num_options = tag->getNumOptions();
   assert(num_options == 0);
@@ -4260,7 +4192,7 @@ readNodeBindMaterial(const std::string &parentName, CXMLTag *tag, Node *node)
 
 bool
 CImportDAE::
-readNodeBindMaterialCommon(const std::string &parentName, CXMLTag *tag, Node *)
+readNodeBindMaterialCommon(const std::string &parentName, CImportXMLTag *tag, Node *)
 {
   auto num_options = tag->getNumOptions();
   assert(num_options == 0);
@@ -4320,7 +4252,7 @@ readNodeBindMaterialCommon(const std::string &parentName, CXMLTag *tag, Node *)
 
 bool
 CImportDAE::
-readScene(const std::string &parentName, CXMLTag *tag, Scene &scene)
+readScene(const std::string &parentName, CImportXMLTag *tag, Scene &scene)
 {
   auto num_options = tag->getNumOptions();
   assert(num_options == 0);
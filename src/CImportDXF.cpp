@@ -2,6 +2,14 @@
 #include <CImportDXFColors.h>
 #include <CGeometry3D.h>
 #include <CStrUtil.h>
+#include <CMathGen.h>
+
+namespace {
+
+// limit of nested block references (stops recursive blocks)
+const int MAX_INSERT_DEPTH = 32;
+
+}
 
 CImportDXF::
 CImportDXF(CGeomScene3D *scene, const std::string &name) :
@@ -18,6 +26,8 @@ CImportDXF(CGeomScene3D *scene, const std::string &name) :
 
   if (! pobject_)
     pobject_ = ObjectP(object_);
+
+  current_ = object_;
 }
 
 CImportDXF::
@@ -55,6 +65,9 @@ read(CFile &file)
     }
   }
 
+  // resolve block references (blocks may be defined after use)
+  addInserts(inserts_, CMatrix3D::identity(), 0);
+
   return true;
 }
 
@@ -88,7 +101,7 @@ readSection()
       return false;
   }
   else if (line == "ENTITIES") {
-    if (! readEntities())
+    if (! readEntities("ENDSEC", inserts_))
       return false;
   }
   else {
@@ -155,8 +168,12 @@ readBlocks()
     if (code == 0) {
       readLine(line);
 
-      if (line == "ENDSEC")
+      if      (line == "ENDSEC")
         break;
+      else if (line == "BLOCK") {
+        if (! readBlock())
+          return false;
+      }
     }
     else
       readLine(line);
@@ -165,9 +182,72 @@ readBlocks()
   return true;
 }
 
+// read block definition into its own object (added to scene as primitive)
+bool
+CImportDXF::
+readBlock()
+{
+  std::string line;
+
+  Block block;
+
+  while (readLine(line)) {
+    int code = int(CStrUtil::toInteger(line));
+
+    if (code == 0) {
+      unreadLine(line);
+      break;
+    }
+
+    readLine(line);
+
+    switch (code) {
+      case 2:
+        block.name = line;
+        break;
+      case 10:
+        block.base.x = CStrUtil::toReal(line);
+        break;
+      case 20:
+        block.base.y = CStrUtil::toReal(line);
+        break;
+      case 30:
+        block.base.z = CStrUtil::toReal(line);
+        break;
+      default:
+        break;
+    }
+  }
+
+  block.object = CGeometry3DInst->createObject3D(scene_, block.name);
+
+  scene_->addPrimitive(block.object);
+
+  current_ = block.object;
+
+  bool rc = readEntities("ENDBLK", block.inserts);
+
+  current_ = object_;
+
+  if (! rc)
+    return false;
+
+  // skip ENDBLK values
+  if (! readEntity())
+    return false;
+
+  if (blocks_.find(block.name) != blocks_.end())
+    std::cerr << "Duplicate block '" << block.name << "'" << std::endl;
+
+  blocks_[block.name] = block;
+
+  return true;
+}
+
+// read entities up to endName (block references added to inserts)
 bool
 CImportDXF::
-readEntities()
+readEntities(const std::string &endName, Inserts &inserts)
 {
   std::string line;
 
@@ -203,6 +283,14 @@ readEntities()
             return false;
         }
         else if (line == "INSERT"  ) {
+          Insert insert;
+
+          if (! readInsertEntity(insert))
+            return false;
+
+          inserts.push_back(insert);
+        }
+        else if (line == "ATTRIB"  ) {
           if (! readEntity())
             return false;
         }
@@ -210,11 +298,12 @@ readEntities()
           if (! readEntity())
             return false;
         }
-        else if (line == "ENDSEC"  )
+        else if (line == endName   )
           return true;
         else {
-          badLine(line);
-          return false;
+          // skip unsupported entity (e.g. ARC, CIRCLE, TEXT in blocks)
+          if (! readEntity())
+            return false;
         }
 
         break;
@@ -320,12 +409,12 @@ read3DFaceEntity()
   for (int i = 0; i < num_points; i++) {
     CPoint3D p(data[i][0], data[i][1], data[i][2]);
 
-    uint ind = object_->addVertex(p);
+    uint ind = current_->addVertex(p);
 
     vertices.push_back(ind);
   }
 
-  auto face_num = object_->addFace(vertices);
+  auto face_num = current_->addFace(vertices);
 
   for (int i = 0; i < 4; i++) {
     if (! visible[i]) {
@@ -339,7 +428,7 @@ read3DFaceEntity()
 
     CRGBA rgba(dxf_color->r, dxf_color->g, dxf_color->b, 1.0);
 
-    object_->setFaceColor(face_num, rgba);
+    current_->setFaceColor(face_num, rgba);
   }
 
   return true;
@@ -480,6 +569,9 @@ readPolyLineEntity()
 
   readLine(line);
 
+  // polyface vertex numbers are relative to the polyline
+  polyBase_ = current_->getNumVertices();
+
   while (line != "SEQEND") {
     if (line == "VERTEX") {
       if (! readVertexEntity(color))
@@ -597,7 +689,7 @@ readVertexEntity(int color)
   if      (vertex) {
     CPoint3D p(x, y, z);
 
-    object_->addVertex(p);
+    current_->addVertex(p);
   }
   else if (face) {
     if (face_num[0] != face_num[1] &&
@@ -606,36 +698,36 @@ readVertexEntity(int color)
       if (face_num[2] != face_num[3]) {
         std::vector<uint> vertices;
 
-        vertices.push_back(uint(face_num[0] - 1));
-        vertices.push_back(uint(face_num[1] - 1));
-        vertices.push_back(uint(face_num[2] - 1));
+        vertices.push_back(polyBase_ + uint(face_num[0] - 1));
+        vertices.push_back(polyBase_ + uint(face_num[1] - 1));
+        vertices.push_back(polyBase_ + uint(face_num[2] - 1));
 
-        uint face_num1 = object_->addFace(vertices);
+        uint face_num1 = current_->addFace(vertices);
 
         if (color > 0 && color < 255) {
           CImportDXFColor *dxf_color = &dxf_colors[color];
 
           CRGBA rgba(dxf_color->r, dxf_color->g, dxf_color->b, 1.0);
 
-          object_->setFaceColor(face_num1, rgba);
+          current_->setFaceColor(face_num1, rgba);
         }
       }
       else {
         std::vector<uint> vertices;
 
-        vertices.push_back(uint(face_num[0] - 1));
-        vertices.push_back(uint(face_num[1] - 1));
-        vertices.push_back(uint(face_num[2] - 1));
-        vertices.push_back(uint(face_num[3] - 1));
+        vertices.push_back(polyBase_ + uint(face_num[0] - 1));
+        vertices.push_back(polyBase_ + uint(face_num[1] - 1));
+        vertices.push_back(polyBase_ + uint(face_num[2] - 1));
+        vertices.push_back(polyBase_ + uint(face_num[3] - 1));
 
-        uint face_num1 = object_->addFace(vertices);
+        uint face_num1 = current_->addFace(vertices);
 
         if (color > 0 && color < 255) {
           CImportDXFColor *dxf_color = &dxf_colors[color];
 
           CRGBA rgba(dxf_color->r, dxf_color->g, dxf_color->b, 1.0);
 
-          object_->setFaceColor(face_num1, rgba);
+          current_->setFaceColor(face_num1, rgba);
         }
       }
     }
@@ -644,6 +736,145 @@ readVertexEntity(int color)
   return true;
 }
 
+bool
+CImportDXF::
+readInsertEntity(Insert &insert)
+{
+  std::string line;
+
+  while (readLine(line)) {
+    int code = int(CStrUtil::toInteger(line));
+
+    if (code == 0) {
+      unreadLine(line);
+      break;
+    }
+
+    readLine(line);
+
+    switch (code) {
+      case 2:
+        insert.block = line;
+        break;
+      case 10:
+        insert.point.x = CStrUtil::toReal(line);
+        break;
+      case 20:
+        insert.point.y = CStrUtil::toReal(line);
+        break;
+      case 30:
+        insert.point.z = CStrUtil::toReal(line);
+        break;
+      case 41:
+        insert.scale.x = CStrUtil::toReal(line);
+        break;
+      case 42:
+        insert.scale.y = CStrUtil::toReal(line);
+        break;
+      case 43:
+        insert.scale.z = CStrUtil::toReal(line);
+        break;
+      case 44:
+        insert.colSpacing = CStrUtil::toReal(line);
+        break;
+      case 45:
+        insert.rowSpacing = CStrUtil::toReal(line);
+        break;
+      case 50:
+        insert.rotation = CStrUtil::toReal(line);
+        break;
+      case 70:
+        insert.numCols = std::max(int(CStrUtil::toInteger(line)), 1);
+        break;
+      case 71:
+        insert.numRows = std::max(int(CStrUtil::toInteger(line)), 1);
+        break;
+      default:
+        break;
+    }
+  }
+
+  return true;
+}
+
+// add instance of each referenced block (and the blocks it references) for each
+// array position
+void
+CImportDXF::
+addInserts(const Inserts &inserts, const CMatrix3D &parentTransform, int depth)
+{
+  if (depth > MAX_INSERT_DEPTH) {
+    std::cerr << "Block references nested too deep" << std::endl;
+    return;
+  }
+
+  for (const auto &insert : inserts) {
+    auto pb = blocks_.find(insert.block);
+
+    if (pb == blocks_.end()) {
+      std::cerr << "Undefined block '" << insert.block << "'" << std::endl;
+      continue;
+    }
+
+    const auto &block = (*pb).second;
+
+    for (int row = 0; row < insert.numRows; ++row) {
+      for (int col = 0; col < insert.numCols; ++col) {
+        auto transform = parentTransform*insertTransform(insert, block, col, row);
+
+        if (block.object->getNumVertices() > 0)
+          addBlockInstance(block, transform);
+
+        addInserts(block.inserts, transform, depth + 1);
+      }
+    }
+  }
+}
+
+void
+CImportDXF::
+addBlockInstance(const Block &block, const CMatrix3D &transform)
+{
+  if (isInstancing()) {
+    Instance instance;
+
+    instance.name      = block.name;
+    instance.mesh      = block.object;
+    instance.transform = transform;
+
+    instances_.push_back(instance);
+  }
+  else {
+    auto *object = CGeometry3DInst->dupObject(block.object);
+
+    object->setScene(scene_);
+    object->setName(block.name);
+
+    object->transform(transform);
+
+    scene_->addObject(object);
+  }
+}
+
+// block to insert transform (block base point moved to insert point after scale,
+// array offset and rotation about Z)
+CMatrix3D
+CImportDXF::
+insertTransform(const Insert &insert, const Block &block, int col, int row) const
+{
+  auto base  = CMatrix3D::translation(-block.base.x, -block.base.y, -block.base.z);
+  auto scale = CMatrix3D::scale(insert.scale.x, insert.scale.y, insert.scale.z);
+  auto cell  = CMatrix3D::translation(col*insert.colSpacing, row*insert.rowSpacing, 0.0);
+
+  CMatrix3D rotate;
+
+  rotate.setRotation(CMathGen::Z_AXIS_3D, CMathGen::DegToRad(insert.rotation));
+
+  auto point = CMatrix3D::translation(insert.point.x, insert.point.y, insert.point.z);
+
+  return point*rotate*cell*scale*base;
+}
+
 bool
 CImportDXF::
 readEntity()
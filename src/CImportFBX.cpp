@@ -1,7 +1,10 @@
 #include <CImportFBX.h>
+#include <CImportParallel.h>
 #include <CGeometry3D.h>
 #include <CStrParse.h>
 
+#include <algorithm>
+#include <chrono>
 #include <set>
 
 //---
@@ -48,6 +51,12 @@ void debugMsg(const std::string &msg) {
   std::cerr << msg << "\n";
 }
 
+using Clock = std::chrono::steady_clock;
+
+double elapsedSecs(const Clock::time_point &t1, const Clock::time_point &t2) {
+  return std::chrono::duration<double>(t2 - t1).count();
+}
+
 }
 
 //---
@@ -128,21 +137,41 @@ readBinary(bool &isBin)
     return true;
   };
 
+  phaseTimes_ = PhaseTimes();
+
+  auto t1 = Clock::now();
+
+  // file memory is kept (properties are decoded from it when used)
   FileData fileData;
 
-  fileData.filePos  = 27;
-  fileData.fileSize = uint(file_->getSize());
+  fileData.filePos = 27;
 
-  file_->setPos(0);
+  if (isMapFile()) {
+    if (! mapFile_.open(file_->getPath()))
+      return errorMsg("Failed to read file");
 
-  if (! readFileBytes(fileData.fileSize, fileData.fileMem))
-    return errorMsg("Failed to read file");
+    fileData.fileBytes = mapFile_.data();
+    fileData.fileSize  = mapFile_.size();
+  }
+  else {
+    fileData.fileSize = uint(file_->getSize());
 
-  fileData.fileBytes = &fileData.fileMem[0];
+    file_->setPos(0);
+
+    if (! readFileBytes(fileData.fileSize, fileMem_))
+      return errorMsg("Failed to read file");
+
+    fileData.fileBytes = &fileMem_[0];
+  }
+
+  phaseTimes_.read = elapsedSecs(t1, Clock::now());
 
   if (! readFileData(fileData))
     return false;
 
+  if (isTiming())
+    printPhaseTimes();
+
   return true;
 }
 
@@ -1365,6 +1394,8 @@ readFileData(FileData &fileData)
 
   //---
 
+  auto t1 = Clock::now();
+
   propDataTree_ = new PropDataTree;
 
   std::string scopeName;
@@ -1374,6 +1405,18 @@ readFileData(FileData &fileData)
       (void) errorMsg("readScope failed");
   }
 
+  auto t2 = Clock::now();
+
+  phaseTimes_.tree = elapsedSecs(t1, t2);
+
+  //---
+
+  inflateArrays();
+
+  auto t3 = Clock::now();
+
+  phaseTimes_.inflate = elapsedSecs(t2, t3);
+
   //---
 
   if (isDump())
@@ -1461,6 +1504,8 @@ readFileData(FileData &fileData)
       addGeometryObject(modelData->geometryData);
   }
 
+  phaseTimes_.geometry = elapsedSecs(t3, Clock::now());
+
   //---
 
 #if 0
@@ -4543,7 +4588,7 @@ processGeometryDataTree(PropDataTree *tree, GeometryData *geometryData)
             auto *data = pa1.second;
 
             if (data->type() == DataType::INT_ARRAY) {
-              vertexData.indices = data->getArrayData<int>();
+              vertexData.indices = data->takeArrayData<int>();
               vertexData.set     = true;
             }
             else
@@ -4557,7 +4602,7 @@ processGeometryDataTree(PropDataTree *tree, GeometryData *geometryData)
             auto *data = pa1.second;
 
             if (data->type() == DataType::DOUBLE_ARRAY) {
-              vertexData.values = data->getArrayData<double>();
+              vertexData.values = data->takeArrayData<double>();
               vertexData.set    = true;
             }
             else
@@ -4571,7 +4616,7 @@ processGeometryDataTree(PropDataTree *tree, GeometryData *geometryData)
             auto *data = pa1.second;
 
             if (data->type() == DataType::INT_ARRAY)
-              geometryData->edges = data->getArrayData<int>();
+              geometryData->edges = data->takeArrayData<int>();
             else
               errorMsg("Unexpected type for " + name);
           }
@@ -4594,7 +4639,7 @@ processGeometryDataTree(PropDataTree *tree, GeometryData *geometryData)
             auto *data = pa1.second;
 
             if (data->type() == DataType::INT_ARRAY) {
-              normalData.indices = data->getArrayData<int>();
+              normalData.indices = data->takeArrayData<int>();
               normalData.set     = true;
             }
             else
@@ -4608,7 +4653,7 @@ processGeometryDataTree(PropDataTree *tree, GeometryData *geometryData)
             auto *data = pa1.second;
 
             if (data->type() == DataType::DOUBLE_ARRAY) {
-              normalData.values = data->getArrayData<double>();
+              normalData.values = data->takeArrayData<double>();
               normalData.set    = true;
             }
             else
@@ -4646,7 +4691,7 @@ processGeometryDataTree(PropDataTree *tree, GeometryData *geometryData)
             auto *data = pa1.second;
 
             if (data->type() == DataType::INT_ARRAY) {
-              colorData.indices = data->getArrayData<int>();
+              colorData.indices = data->takeArrayData<int>();
               colorData.set     = true;
             }
             else
@@ -4660,7 +4705,7 @@ processGeometryDataTree(PropDataTree *tree, GeometryData *geometryData)
             auto *data = pa1.second;
 
             if (data->type() == DataType::DOUBLE_ARRAY) {
-              colorData.values = data->getArrayData<double>();
+              colorData.values = data->takeArrayData<double>();
               colorData.set    = true;
             }
             else
@@ -4696,7 +4741,7 @@ processGeometryDataTree(PropDataTree *tree, GeometryData *geometryData)
             auto *data = pa1.second;
 
             if (data->type() == DataType::INT_ARRAY) {
-              uvData.indices = data->getArrayData<int>();
+              uvData.indices = data->takeArrayData<int>();
               uvData.set     = true;
             }
             else
@@ -4710,7 +4755,7 @@ processGeometryDataTree(PropDataTree *tree, GeometryData *geometryData)
             auto *data = pa1.second;
 
             if (data->type() == DataType::DOUBLE_ARRAY) {
-              uvData.values = data->getArrayData<double>();
+              uvData.values = data->takeArrayData<double>();
               uvData.set    = true;
             }
             else
@@ -4752,7 +4797,7 @@ processGeometryDataTree(PropDataTree *tree, GeometryData *geometryData)
             auto *data = pa1.second;
 
             if (data->type() == DataType::INT_ARRAY)
-              geometryData->materials = data->getArrayData<int>();
+              geometryData->materials = data->takeArrayData<int>();
             else
               errorMsg("Unexpected type for " + name);
           }
@@ -4942,13 +4987,15 @@ readScope(FileData &fileData, const std::string &scopeName, PropDataTree *propDa
 
     fileData.filePos = endOffset - nullLen;
 
-    if (! fileData.readBytes(nullLen)) {
+    const uchar *nullData;
+
+    if (! fileData.readBytes(nullLen, nullData)) {
       fileData.filePos = filePos1;
       return false;
     }
 
     for (uint ic = 0; ic < nullLen; ++ic) {
-      if (fileData.buffer[ic] != 0) {
+      if (nullData[ic] != 0) {
         fileData.filePos = filePos1;
         return false;
       }
@@ -4963,10 +5010,7 @@ readScope(FileData &fileData, const std::string &scopeName, PropDataTree *propDa
 
   fileData1.fileBytes = fileData.fileBytes;
   fileData1.filePos   = fileData.filePos;
-  fileData1.fileSize  = endOffset + 1;
-
-  if (fileData1.fileSize > fileData.fileMem.size())
-    fileData1.fileSize = int(fileData.fileMem.size());
+  fileData1.fileSize  = std::min(endOffset + 1, fileData.fileSize);
 
   auto isNullRecord = testNullRecord();
 
@@ -5041,6 +5085,70 @@ readScope(FileData &fileData, const std::string &scopeName, PropDataTree *propDa
   return true;
 }
 
+// inflate compressed arrays (used by geometry so decoded together rather than on use)
+//
+// Each array is an independent zlib stream decoded into its own property so arrays
+// are inflated concurrently, largest first so a big array is not left until last.
+void
+CImportFBX::
+inflateArrays()
+{
+  auto props = compressedProps_;
+
+  std::stable_sort(props.begin(), props.end(), [](const PropData *lhs, const PropData *rhs) {
+    return (lhs->compressedLen() > rhs->compressedLen());
+  });
+
+  auto nt = (isDebug() ? 1 : numThreads());
+
+  CImportParallel::parallelFor(props.size(), nt, [&](size_t i) {
+    props[i]->decodeArray();
+  });
+}
+
+void
+CImportFBX::
+printPhaseTimes() const
+{
+  std::cerr << "FBX read: "   << phaseTimes_.read     << "s" <<
+               " tree: "     << phaseTimes_.tree     << "s" <<
+               " inflate: "  << phaseTimes_.inflate  << "s" <<
+               " geometry: " << phaseTimes_.geometry << "s" <<
+               " (" << compressedProps_.size() << " compressed arrays)\n";
+}
+
+void
+CImportFBX::PropData::
+decodeArray() const
+{
+  if (! std::holds_alternative<std::monostate>(array_))
+    return;
+
+  FileData fileData;
+
+  fileData.fileBytes = data_;
+  fileData.fileSize  = len_;
+
+  auto decode = [&](auto &&a) {
+    if (! fileData.readArrayData(a, char(code_), 0))
+      a.clear();
+
+    array_ = std::move(a);
+  };
+
+  switch (code_) {
+    case 'R': array_ = std::vector<uchar>(data_ + 4, data_ + len_); break;
+    case 'b': decode(std::vector<uchar >()); break;
+    case 'i': decode(std::vector<int   >()); break;
+    case 'l': decode(std::vector<long  >()); break;
+    case 'f': decode(std::vector<float >()); break;
+    case 'd': decode(std::vector<double>()); break;
+    default : assert(false); break;
+  }
+}
+
+//---
+
 std::string
 CImportFBX::
 getObjectName()
@@ -5070,159 +5178,96 @@ readScopeData(const std::string &name, uint ni, uint ind, FileData &fileData,
 
   //---
 
-  auto *propData = new PropData;
-
   uchar t;
   if (! fileData.readUChar(&t))
     return errorMsg("Failed to read data type");
 
-  // raw binary data
-  if      (t == 'R') {
-    uint len;
-    if (! fileData.readUInt(&len))
-      return errorMsg("Failed to read len for " + ucharStr(t));
+  // record property bytes (decoded when used)
+  auto startPos = fileData.filePos;
 
-    if (! fileData.readBytes(len))
+  auto readScalar = [&](ulong size) {
+    if (! fileData.skipBytes(size))
       return errorMsg("Failed to read data for " + ucharStr(t));
-    infoMsg(" R " + std::to_string(len));
+    return true;
+  };
 
-    auto rdata = fileData.buffer;
+  auto readArray = [&](ulong esize) {
+    fileData.depth = depth_;
+    return fileData.skipArrayData(uint(esize), char(t));
+  };
 
-    propData->setData(rdata);
-  }
-  // string
-  else if (t == 'S') {
+  // raw binary data or string
+  if      (t == 'R' || t == 'S') {
     uint len;
     if (! fileData.readUInt(&len))
       return errorMsg("Failed to read len for " + ucharStr(t));
 
-    std::string str;
-    if (! fileData.readStr(len, str))
+    if (! fileData.skipBytes(len))
       return errorMsg("Failed to read data for " + ucharStr(t));
-
-    infoMsg(" S " + std::to_string(len) + " '" + str + "'");
-
-    propData->setData(str);
   }
   // 16 bit int
   else if (t == 'Y') {
-    short s;
-    if (! fileData.readShort(&s))
-      return errorMsg("Failed to read data for " + ucharStr(t));
-    infoMsg(" Y " + std::to_string(s));
-
-    propData->setData(s);
+    if (! readScalar(sizeof(short))) return false;
   }
   // 1 bit bool flag (yes/no)
   else if (t == 'C') {
-    uchar c;
-    if (! fileData.readUChar(&c))
-      return errorMsg("Failed to read data for " + ucharStr(t));
-    infoMsg(" C " + ucharStr(c));
+    if (! readScalar(sizeof(uchar))) return false;
   }
   // 32 bit int
   else if (t == 'I') {
-    int i;
-    if (! fileData.readInt(&i))
-      return errorMsg("Failed to read data for " + ucharStr(t));
-    infoMsg(" I " + std::to_string(i));
-
-    propData->setData(i);
+    if (! readScalar(sizeof(int))) return false;
   }
   // float
   else if (t == 'F') {
-    float f;
-    if (! fileData.readFloat(&f))
-      return errorMsg("Failed to read data for " + ucharStr(t));
-    infoMsg(" F " + std::to_string(f));
-
-    propData->setData(f);
+    if (! readScalar(sizeof(float))) return false;
   }
   // double
   else if (t == 'D') {
-    double r;
-    if (! fileData.readDouble(&r))
-      return errorMsg("Failed to read data for " + ucharStr(t));
-    infoMsg(" D " + std::to_string(r));
-
-    propData->setData(r);
+    if (! readScalar(sizeof(double))) return false;
   }
   // 64 bit int
   else if (t == 'L') {
-    long l;
-    if (! fileData.readLong(&l))
-      return errorMsg("Failed to read data for " + ucharStr(t));
-    infoMsg(" L " + std::to_string(l));
-
-    propData->setData(l);
+    if (! readScalar(sizeof(long))) return false;
   }
   // array of float
   else if (t == 'f') {
-    std::vector<float> data;
-    if (! fileData.readArrayData(data, t, depth_))
-      return false;
-
-    propData->setData(data);
-
-    infoMsg(" f " + propData->toString());
+    if (! readArray(sizeof(float))) return false;
   }
   // array of double
   else if (t == 'd') {
-    std::vector<double> data;
-    if (! fileData.readArrayData(data, t, depth_))
-      return false;
-
-    propData->setData(data);
-
-    infoMsg(" d " + propData->toString());
+    if (! readArray(sizeof(double))) return false;
   }
   // array of long
   else if (t == 'l') {
-    std::vector<long> data;
-    if (! fileData.readArrayData(data, t, depth_))
-      return false;
-
-    propData->setData(data);
-
-    infoMsg(" l " + propData->toString());
+    if (! readArray(sizeof(long))) return false;
   }
   // array of int
   else if (t == 'i') {
-    std::vector<int> data;
-    if (! fileData.readArrayData(data, t, depth_))
-      return false;
-
-    propData->setData(data);
-
-    infoMsg(" i " + propData->toString());
+    if (! readArray(sizeof(int))) return false;
   }
-#if 0
-  // array of char
-  else if (t == 'c') {
-    std::vector<uchar> data;
-    if (! fileData.readArrayData(data, t, depth_))
-      return false;
-
-    propData->setData(data);
-
-    infoMsg(" c " + propData->toString());
-  }
-#endif
   // binary data
   else if (t == 'b') {
-    std::vector<uchar> data;
-    if (! fileData.readArrayData(data, t, depth_))
-      return false;
-
-    propData->setData(data);
-
-    infoMsg(" b " + propData->toString());
+    if (! readArray(sizeof(uchar))) return false;
   }
   else {
     std::cerr << "Invalid Code: "; printUChar(t); std::cerr << "\n";
     return false;
   }
 
+  propDatas_.emplace_back(t, fileData.fileBytes + startPos, fileData.filePos - startPos);
+
+  auto *propData = &propDatas_.back();
+
+  if (propData->isCompressed())
+    compressedProps_.push_back(propData);
+
+  if (isDebug()) {
+    if (t == 'C')
+      infoMsg(" C " + ucharStr(propData->getData<uchar>()));
+    else
+      infoMsg(" " + std::string(1, char(t)) + " " + propData->toString());
+  }
+
   propDataTree->dataMap[name][ni][ind] = propData;
 
 #if 0
@@ -5,6 +5,9 @@
 #include <CMinMax.h>
 #include <CQuaternion.h>
 #include <CEncode64.h>
+#include <CImportParallel.h>
+
+#include <set>
 
 namespace {
 
@@ -70,6 +73,36 @@ void printVector(const std::string &name, const std::vector<T> &v) {
   std::cerr << "\n";
 }
 
+bool isHostBigEndian() {
+  static const uint one = 1;
+
+  return (*reinterpret_cast<const uchar *>(&one) == 0);
+}
+
+int componentTypeSize(long componentType) {
+  switch (componentType) {
+    case Constants::TYPE_SIGNED_BYTE   : return 1;
+    case Constants::TYPE_UNSIGNED_BYTE : return 1;
+    case Constants::TYPE_SIGNED_SHORT  : return 2;
+    case Constants::TYPE_UNSIGNED_SHORT: return 2;
+    case Constants::TYPE_SIGNED_INT    : return 4;
+    case Constants::TYPE_UNSIGNED_INT  : return 4;
+    case Constants::TYPE_FLOAT         : return 4;
+    default                            : return 0;
+  }
+}
+
+int typeNumComponents(const std::string &type) {
+  if      (type == "SCALAR") return 1;
+  else if (type == "VEC2"  ) return 2;
+  else if (type == "VEC3"  ) return 3;
+  else if (type == "VEC4"  ) return 4;
+  else if (type == "MAT2"  ) return 4;
+  else if (type == "MAT3"  ) return 9;
+  else if (type == "MAT4"  ) return 16;
+  else                       return 0;
+}
+
 }
 
 //---
@@ -109,6 +142,9 @@ read(CFile &file)
 
   binary_ = false;
 
+  // decode images in background when threaded
+  imageCache_.setNumWorkers(numThreads() != 1 ? CImportParallel::numThreads(numThreads()) : 0);
+
   //---
 
   // check magic for bin file
@@ -140,25 +176,70 @@ bool
 CImportGLTF::
 readBin()
 {
-  uchar buffer[256];
+  // map whole file so chunks reference the file data directly (no copy)
+  size_t mpos = 4; // after magic
+
+  if (isMapFile()) {
+    if (! mapFile_.open(file_->getPath()))
+      return errorMsg("failed to map file");
+  }
+
+  auto readBytes = [&](uchar *data, size_t n) {
+    if (mapFile_.isOpen()) {
+      if (mpos + n > mapFile_.size())
+        return false;
+
+      memcpy(data, mapFile_.data() + mpos, n);
+
+      mpos += n;
+
+      return true;
+    }
+
+    return file_->read(data, n);
+  };
+
+  uchar buffer[4];
 
   auto readInteger = [&](uint *integer) {
-    if (! file_->read(buffer, 4))
+    if (! readBytes(buffer, 4))
       return false;
 
     *integer = ((buffer[0] & 0xFF)      ) |
                ((buffer[1] & 0xFF) <<  8) |
                ((buffer[2] & 0xFF) << 16) |
                ((buffer[3] & 0xFF) << 24);
-/*
-    *integer = ((buffer[3] & 0xFF)      ) |
-               ((buffer[2] & 0xFF) <<  8) |
-               ((buffer[1] & 0xFF) << 16) |
-               ((buffer[0] & 0xFF) << 24);
-*/
+
     return true;
   };
 
+  // reference chunk data in mapped file or read it into chunk buffer
+  auto readChunkData = [&](Chunk &chunk) {
+    if (mapFile_.isOpen()) {
+      if (mpos + chunk.length > mapFile_.size())
+        return errorMsg("failed to read chunk");
+
+      chunk.buffer.ref = mapFile_.data() + mpos;
+      chunk.buffer.len = chunk.length;
+
+      mpos += chunk.length;
+
+      return true;
+    }
+
+    chunk.buffer.owned.resize(chunk.length);
+
+    if (chunk.length > 0 && ! file_->read(&chunk.buffer.owned[0], chunk.length))
+      return errorMsg("failed to read chunk");
+
+    return true;
+  };
+
+  auto chunkString = [](const Chunk &chunk) {
+    return std::string_view(reinterpret_cast<const char *>(chunk.buffer.data()),
+                            chunk.buffer.size());
+  };
+
   //---
 
   // get version (should be 1 or 2)
@@ -192,17 +273,11 @@ readBin()
     if (! readInteger(&chunk.type))
       return false;
 
-    chunk.buffer.data.resize(chunk.length + 1);
-
-    if (! file_->read(&chunk.buffer.data[0], chunk.length))
-      return errorMsg("failed to read chunk");
+    if (! readChunkData(chunk))
+      return false;
 
     // parse json
-    chunk.buffer.data[chunk.length] = '\0';
-
-    std::string str(reinterpret_cast<char *>(&chunk.buffer.data[0]));
-
-    if (! parseJson(str, jsonData_))
+    if (! parseJson(chunkString(chunk), jsonData_))
       return false;
 
     fpos   += chunk.length + 8;
@@ -210,14 +285,14 @@ readBin()
 
     //---
 
-    chunk.length = length;
+    Chunk binChunk;
 
-    chunk.buffer.data.resize(chunk.length + 1);
+    binChunk.length = length;
 
-    if (! file_->read(&chunk.buffer.data[0], chunk.length))
-      return errorMsg("failed to read chunk");
+    if (! readChunkData(binChunk))
+      return false;
 
-    jsonData_.chunks.push_back(std::move(chunk));
+    jsonData_.chunks.push_back(std::move(binChunk));
   }
   else if (version_ == 2) {
     // read chunks
@@ -232,10 +307,8 @@ readBin()
       if (! readInteger(&chunk.type))
         return false;
 
-      chunk.buffer.data.resize(chunk.length + 1);
-
-      if (! file_->read(&chunk.buffer.data[0], chunk.length))
-        return errorMsg("failed to read chunk");
+      if (! readChunkData(chunk))
+        return false;
 
       if (chunk.type == 0) {
         if (ic == 0)
@@ -246,19 +319,15 @@ readBin()
 
       if      (chunk.type == 0x4e4f534a) { // "JSON"
         // parse json
-        chunk.buffer.data[chunk.length] = '\0';
-
-        std::string str(reinterpret_cast<char *>(&chunk.buffer.data[0]));
-
-        if (! parseJson(str, jsonData_))
+        if (! parseJson(chunkString(chunk), jsonData_))
           return false;
       }
       else if (chunk.type == 0x004e4942) { // "BIN"
-        // add bin
-        jsonData_.chunks.push_back(chunk);
-
         if (isDebug())
           std::cerr << "BIN: " << fpos << " " << chunk.length << "\n";
+
+        // add bin
+        jsonData_.chunks.push_back(std::move(chunk));
       }
       else
         return errorMsg("Invalid chunk");
@@ -286,10 +355,19 @@ bool
 CImportGLTF::
 readJson()
 {
-  auto str = file_->toString();
+  if (isMapFile()) {
+    if (! mapFile_.open(file_->getPath()))
+      return errorMsg("failed to map file");
 
-  if (str != "" && ! parseJson(str, jsonData_))
-    return false;
+    if (mapFile_.size() > 0 && ! parseJson(mapFile_.view(), jsonData_))
+      return false;
+  }
+  else {
+    auto str = file_->toString();
+
+    if (str != "" && ! parseJson(str, jsonData_))
+      return false;
+  }
 
   //---
 
@@ -305,29 +383,67 @@ bool
 CImportGLTF::
 processData()
 {
+  // resolve accessor buffer data (serial as it may load buffer files), decode
+  // accessors in parallel and then add them to meshDatas_ in accessor order
+  struct AccessorJob {
+    const IndName*  indName  { nullptr };
+    const Accessor* accessor { nullptr };
+    AccessorView    view;
+    MeshData        meshData;
+    bool            valid    { false };
+  };
+
+  std::vector<AccessorJob> accessorJobs(jsonData_.accessors.size());
+
+  size_t ia = 0;
+
   for (const auto &pa : jsonData_.accessors) {
-    const auto &accessor = pa.second;
+    auto &job = accessorJobs[ia++];
+
+    job.indName  = &pa.first;
+    job.accessor = &pa.second;
+
+    if (! job.accessor->sparse)
+      job.valid = getAccessorView(job.accessor->bufferView, job.accessor->byteOffset,
+                                  job.accessor->type, job.accessor->componentType,
+                                  job.accessor->count, job.view);
+  }
+
+  // debug data output is not interleaved
+  auto nt = (isDebugData() ? 1 : numThreads());
 
+  CImportParallel::parallelFor(accessorJobs.size(), nt, [&](size_t i) {
+    auto &job = accessorJobs[i];
+
+    if (! job.accessor->sparse && job.valid)
+      job.valid = processAccessor(*job.accessor, job.view, job.meshData);
+  });
+
+  for (auto &job : accessorJobs) {
     bool rc;
 
-    if (accessor.sparse)
-      rc = processSparseAccessor(pa.first, accessor);
-    else
-      rc = processAccessor(pa.first, accessor);
+    if (job.accessor->sparse)
+      rc = processSparseAccessor(*job.indName, *job.accessor);
+    else {
+      rc = job.valid;
+
+      if (rc)
+        meshDatas_.add(std::move(job.meshData), *job.indName);
+    }
 
     if (! rc)
       std::cerr << "process Accessor failed\n";
   }
 
+  accessorJobs.clear();
+
   //---
 
   // get images
 
   auto processImage = [&](const Image &image) {
-    const uchar* data;
-    long         len;
-
-    if (! getImageData(image, data, len))
+    // record image source only (decoded on first use)
+    if (! recordImage(image))
       return false;
 
     if (image.uri == "") {
@@ -335,6 +451,12 @@ processData()
           image.mimeType == "image/jpeg" ||
           image.mimeType == "image/webp") {
         if (isSaveImage() && image.name != "") {
+          const uchar* data;
+          long         len;
+
+          if (! getImageData(image, data, len))
+            return false;
+
           if (! writeFile(image.name, data, len))
             return errorMsg("Image write failed");
         }
@@ -385,6 +507,47 @@ processData()
 
   //---
 
+  // prepare primitive geometry of node meshes in parallel
+  std::set<const Mesh *>         nodeMeshes;
+  std::vector<const Primitive *> primitives;
+
+  for (const auto &pn : jsonData_.nodes) {
+    const Mesh *mesh = nullptr;
+
+    if (pn.second.mesh.isEmpty() || ! getMesh(pn.second.mesh, mesh))
+      continue;
+
+    if (! nodeMeshes.insert(mesh).second)
+      continue;
+
+    for (const auto &primitive : mesh->primitives) {
+      primitiveGeoms_[&primitive] = PrimitiveGeom();
+
+      primitives.push_back(&primitive);
+    }
+  }
+
+  // only images of node mesh materials are decoded in background
+  for (const auto *primitive : primitives)
+    prefetchMaterialImages(primitive->material);
+
+  CImportParallel::parallelFor(primitives.size(), numThreads(), [&](size_t i) {
+    preparePrimitive(*primitives[i], primitiveGeoms_.find(primitives[i])->second);
+  });
+
+  //---
+
+  // count unskinned node uses of each mesh (mesh geometry used by more than one
+  // node is built once and copied)
+  meshUseCount_.clear();
+
+  for (const auto &pn : jsonData_.nodes) {
+    const auto &node = pn.second;
+
+    if (! node.mesh.isEmpty() && node.skin.isEmpty())
+      ++meshUseCount_[node.mesh];
+  }
+
   // process nodes with mesh (individual objects)
   for (auto &pn : jsonData_.nodes) {
     auto &node = pn.second;
@@ -395,6 +558,12 @@ processData()
     }
   }
 
+  // instanced nodes have no object so add their node data once for all
+  if (! instances_.empty())
+    initNodesData();
+
+  primitiveGeoms_.clear();
+
   // TODO: node for multiple objects ?
   for (auto &pn : jsonData_.nodes) {
     auto &node = pn.second;
@@ -438,17 +607,15 @@ bool
 CImportGLTF::
 processSparseAccessor(const IndName &indName, const Accessor &accessor)
 {
-  AccessorData valuesAccessorData, indicesAccessorData;
+  AccessorView valuesView, indicesView;
 
-  valuesAccessorData.data =
-    getAccessorBufferData(accessor.sparseValuesBufferView, 0,
-                          valuesAccessorData.byteLength, valuesAccessorData.byteStride);
-  if (! valuesAccessorData.data) return false;
+  if (! getAccessorView(accessor.sparseValuesBufferView, 0, accessor.type,
+                        accessor.componentType, accessor.sparseCount, valuesView))
+    return false;
 
-  indicesAccessorData.data =
-    getAccessorBufferData(accessor.sparseIndicesBufferView, 0,
-                          indicesAccessorData.byteLength, indicesAccessorData.byteStride);
-  if (! indicesAccessorData.data) return false;
+  if (! getAccessorView(accessor.sparseIndicesBufferView, 0, "SCALAR",
+                        accessor.sparseIndicesComponentType, accessor.sparseCount, indicesView))
+    return false;
 
   MeshData valuesMeshData;
 
@@ -456,7 +623,7 @@ processSparseAccessor(const IndName &indName, const Accessor &accessor)
   valuesMeshData.componentType = accessor.componentType;
   valuesMeshData.count         = accessor.sparseCount;
 
-  if (! readMeshData(valuesAccessorData, valuesMeshData))
+  if (! readMeshData(valuesView, valuesMeshData))
     return false;
 
   MeshData indicesMeshData;
@@ -465,7 +632,7 @@ processSparseAccessor(const IndName &indName, const Accessor &accessor)
   indicesMeshData.componentType = accessor.sparseIndicesComponentType;
   indicesMeshData.count         = accessor.sparseCount;
 
-  if (! readMeshData(indicesAccessorData, indicesMeshData))
+  if (! readMeshData(indicesView, indicesMeshData))
     return false;
 
   MeshData meshData;
@@ -477,13 +644,11 @@ processSparseAccessor(const IndName &indName, const Accessor &accessor)
   meshData.max           = accessor.max;
 
   if (meshData.type == "VEC3") {
-    Vec3 v;
-
     meshData.vec3.resize(accessor.count);
 
     for (int i = 0; i < accessor.sparseCount; ++i) {
       auto ind = indicesMeshData.iscalars[i];
-      if (ind < 0 || ind > accessor.count)
+      if (ind < 0 || ind >= accessor.count)
         return errorMsg("Invalid sparse index " + std::to_string(ind));
 
       meshData.vec3[ind] = valuesMeshData.vec3[i];
@@ -492,237 +657,182 @@ processSparseAccessor(const IndName &indName, const Accessor &accessor)
   else
     return errorMsg("Invalid sparse type " + meshData.type);
 
-  meshDatas_.add(meshData, indName);
+  meshDatas_.add(std::move(meshData), indName);
 
   return true;
 }
 
-// get mesh data from accessors
+// get mesh data from accessor view (buffer data only read so can run in parallel)
 bool
 CImportGLTF::
-processAccessor(const IndName &indName, const Accessor &accessor)
+processAccessor(const Accessor &accessor, const AccessorView &view, MeshData &meshData) const
 {
-  AccessorData accessorData;
-
-  accessorData.data = getAccessorBufferData(accessor.bufferView, accessor.byteOffset,
-                                            accessorData.byteLength, accessorData.byteStride);
-  if (! accessorData.data) return false;
-
-  MeshData meshData;
-
   meshData.type          = accessor.type;
   meshData.componentType = accessor.componentType;
   meshData.count         = accessor.count;
   meshData.min           = accessor.min;
   meshData.max           = accessor.max;
 
-  if (! readMeshData(accessorData, meshData))
+  if (! readMeshData(view, meshData))
     return false;
 
-  meshDatas_.add(meshData, indName);
-
   return true;
 }
 
+// resolve typed view of count elements at byteOffset in buffer view
 bool
 CImportGLTF::
-readMeshData(const AccessorData &accessorData, MeshData &meshData) const
+getAccessorView(const IndName &bufferView, long byteOffset, const std::string &type,
+                long componentType, long count, AccessorView &view)
 {
-  const auto *data       = accessorData.data;
-  auto        byteStride = accessorData.byteStride;
-  auto        byteLength = accessorData.byteLength;
+  long byteLength = 0;
+  int  byteStride = 0;
 
-  // 1 component
-  if      (meshData.type == "SCALAR") {
-    if      (meshData.componentType == Constants::TYPE_UNSIGNED_BYTE) {
-      if (byteStride <= 0)
-        byteStride = 1;
+  view.data = getAccessorBufferData(bufferView, byteOffset, byteLength, byteStride);
+  if (! view.data) return false;
 
-      if (byteLength < meshData.count*byteStride)
-        return errorMsg("Invalid " + meshData.type + " count");
+  if (byteOffset > 0)
+    byteLength -= byteOffset;
 
-      int id1 = 0;
+  view.count         = std::max(count, 0L);
+  view.componentType = componentType;
+  view.numComponents = typeNumComponents(type);
+  view.elementSize   = view.numComponents*componentTypeSize(componentType);
+  view.byteStride    = (byteStride > 0 ? byteStride : view.elementSize);
+  view.swap          = isHostBigEndian();
 
-      for (long i = 0; i < meshData.count; ++i) {
-        auto l = readByte(data, id1); id1 += byteStride;
+  // unsupported types are reported by readMeshData
+  if (view.elementSize <= 0)
+    return true;
 
-        meshData.iscalars.push_back(l);
-      }
-    }
-    else if (meshData.componentType == Constants::TYPE_UNSIGNED_SHORT) {
-      if (byteStride <= 0)
-        byteStride = 2;
+  if (view.count > 0 &&
+      byteLength < (view.count - 1)*view.byteStride + view.elementSize)
+    return errorMsg("Invalid " + type + " count");
+
+  return true;
+}
+
+bool
+CImportGLTF::
+readMeshData(const AccessorView &view, MeshData &meshData) const
+{
+  auto count = view.count;
 
-      if (byteLength < meshData.count*byteStride)
-        return errorMsg("Invalid " + meshData.type + " count");
+  auto invalidComponentType = [&]() {
+    return errorMsg("Invalid " + meshData.type + " component type " +
+                    std::to_string(meshData.componentType));
+  };
 
-      int id1 = 0;
+  // copy float elements to packed float array (one memcpy when packed)
+  auto readFloats = [&](void *dst) {
+    auto *bdst  = static_cast<uchar *>(dst);
+    auto  esize = size_t(view.elementSize);
 
-      for (long i = 0; i < meshData.count; ++i) {
-        auto s = readShort(data, id1); id1 += byteStride;
+    if      (view.swap) {
+      auto *fdst = reinterpret_cast<float *>(bdst);
 
-        meshData.iscalars.push_back(s);
-      }
+      for (long i = 0; i < count; ++i)
+        for (int c = 0; c < view.numComponents; ++c)
+          *fdst++ = view.value<float>(i, c);
     }
-    else if (meshData.componentType == Constants::TYPE_UNSIGNED_INT) {
-      if (byteStride <= 0)
-        byteStride = 4;
+    else if (view.isPacked()) {
+      memcpy(bdst, view.data, count*esize);
+    }
+    else {
+      const auto *src = view.data;
 
-      if (byteLength < meshData.count*byteStride)
-        return errorMsg("Invalid " + meshData.type + " count");
+      for (long i = 0; i < count; ++i, src += view.byteStride, bdst += esize)
+        memcpy(bdst, src, esize);
+    }
+  };
 
-      int id1 = 0;
+  // convert integer components to destination type
+  auto readInts = [&](auto *dst, auto itype) {
+    using T = decltype(itype);
 
-      for (long i = 0; i < meshData.count; ++i) {
-        auto l = readInt(data, id1); id1 += byteStride;
+    long stride = 0;
 
-        meshData.iscalars.push_back(l);
-      }
+    if (const auto *src = view.span<T>(stride)) {
+      for (long i = 0; i < count; ++i, src += stride)
+        for (int c = 0; c < view.numComponents; ++c)
+          *dst++ = src[c];
     }
-    else if (meshData.componentType == Constants::TYPE_FLOAT) {
-      if (byteStride <= 0)
-        byteStride = 4;
+    else {
+      for (long i = 0; i < count; ++i)
+        for (int c = 0; c < view.numComponents; ++c)
+          *dst++ = view.value<T>(i, c);
+    }
+  };
 
-      if (byteLength < meshData.count*byteStride)
-        return errorMsg("Invalid " + meshData.type + " count");
+  static_assert(sizeof(Vec2) == 2*sizeof(float), "Vec2 not packed");
+  static_assert(sizeof(Vec3) == 3*sizeof(float), "Vec3 not packed");
+  static_assert(sizeof(Vec4) == 4*sizeof(float), "Vec4 not packed");
 
-      int id1 = 0;
+  // 1 component
+  if      (meshData.type == "SCALAR") {
+    if      (meshData.componentType == Constants::TYPE_UNSIGNED_BYTE) {
+      meshData.iscalars.resize(count);
 
-      for (long i = 0; i < meshData.count; ++i) {
-        auto f = readFloat(data, id1); id1 += byteStride;
+      readInts(meshData.iscalars.data(), uchar());
+    }
+    else if (meshData.componentType == Constants::TYPE_UNSIGNED_SHORT) {
+      meshData.iscalars.resize(count);
 
-        meshData.fscalars.push_back(f);
-      }
+      readInts(meshData.iscalars.data(), ushort());
     }
-    else {
-      //std::cerr << " " << meshData.count;
-      //std::cerr << " " << meshData.componentType;
-      //std::cerr << "\n";
+    else if (meshData.componentType == Constants::TYPE_UNSIGNED_INT) {
+      meshData.iscalars.resize(count);
 
-      return errorMsg("Invalid " + meshData.type + " component type " +
-                      std::to_string(meshData.componentType));
+      readInts(meshData.iscalars.data(), uint());
+    }
+    else if (meshData.componentType == Constants::TYPE_FLOAT) {
+      meshData.fscalars.resize(count);
+
+      readFloats(meshData.fscalars.data());
+    }
+    else {
+      return invalidComponentType();
     }
   }
   // 2 components
   else if (meshData.type == "VEC2") {
-    int dim = 2;
-
     if (meshData.componentType == Constants::TYPE_FLOAT) {
-      if (byteStride <= 0)
-        byteStride = dim*4;
-
-      if (byteLength < meshData.count*byteStride)
-        return errorMsg("Invalid " + meshData.type + " count");
+      meshData.vec2.resize(count);
 
-      int id1 = 0;
-
-      for (long i = 0; i < meshData.count; ++i) {
-        Vec2 v;
-
-        v.x = readFloat(data, id1    );
-        v.y = readFloat(data, id1 + 4); id1 += byteStride;
-
-        meshData.vec2.push_back(v);
-      }
+      readFloats(meshData.vec2.data());
     }
     else
-      return errorMsg("Invalid " + meshData.type + " component type " +
-                      std::to_string(meshData.componentType));
+      return invalidComponentType();
   }
   // 3 components
   else if (meshData.type == "VEC3") {
-    int dim = 3;
-
     if (meshData.componentType == Constants::TYPE_FLOAT) {
-      if (byteStride <= 0)
-        byteStride = dim*4;
+      meshData.vec3.resize(count);
 
-      if (byteLength < meshData.count*byteStride)
-        return errorMsg("Invalid " + meshData.type + " count");
-
-      int id1 = 0;
-
-      for (long i = 0; i < meshData.count; ++i) {
-        Vec3 v;
-
-        v.x = readFloat(data, id1    );
-        v.y = readFloat(data, id1 + 4);
-        v.z = readFloat(data, id1 + 8); id1 += byteStride;
-
-        meshData.vec3.push_back(v);
-      }
+      readFloats(meshData.vec3.data());
     }
     else
-      return errorMsg("Invalid " + meshData.type + " component type " +
-                      std::to_string(meshData.componentType));
+      return invalidComponentType();
   }
   // 4 components
   else if (meshData.type == "VEC4") {
-    int dim = 4;
-
     if      (meshData.componentType == Constants::TYPE_UNSIGNED_BYTE) {
-      if (byteStride <= 0)
-        byteStride = dim*1;
+      meshData.vec4.resize(count);
 
-      if (byteLength < meshData.count*byteStride)
-        return errorMsg("Invalid " + meshData.type + " count");
-
-      int id1 = 0;
-
-      for (long i = 0; i < meshData.count; ++i) {
-        Vec4 v;
-
-        v.x = readByte(data, id1    );
-        v.y = readByte(data, id1 + 1);
-        v.z = readByte(data, id1 + 2);
-        v.w = readByte(data, id1 + 3); id1 += byteStride;
-
-        meshData.vec4.push_back(v);
-      }
+      readInts(reinterpret_cast<float *>(meshData.vec4.data()), uchar());
     }
     else if (meshData.componentType == Constants::TYPE_UNSIGNED_SHORT) {
-      if (byteStride <= 0)
-        byteStride = dim*2;
+      meshData.vec4.resize(count);
 
-      if (byteLength < meshData.count*byteStride)
-        return errorMsg("Invalid " + meshData.type + " count");
-
-      int id1 = 0;
-
-      for (long i = 0; i < meshData.count; ++i) {
-        Vec4 v;
-
-        v.x = readShort(data, id1    );
-        v.y = readShort(data, id1 + 2);
-        v.z = readShort(data, id1 + 4);
-        v.w = readShort(data, id1 + 6); id1 += byteStride;
-
-        meshData.vec4.push_back(v);
-      }
+      readInts(reinterpret_cast<float *>(meshData.vec4.data()), ushort());
     }
     else if (meshData.componentType == Constants::TYPE_FLOAT) {
-      if (byteStride <= 0)
-        byteStride = dim*4;
-
-      if (byteLength < meshData.count*byteStride)
-        return errorMsg("Invalid " + meshData.type + " count");
+      meshData.vec4.resize(count);
 
-      int id1 = 0;
-
-      for (long i = 0; i < meshData.count; ++i) {
-        Vec4 v;
-
-        v.x = readFloat(data, id1     );
-        v.y = readFloat(data, id1 +  4);
-        v.z = readFloat(data, id1 +  8);
-        v.w = readFloat(data, id1 + 12); id1 += byteStride;
-
-        meshData.vec4.push_back(v);
-      }
+      readFloats(meshData.vec4.data());
     }
     else
-      return errorMsg("Invalid " + meshData.type + " component type " +
-                      std::to_string(meshData.componentType));
+      return invalidComponentType();
   }
   // 4 componenents
   else if (meshData.type == "MAT2") {
@@ -736,37 +846,25 @@ readMeshData(const AccessorData &accessorData, MeshData &meshData) const
   }
   // 16 componenents
   else if (meshData.type == "MAT4") {
-    int dim = 16;
-
     if      (meshData.componentType == Constants::TYPE_FLOAT) {
-      if (byteStride <= 0)
-        byteStride = dim*4;
+      std::vector<float> values(count*16);
 
-      if (byteLength < meshData.count*byteStride)
-        return errorMsg("Invalid " + meshData.type + " count");
+      readFloats(values.data());
 
-      int id1 = 0;
+      meshData.mat4.resize(count);
 
-      for (long i = 0; i < meshData.count; ++i) {
-        Mat4 m;
+      for (long i = 0; i < count; ++i) {
+        auto &m = meshData.mat4[i];
 
-        for (int j = 0; j < dim; ++j)
-          m.v[j] = readFloat(data, id1 + j*4);
+        memcpy(m.v, &values[i*16], 16*sizeof(float));
 
         m.calcMatrix();
-
-        meshData.mat4.push_back(m);
-
-        id1 += byteStride;
       }
     }
     else
       TODO("Unhandled " + meshData.type + " meshData type");
   }
   else {
-    //std::cerr << "  byteOffset: " << bufferView.byteOffset << "\n";
-    //std::cerr << "  byteLength: " << byteLength << "\n";
-
     return errorMsg("Invalid type '" + meshData.type + "'");
   }
 
@@ -787,18 +885,22 @@ getAccessorBufferData(const IndName &accessorBufferView, long accessorByteOffset
                       long &byteLength, int &byteStride)
 {
   // get accessor buffer view
-  BufferView bufferView;
+  const BufferView *pbufferView = nullptr;
 
-  if (! getBufferView(accessorBufferView, bufferView)) {
+  if (! getBufferView(accessorBufferView, pbufferView)) {
     (void) errorMsg("Invalid accessor buffer view"); return nullptr;
   }
 
-  Buffer buffer;
+  const auto &bufferView = *pbufferView;
 
-  if (! getBuffer(bufferView.buffer, buffer)) {
+  const Buffer *pbuffer = nullptr;
+
+  if (! getBuffer(bufferView.buffer, pbuffer)) {
     (void) errorMsg("Invalid accessor buffer"); return nullptr;
   }
 
+  const auto &buffer = *pbuffer;
+
   long byteOffset1 = 0;
 
   if (bufferView.byteOffset > 0)
@@ -831,11 +933,11 @@ getAccessorBufferData(const IndName &accessorBufferView, long accessorByteOffset
       }
     }
 
-    if (byteOffset1 < 0 || byteOffset1 + byteLength > long(chunk->buffer.data.size())) {
+    if (byteOffset1 < 0 || byteOffset1 + byteLength > long(chunk->buffer.size())) {
       (void) errorMsg("Invalid buffer chunk data"); return nullptr;
     }
 
-    data = &chunk->buffer.data[byteOffset];
+    data = chunk->buffer.data() + byteOffset;
   }
   else {
     if (buffer.uri != "") {
@@ -899,17 +1001,33 @@ getAccessorBufferData(const IndName &accessorBufferView, long accessorByteOffset
             return nullptr;
           }
 
-          CFile file1(filename);
+          if (isMapFile()) {
+            // keep buffer file mapped (no copy)
+            auto uriMapFile = std::make_unique<CImportMapFile>();
+
+            if (! uriMapFile->open(filename)) {
+              (void) errorMsg("Failed to map buffer file '" + filename + "'");
+              return nullptr;
+            }
 
-          uchar *data1;
-          size_t len1;
+            uriDataMap_[buffer.uri] =
+              UriData(const_cast<uchar *>(uriMapFile->data()), uint(uriMapFile->size()));
 
-          if (! file1.readAll(&data1, &len1)) {
-            (void) errorMsg("Failed to read buffer file '" + filename + "'");
-            return nullptr;
+            uriMapFiles_.push_back(std::move(uriMapFile));
           }
+          else {
+            CFile file1(filename);
 
-          uriDataMap_[buffer.uri] = UriData(data1, uint(len1));
+            uchar *data1;
+            size_t len1;
+
+            if (! file1.readAll(&data1, &len1)) {
+              (void) errorMsg("Failed to read buffer file '" + filename + "'");
+              return nullptr;
+            }
+
+            uriDataMap_[buffer.uri] = UriData(data1, uint(len1));
+          }
         }
 
         pi = uriDataMap_.find(buffer.uri);
@@ -931,57 +1049,6 @@ getAccessorBufferData(const IndName &accessorBufferView, long accessorByteOffset
   return data;
 }
 
-float
-CImportGLTF::
-readFloat(const uchar *data, long i) const
-{
-  const auto *fdata = &data[i];
-
-  uint fi = ((fdata[0] & 0xFF)      ) |
-            ((fdata[1] & 0xFF) <<  8) |
-            ((fdata[2] & 0xFF) << 16) |
-            ((fdata[3] & 0xFF) << 24);
-
-  return *reinterpret_cast<float *>(&fi);
-}
-
-ushort
-CImportGLTF::
-readShort(const uchar *data, long i) const
-{
-   const auto *sdata = &data[i];
-
-   ushort s = ((sdata[0] & 0xFF)      ) |
-              ((sdata[1] & 0xFF) <<  8);
-
-   return s;
-}
-
-uint
-CImportGLTF::
-readInt(const uchar *data, long i) const
-{
-  const auto *idata = &data[i];
-
-  uint l = ((idata[0] & 0xFF)      ) |
-           ((idata[1] & 0xFF) <<  8) |
-           ((idata[2] & 0xFF) << 16) |
-           ((idata[3] & 0xFF) << 24);
-
-  return l;
-}
-
-uchar
-CImportGLTF::
-readByte(const uchar *data, long i) const
-{
-  const auto *bdata = &data[i];
-
-  uchar c = bdata[0];
-
-  return c;
-}
-
 bool
 CImportGLTF::
 getChunk(long ind, Chunk* &chunk) const
@@ -1165,7 +1232,7 @@ processAnim()
 
         const auto &sampler = (*ps).second;
 
-        Accessor iaccessor;
+        const Accessor *iaccessor = nullptr;
         if (! getAccessor(sampler.input, iaccessor)) {
           errorMsg("    Input Accessor: <invalid>"); continue;
         }
@@ -1175,7 +1242,7 @@ processAnim()
           errorMsg("Invalid Mesh Data for sampler.input"); continue;
         }
 
-        Accessor oaccessor;
+        const Accessor *oaccessor = nullptr;
         if (! getAccessor(sampler.output, oaccessor)) {
           errorMsg("    Output Accessor: <invalid>"); continue;
         }
@@ -1416,6 +1483,16 @@ bool
 CImportGLTF::
 processNodeMesh(Node *node)
 {
+  // EXT_mesh_gpu_instancing transforms (relative to node)
+  std::vector<CMatrix3D> instanceTransforms;
+
+  if (! getNodeInstanceTransforms(node, instanceTransforms))
+    return false;
+
+  // skinned meshes are deformed per node so always get their own object
+  if (isInstancing() && node->skin.isEmpty())
+    return createNodeInstances(node, instanceTransforms);
+
   auto parentHierTranslate = (node->parent ? node->parent->hierTranslate : CMatrix3D::identity());
 
   auto mt = node->transform*parentHierTranslate;
@@ -1423,6 +1500,9 @@ processNodeMesh(Node *node)
   if (! createNodeObject(node, mt))
     return false;
 
+  if (! instanceTransforms.empty())
+    expandNodeInstances(node, instanceTransforms);
+
   return true;
 }
 
@@ -1430,25 +1510,35 @@ bool
 CImportGLTF::
 createNodeObject(Node *node, const CMatrix3D & /*hierTranslate*/)
 {
+  // get mesh (unskinned mesh used by several nodes is built once and copied)
+  const Mesh    *mesh       = nullptr;
+  CGeomObject3D *meshObject = nullptr;
+
+  bool rc = getMesh(node->mesh, mesh);
+
+  if (rc && node->skin.isEmpty() && meshUseCount_[node->mesh] > 1) {
+    meshObject = getMeshObject(*mesh);
+
+    rc = (meshObject != nullptr);
+  }
+
   // create object
-  createNodeObj(node);
+  createNodeObj(node, meshObject);
 
   rootObject_->addChild(node->object);
 
+  if (! rc)
+    return false;
+
   //---
 
   // set mesh
-  Mesh mesh;
-
-  if (! getMesh(node->mesh, mesh))
-    return false;
-
-  if (! processMesh(node, mesh))
+  if (! meshObject && ! processMesh(node->object, node->skin, *mesh))
     return false;
 
 //node->object->transform(hierTranslate);
 
-  node->object->setMeshName(mesh.name);
+  node->object->setMeshName(mesh->name);
 
   //---
 
@@ -1521,101 +1611,280 @@ createNodeObject(Node *node, const CMatrix3D & /*hierTranslate*/)
       node1->added = true;
     }
   }
-  else {
-    for (auto &pn : jsonData_.nodes) {
-      auto &node1 = pn.second;
-      if (node1.added) continue;
+  else
+    initNodesData();
 
-      CGeomNodeData nodeData;
-      initNodeData(&node1, nodeData);
+  return true;
+}
 
-      node1.added = true;
+void
+CImportGLTF::
+initNodeData(Node *node, CGeomNodeData &nodeData) const
+{
+  auto ind = int(node->indName.ind);
+
+  if (! rootObject_->hasNode(ind))
+    rootObject_->addNode(ind, nodeData);
+
+  auto &nodeData1 = rootObject_->editNode(ind);
+
+  nodeData1.setParent(node->parent ? int(node->parent->indName.ind) : -1);
+
+  nodeData1.setJoint(node->isJoint);
+
+  if (node->inverseBindMatrix)
+    nodeData1.setInverseBindMatrix(node->inverseBindMatrix->matrix().toCMatrix());
+
+  nodeData1.resizeChildren(uint(node->children.size()));
+
+  nodeData1.setName(node->name);
+
+  for (size_t ic = 0; ic < node->children.size(); ++ic)
+    nodeData1.setChild(uint(ic), int(node->children[ic].ind));
+
+  if (node->object)
+    nodeData1.setObject(node->object);
+}
+
+// add node data for nodes not yet added
+void
+CImportGLTF::
+initNodesData()
+{
+  for (auto &pn : jsonData_.nodes) {
+    auto &node = pn.second;
+    if (node.added) continue;
+
+    CGeomNodeData nodeData;
+    initNodeData(&node, nodeData);
+
+    node.added = true;
+  }
+}
+
+// create node object (empty or copy of shared mesh object)
+void
+CImportGLTF::
+createNodeObj(Node *node, CGeomObject3D *meshObject)
+{
+  assert(! node->object);
+
+  auto name = node->name;
+
+  if (name == "")
+    name = "node" + node->indName.to_string();
+
+  if (meshObject) {
+    node->object = CGeometry3DInst->dupObject(meshObject);
+
+    node->object->setScene(scene_);
+    node->object->setName (node->name);
+  }
+  else
+    node->object = CGeometry3DInst->createObject3D(scene_, node->name);
+
+  scene_->addObject(node->object);
+
+  if (! node->added) {
+    CGeomNodeData nodeData;
+    initNodeData(node, nodeData);
+
+    node->added = true;
+  }
+
+  auto ind = int(node->indName.ind);
+
+  node->object->setMeshNode(ind);
+}
+
+CMatrix3D
+CImportGLTF::
+calcNodeTransform(Node *node) const
+{
+  if (node->matrix)
+    return node->matrix->toCMatrix();
+
+  node->mtranslate = CTranslate3D();
+  node->mrotate    = CRotate3D();
+  node->mscale     = CScale3D();
+
+  if (node->translation)
+    node->mtranslate = CTranslate3D(node->translation->x,
+                                    node->translation->y,
+                                    node->translation->z);
+
+  if (node->rotation)
+    node->mrotate = CRotate3D(node->rotation->w, node->rotation->x,
+                              node->rotation->y, node->rotation->z);
+
+  if (node->scale)
+    node->mscale = CScale3D(node->scale->x, node->scale->y, node->scale->z);
+
+  return node->mtranslate.matrix()*node->mrotate.matrix()*node->mscale.matrix();
+}
+
+// get EXT_mesh_gpu_instancing instance transforms of node (empty if none)
+bool
+CImportGLTF::
+getNodeInstanceTransforms(const Node *node, std::vector<CMatrix3D> &transforms) const
+{
+  if (node->instanceTranslation.isEmpty() &&
+      node->instanceRotation   .isEmpty() &&
+      node->instanceScale      .isEmpty())
+    return true;
+
+  auto lookup = [&](const IndName &indName, const std::string &name) {
+    if (indName.isEmpty())
+      return static_cast<const MeshData *>(nullptr);
+
+    auto *meshData = getMeshData(indName);
+
+    if (! meshData)
+      warnMsg("Invalid EXT_mesh_gpu_instancing " + name);
+
+    return meshData;
+  };
+
+  const auto *translations = lookup(node->instanceTranslation, "TRANSLATION");
+  const auto *rotations    = lookup(node->instanceRotation   , "ROTATION");
+  const auto *scales       = lookup(node->instanceScale      , "SCALE");
+
+  // all attributes have the same count
+  size_t n = 0;
+
+  if (translations) n = std::max(n, translations->vec3.size());
+  if (rotations   ) n = std::max(n, rotations   ->vec4.size());
+  if (scales      ) n = std::max(n, scales      ->vec3.size());
+
+  transforms.resize(n);
+
+  for (size_t i = 0; i < n; ++i) {
+    CTranslate3D translate;
+    CRotate3D    rotate;
+    CScale3D     scale;
+
+    if (translations && i < translations->vec3.size()) {
+      const auto &t = translations->vec3[i];
+
+      translate = CTranslate3D(t.x, t.y, t.z);
+    }
+
+    // quaternion (x, y, z, w)
+    if (rotations && i < rotations->vec4.size()) {
+      const auto &r = rotations->vec4[i];
+
+      rotate = CRotate3D(r.w, r.x, r.y, r.z);
+    }
+
+    if (scales && i < scales->vec3.size()) {
+      const auto &s = scales->vec3[i];
+
+      scale = CScale3D(s.x, s.y, s.z);
     }
+
+    transforms[i] = translate.matrix()*rotate.matrix()*scale.matrix();
   }
 
   return true;
 }
 
-void
+// add instances of shared node mesh (one per EXT_mesh_gpu_instancing transform)
+bool
 CImportGLTF::
-initNodeData(Node *node, CGeomNodeData &nodeData) const
+createNodeInstances(Node *node, const std::vector<CMatrix3D> &transforms)
 {
-  auto ind = int(node->indName.ind);
+  const Mesh *mesh = nullptr;
+
+  if (! getMesh(node->mesh, mesh))
+    return false;
 
-  if (! rootObject_->hasNode(ind))
-    rootObject_->addNode(ind, nodeData);
+  auto *meshObject = getMeshObject(*mesh);
 
-  auto &nodeData1 = rootObject_->editNode(ind);
+  if (! meshObject)
+    return false;
 
-  nodeData1.setParent(node->parent ? int(node->parent->indName.ind) : -1);
+  auto name = node->name;
 
-  nodeData1.setJoint(node->isJoint);
+  if (name == "")
+    name = "node" + node->indName.to_string();
 
-  if (node->inverseBindMatrix)
-    nodeData1.setInverseBindMatrix(node->inverseBindMatrix->matrix().toCMatrix());
+  auto addInstance = [&](const std::string &name1, const CMatrix3D &transform) {
+    Instance instance;
 
-  nodeData1.resizeChildren(uint(node->children.size()));
+    instance.name      = name1;
+    instance.mesh      = meshObject;
+    instance.node      = int(node->indName.ind);
+    instance.transform = transform;
 
-  nodeData1.setName(node->name);
+    instances_.push_back(std::move(instance));
+  };
 
-  for (size_t ic = 0; ic < node->children.size(); ++ic)
-    nodeData1.setChild(uint(ic), int(node->children[ic].ind));
+  if (transforms.empty())
+    addInstance(name, node->hierTransform);
+  else {
+    for (size_t i = 0; i < transforms.size(); ++i)
+      addInstance(name + "_" + std::to_string(i), node->hierTransform*transforms[i]);
+  }
 
-  if (node->object)
-    nodeData1.setObject(node->object);
+  return true;
 }
 
+// add EXT_mesh_gpu_instancing instances as transformed copies of node object
+// (when not instancing)
 void
 CImportGLTF::
-createNodeObj(Node *node)
+expandNodeInstances(Node *node, const std::vector<CMatrix3D> &transforms)
 {
-  assert(! node->object);
-
-  auto name = node->name;
+  auto *object = node->object;
 
-  if (name == "")
-    name = "node" + node->indName.to_string();
+  for (size_t i = 1; i < transforms.size(); ++i) {
+    auto *object1 = CGeometry3DInst->dupObject(object);
 
-  node->object = CGeometry3DInst->createObject3D(scene_, node->name);
+    object1->setScene(scene_);
+    object1->setName(object->getName() + "_" + std::to_string(i));
 
-  scene_->addObject(node->object);
+    object1->transform(transforms[i]);
 
-  if (! node->added) {
-    CGeomNodeData nodeData;
-    initNodeData(node, nodeData);
+    scene_->addObject(object1);
 
-    node->added = true;
+    rootObject_->addChild(object1);
   }
 
-  auto ind = int(node->indName.ind);
-
-  node->object->setMeshNode(ind);
+  object->transform(transforms[0]);
 }
 
-CMatrix3D
+// get object for mesh (built on first use and shared by all its instances)
+CGeomObject3D *
 CImportGLTF::
-calcNodeTransform(Node *node) const
+getMeshObject(const Mesh &mesh)
 {
-  if (node->matrix)
-    return node->matrix->toCMatrix();
+  auto pm = meshObjects_.find(&mesh);
 
-  node->mtranslate = CTranslate3D();
-  node->mrotate    = CRotate3D();
-  node->mscale     = CScale3D();
+  if (pm != meshObjects_.end())
+    return (*pm).second;
 
-  if (node->translation)
-    node->mtranslate = CTranslate3D(node->translation->x,
-                                    node->translation->y,
-                                    node->translation->z);
+  auto name = mesh.name;
 
-  if (node->rotation)
-    node->mrotate = CRotate3D(node->rotation->w, node->rotation->x,
-                              node->rotation->y, node->rotation->z);
+  if (name == "")
+    name = "mesh" + mesh.indName.to_string();
 
-  if (node->scale)
-    node->mscale = CScale3D(node->scale->x, node->scale->y, node->scale->z);
+  auto *object = CGeometry3DInst->createObject3D(scene_, name);
 
-  return node->mtranslate.matrix()*node->mrotate.matrix()*node->mscale.matrix();
+  if (processMesh(object, IndName(), mesh)) {
+    object->setMeshName(mesh.name);
+
+    // owned by scene but not drawn as an object
+    scene_->addPrimitive(object);
+  }
+  else {
+    delete object;
+
+    object = nullptr;
+  }
+
+  meshObjects_[&mesh] = object;
+
+  return object;
 }
 
 #if 0
@@ -1639,14 +1908,12 @@ calcNodeGlobalTransform(Node *node) const
 
 bool
 CImportGLTF::
-processMesh(Node *node, const Mesh &mesh)
+processMesh(CGeomObject3D *object, const IndName &skinName, const Mesh &mesh)
 {
-  auto *object = node->object;
-
   Skin skin;
 
-  if (! node->skin.isEmpty())
-    (void) getSkin(node->skin, skin);
+  if (! skinName.isEmpty())
+    (void) getSkin(skinName, skin);
 
   uint ip = 0;
 
@@ -1655,140 +1922,38 @@ processMesh(Node *node, const Mesh &mesh)
 
     //---
 
-    std::vector<long> indices;
-    std::vector<Vec3> positions;
-    std::vector<Vec3> normals;
-    std::vector<Vec2> texCoords0;
-    std::vector<Vec4> joints0;
-    std::vector<Vec4> weights0;
+    // use geometry prepared by processData (or prepare now)
+    PrimitiveGeom geom1;
 
-    if (! primitive.indices.isEmpty()) {
-      auto *indMeshData = getMeshData(primitive.indices);
-      if (! indMeshData)
-        return errorMsg("Invalid indices mesh");
+    const auto *geom = getPrimitiveGeom(primitive);
 
-      if (isDump()) {
-        debugMsg(" INDICES");
-        printMeshData(*indMeshData);
-      }
-
-      indices = indMeshData->iscalars;
-    }
-
-    if (! primitive.position.isEmpty()) {
-      auto *positionMeshData = getMeshData(primitive.position);
-      if (! positionMeshData)
-        return errorMsg("Invalid mesh POSITION");
-
-      if (isDump()) {
-        debugMsg(" POSITION");
-        printMeshData(*positionMeshData);
-      }
-
-      positions = positionMeshData->vec3;
-    }
-
-    if (! primitive.normal.isEmpty()) {
-      auto *normalMeshData = getMeshData(primitive.normal);
-      if (! normalMeshData)
-        return errorMsg("Invalid mesh NORMAL");
-
-      if (isDump()) {
-        debugMsg(" NORMAL");
-        printMeshData(*normalMeshData);
-      }
-
-      normals = normalMeshData->vec3;
-    }
-
-    if (! primitive.texCoord0.isEmpty()) {
-      auto *texCoord0MeshData = getMeshData(primitive.texCoord0);
-      if (! texCoord0MeshData)
-        return errorMsg("Invalid mesh TEXCOORD_0");
-
-      if (isDump()) {
-        debugMsg(" TEXCOORD_0");
-        printMeshData(*texCoord0MeshData);
-      }
+    if (! geom) {
+      preparePrimitive(primitive, geom1);
 
-      texCoords0 = texCoord0MeshData->vec2;
+      geom = &geom1;
     }
 
-    if (! primitive.joints0.isEmpty()) {
-      auto *joints0MeshData = getMeshData(primitive.joints0);
-      if (! joints0MeshData)
-        return errorMsg("Invalid mesh JOINTS_0");
-
-      if (isDump()) {
-        debugMsg(" JOINTS_0");
-        printMeshData(*joints0MeshData);
-      }
-
-      joints0 = joints0MeshData->vec4;
-    }
-
-    if (! primitive.weights0.isEmpty()) {
-      auto *weights0MeshData = getMeshData(primitive.weights0);
-      if (! weights0MeshData)
-        return errorMsg("Invalid mesh WEIGHTS_0");
-
-      if (isDump()) {
-        debugMsg(" WEIGHTS_0");
-        printMeshData(*weights0MeshData);
-      }
-
-      weights0 = weights0MeshData->vec4;
-    }
-
-    auto ni = indices   .size();
-    auto np = positions .size();
-    auto nn = normals   .size();
-    auto nt = texCoords0.size();
-    auto nj = joints0   .size();
-    auto nw = weights0  .size();
-
-    CIMinMax indMinMax;
-    for (int i = 0; i < int(ni); ++i)
-      indMinMax.add(int(indices[i]));
-
-    auto setDefaultIndices = [&]() {
-      indices.resize(np);
-
-      for (int i = 0; i < int(np); ++i)
-        indices[i] = short(i);
-
-      indMinMax.reset();
-
-      indMinMax.add(0);
-      indMinMax.add(int(np - 1));
-
-      ni = np;
-    };
-
-    if (ni == 0)
-      setDefaultIndices();
-
-    if (np == 0)
-      return errorMsg("No mesh positions");
-
-    if (ni > 0 && indMinMax.max() >= int(np))
-      warnMsg("Invalid mesh indices size");
+    if (isDump())
+      dumpPrimitive(primitive);
 
-    if (nn > 0 && np != nn)
-      warnMsg("Invalid mesh normals size");
+    if (geom->error != "")
+      return errorMsg(geom->error);
 
-    if (nt > 0 && np != nt)
-      warnMsg("Invalid mesh texCoords0 size");
+    for (const auto &warning : geom->warnings)
+      warnMsg(warning);
 
-    if (nj > 0 && np != nj)
-      warnMsg("Invalid mesh joints0 size");
-
-    if (nw > 0 && np != nw)
-      warnMsg("Invalid mesh weights0 size");
+    // arrays reference decoded mesh data (no copy)
+    const auto *positions  = geom->positions ; auto np = geom->np;
+    const auto *normals    = geom->normals   ; auto nn = geom->nn;
+    const auto *texCoords0 = geom->texCoords0; auto nt = geom->nt;
+    const auto *joints0    = geom->joints0   ; auto nj = geom->nj;
+    const auto *weights0   = geom->weights0  ; auto nw = geom->nw;
 
     //---
 
-    for (const auto &p : positions) {
+    for (size_t i = 0; i < np; ++i) {
+      const auto &p = positions[i];
+
       auto ind = object->addVertex(CPoint3D(p.x, p.y, p.z));
       assert(ind == ip); ++ip;
 
@@ -1908,19 +2073,16 @@ processMesh(Node *node, const Mesh &mesh)
       }
     }
 
-    uint numTriangles = uint(ni/3);
+    const auto &triangles = geom->triangles;
 
-    for (uint i = 0; i < numTriangles; ++i) {
-      auto i1 = indices[i*3 + 0];
-      auto i2 = indices[i*3 + 1];
-      auto i3 = indices[i*3 + 2];
+    auto numTriangles = triangles.size()/3;
 
-      if (i1 < 0 || i1 >= int(np) ||
-          i2 < 0 || i2 >= int(np) ||
-          i3 < 0 || i3 >= int(np))
-        continue;
+    for (size_t i = 0; i < numTriangles; ++i) {
+      auto i1 = triangles[i*3 + 0];
+      auto i2 = triangles[i*3 + 1];
+      auto i3 = triangles[i*3 + 2];
 
-      object->addITriangle(uint(i1 + ipStart), uint(i2 + ipStart), uint(i3 + ipStart));
+      object->addITriangle(i1 + ipStart, i2 + ipStart, i3 + ipStart);
 
 #if 0
       if (isDebug())
@@ -2098,55 +2260,195 @@ processMesh(Node *node, const Mesh &mesh)
   return true;
 }
 
-bool
+// resolve primitive arrays and valid triangles (no object/scene access so can run in parallel)
+void
 CImportGLTF::
-resolveImage(const Image &image)
+preparePrimitive(const Primitive &primitive, PrimitiveGeom &geom) const
 {
-  if (image.image)
-    return true;
+  auto lookup = [&](const IndName &indName, const std::string &errMsg) {
+    if (indName.isEmpty())
+      return static_cast<const MeshData *>(nullptr);
 
-  const uchar* data;
-  long         len;
+    auto *meshData = getMeshData(indName);
 
-  if (! getImageData(image, data, len))
-    return false;
+    if (! meshData && geom.error == "")
+      geom.error = errMsg;
 
-  std::string prefix;
+    return meshData;
+  };
+
+  const auto *indMeshData       = lookup(primitive.indices  , "Invalid indices mesh");
+  const auto *positionMeshData  = lookup(primitive.position , "Invalid mesh POSITION");
+  const auto *normalMeshData    = lookup(primitive.normal   , "Invalid mesh NORMAL");
+  const auto *texCoord0MeshData = lookup(primitive.texCoord0, "Invalid mesh TEXCOORD_0");
+  const auto *joints0MeshData   = lookup(primitive.joints0  , "Invalid mesh JOINTS_0");
+  const auto *weights0MeshData  = lookup(primitive.weights0 , "Invalid mesh WEIGHTS_0");
 
-  if      (image.mimeType == "image/png") {
-    auto image1 = CImageMgrInst->createImage();
+  if (geom.error != "")
+    return;
+
+  if (positionMeshData) {
+    geom.positions = positionMeshData->vec3.data(); geom.np = positionMeshData->vec3.size();
+  }
 
-    if (! image1->read(data, len, CFILE_TYPE_IMAGE_PNG))
-      return errorMsg("Invalid image data");
+  if (normalMeshData) {
+    geom.normals = normalMeshData->vec3.data(); geom.nn = normalMeshData->vec3.size();
+  }
 
-    image.image = image1;
+  if (texCoord0MeshData) {
+    geom.texCoords0 = texCoord0MeshData->vec2.data(); geom.nt = texCoord0MeshData->vec2.size();
+  }
 
-    prefix = "png";
+  if (joints0MeshData) {
+    geom.joints0 = joints0MeshData->vec4.data(); geom.nj = joints0MeshData->vec4.size();
   }
-  else if (image.mimeType == "image/jpeg") {
-    auto image1 = CImageMgrInst->createImage();
 
-    if (! image1->read(data, len, CFILE_TYPE_IMAGE_JPG))
-      return errorMsg("Invalid image data");
+  if (weights0MeshData) {
+    geom.weights0 = weights0MeshData->vec4.data(); geom.nw = weights0MeshData->vec4.size();
+  }
 
-    image.image = image1;
+  auto np = geom.np;
 
-    prefix = "jpg";
+  if (np == 0) {
+    geom.error = "No mesh positions";
+    return;
   }
-  else if (image.mimeType == "image/webp") {
-    auto image1 = CImageMgrInst->createImage();
 
-    if (! image1->read(data, len, CFILE_TYPE_IMAGE_WEBP))
-      return errorMsg("Invalid image data");
+  //---
 
-    image.image = image1;
+  // add triangles with valid indices (default indices are vertex order)
+  const long *indices = nullptr;
+  size_t      ni      = 0;
 
-    prefix = "webp";
+  if (indMeshData) {
+    indices = indMeshData->iscalars.data(); ni = indMeshData->iscalars.size();
   }
-  else
-    return errorMsg("Invalid image type '" + image.mimeType + "'");
 
-  if (isSaveImage()) {
+  auto numTriangles = (ni > 0 ? ni : np)/3;
+
+  geom.triangles.reserve(numTriangles*3);
+
+  if (ni > 0) {
+    bool invalid = false;
+
+    for (size_t i = 0; i < numTriangles; ++i) {
+      auto i1 = indices[i*3 + 0];
+      auto i2 = indices[i*3 + 1];
+      auto i3 = indices[i*3 + 2];
+
+      if (i1 < 0 || i1 >= long(np) ||
+          i2 < 0 || i2 >= long(np) ||
+          i3 < 0 || i3 >= long(np)) {
+        invalid = true;
+        continue;
+      }
+
+      geom.triangles.push_back(uint(i1));
+      geom.triangles.push_back(uint(i2));
+      geom.triangles.push_back(uint(i3));
+    }
+
+    for (size_t i = numTriangles*3; i < ni; ++i) {
+      if (indices[i] >= long(np))
+        invalid = true;
+    }
+
+    if (invalid)
+      geom.warnings.push_back("Invalid mesh indices size");
+  }
+  else {
+    for (size_t i = 0; i < numTriangles*3; ++i)
+      geom.triangles.push_back(uint(i));
+  }
+
+  //---
+
+  if (geom.nn > 0 && np != geom.nn)
+    geom.warnings.push_back("Invalid mesh normals size");
+
+  if (geom.nt > 0 && np != geom.nt)
+    geom.warnings.push_back("Invalid mesh texCoords0 size");
+
+  if (geom.nj > 0 && np != geom.nj)
+    geom.warnings.push_back("Invalid mesh joints0 size");
+
+  if (geom.nw > 0 && np != geom.nw)
+    geom.warnings.push_back("Invalid mesh weights0 size");
+}
+
+const CImportGLTF::PrimitiveGeom *
+CImportGLTF::
+getPrimitiveGeom(const Primitive &primitive) const
+{
+  auto pg = primitiveGeoms_.find(&primitive);
+  if (pg == primitiveGeoms_.end()) return nullptr;
+
+  return &(*pg).second;
+}
+
+void
+CImportGLTF::
+dumpPrimitive(const Primitive &primitive) const
+{
+  auto dumpMeshData = [&](const IndName &indName, const std::string &name) {
+    if (indName.isEmpty())
+      return;
+
+    auto *meshData = getMeshData(indName);
+    if (! meshData) return;
+
+    debugMsg(" " + name);
+    printMeshData(*meshData);
+  };
+
+  dumpMeshData(primitive.indices  , "INDICES");
+  dumpMeshData(primitive.position , "POSITION");
+  dumpMeshData(primitive.normal   , "NORMAL");
+  dumpMeshData(primitive.texCoord0, "TEXCOORD_0");
+  dumpMeshData(primitive.joints0  , "JOINTS_0");
+  dumpMeshData(primitive.weights0 , "WEIGHTS_0");
+}
+
+bool
+CImportGLTF::
+resolveImage(const Image &image)
+{
+  if (image.image)
+    return true;
+
+  if (image.imageId < 0) {
+    if (! recordImage(image))
+      return false;
+
+    if (image.imageId < 0)
+      return errorMsg("Invalid image type '" + image.mimeType + "'");
+  }
+
+  // decode on first use (may already be decoded by background worker)
+  auto id = CImportImageCache::Id(image.imageId);
+
+  image.image = imageCache_.image(id);
+
+  if (! image.image) {
+    if (image.uri != "" && image.bufferView.isEmpty())
+      return errorMsg("Failed to read image file '" + imageCache_.filename(id) + "'");
+
+    return errorMsg("Invalid image data");
+  }
+
+  if (isSaveImage() && ! image.bufferView.isEmpty()) {
+    std::string prefix;
+
+    if      (image.mimeType == "image/png" ) prefix = "png";
+    else if (image.mimeType == "image/jpeg") prefix = "jpg";
+    else if (image.mimeType == "image/webp") prefix = "webp";
+
+    const uchar* data;
+    long         len;
+
+    if (! getImageData(image, data, len))
+      return false;
+
     auto name = "image." + image.indName.to_string() + "." + prefix;
 
     if (! writeFile(name, data, len))
@@ -2156,124 +2458,192 @@ resolveImage(const Image &image)
   return true;
 }
 
+// record image source for deferred decode (decoded on first use by resolveImage)
 bool
 CImportGLTF::
-getImageData(const Image &image, const uchar* &data, long &len)
+recordImage(const Image &image)
 {
+  if (image.imageId >= 0)
+    return true;
+
   if      (! image.bufferView.isEmpty()) {
-    BufferView bufferView;
+    const uchar* data;
+    long         len;
+
+    if (! getImageData(image, data, len))
+      return false;
 
-    if (! getBufferView(image.bufferView, bufferView))
-      return errorMsg("Invalid image buffer view");
+    CFileType type;
 
-    Chunk *chunk = nullptr;
+    if      (image.mimeType == "image/png" ) type = CFILE_TYPE_IMAGE_PNG;
+    else if (image.mimeType == "image/jpeg") type = CFILE_TYPE_IMAGE_JPG;
+    else if (image.mimeType == "image/webp") type = CFILE_TYPE_IMAGE_WEBP;
+    else return true; // reported on use
 
-    if      (bufferView.buffer.ind >= 0) {
-      if (bufferView.buffer.ind >= long(jsonData_.chunks.size()))
-        return errorMsg("Invalid buffer chunk");
+    image.imageId = long(imageCache_.addData(data, len, type));
+  }
+  else if (image.uri != "") {
+    std::string filename;
 
-      chunk = &jsonData_.chunks[bufferView.buffer.ind];
-    }
-    else if (bufferView.buffer.name != "") {
-      auto pb = jsonData_.buffers.find(bufferView.buffer);
+    if (! getImageFile(image, filename))
+      return false;
 
-      if (pb == jsonData_.buffers.end())
-        return errorMsg("Invalid buffer chunk");
+    image.imageId = long(imageCache_.addFile(filename));
+  }
+  else {
+    return errorMsg("Invalid image data");
+  }
 
-      //auto *buffer = &(*pb).second;
+  return true;
+}
 
-      if (version_ == 1)
-        chunk = &jsonData_.chunks[0];
-      else
-        return errorMsg("Invalid buffer chunk");
-    }
-    else {
+// queue background decode of images of material textures
+void
+CImportGLTF::
+prefetchMaterialImages(const IndName &materialName)
+{
+  Material *material = nullptr;
+
+  if (materialName.isEmpty() || ! getMaterial(materialName, material))
+    return;
+
+  auto prefetchTexture = [&](long ind) {
+    Texture *texture = nullptr;
+
+    if (ind < 0 || ! getTexture(IndName(ind), texture) || texture->source.isEmpty())
+      return;
+
+    auto pi = jsonData_.images.find(texture->source);
+
+    if (pi == jsonData_.images.end() || (*pi).second.imageId < 0)
+      return;
+
+    imageCache_.prefetch(CImportImageCache::Id((*pi).second.imageId));
+  };
+
+  prefetchTexture(material->baseColorTexture.index);
+  prefetchTexture(material->normalTexture   .index);
+  prefetchTexture(material->specularTexture .index);
+  prefetchTexture(material->emissiveTexture .index);
+}
+
+bool
+CImportGLTF::
+getImageData(const Image &image, const uchar* &data, long &len)
+{
+  if (image.bufferView.isEmpty())
+    return errorMsg("Invalid image data");
+
+  const BufferView *pbufferView = nullptr;
+
+  if (! getBufferView(image.bufferView, pbufferView))
+    return errorMsg("Invalid image buffer view");
+
+  const auto &bufferView = *pbufferView;
+
+  Chunk *chunk = nullptr;
+
+  if      (bufferView.buffer.ind >= 0) {
+    if (bufferView.buffer.ind >= long(jsonData_.chunks.size()))
       return errorMsg("Invalid buffer chunk");
-    }
 
-    auto byteOffset = bufferView.byteOffset;
+    chunk = &jsonData_.chunks[bufferView.buffer.ind];
+  }
+  else if (bufferView.buffer.name != "") {
+    auto pb = jsonData_.buffers.find(bufferView.buffer);
 
-    if (byteOffset < 0)
-      byteOffset = 0;
+    if (pb == jsonData_.buffers.end())
+      return errorMsg("Invalid buffer chunk");
 
-    if (byteOffset < 0 || byteOffset + bufferView.byteLength >= long(chunk->buffer.data.size()))
-      return errorMsg("Invalid buffer chunk data");
+    //auto *buffer = &(*pb).second;
 
-    data = &chunk->buffer.data[byteOffset];
-    len  = bufferView.byteLength;
+    if (version_ == 1)
+      chunk = &jsonData_.chunks[0];
+    else
+      return errorMsg("Invalid buffer chunk");
+  }
+  else {
+    return errorMsg("Invalid buffer chunk");
   }
-  else if (image.uri != "") {
-    if (! image.image) {
-      auto remapTextureFile = [&](const std::string &fname) {
-        if (CFile::exists(fname))
-          return fname;
 
-        auto fname1 = remapFile(fname);
+  auto byteOffset = bufferView.byteOffset;
 
-        if (CFile::exists(fname1))
-          return fname1;
+  if (byteOffset < 0)
+    byteOffset = 0;
 
-        if (textureDir() != "") {
-          auto fname2 = fname;
+  if (byteOffset < 0 || byteOffset + bufferView.byteLength > long(chunk->buffer.size()))
+    return errorMsg("Invalid buffer chunk data");
 
-          auto p = fname2.rfind('/');
+  data = chunk->buffer.data() + byteOffset;
+  len  = bufferView.byteLength;
+
+  return true;
+}
 
-          if (p == std::string::npos)
-            p = fname2.rfind('\\'); // DOS format
+bool
+CImportGLTF::
+getImageFile(const Image &image, std::string &filename) const
+{
+  auto remapTextureFile = [&](const std::string &fname) {
+    if (CFile::exists(fname))
+      return fname;
 
-          if (p != std::string::npos)
-            fname2 = fname2.substr(p + 1);
+    auto fname1 = remapFile(fname);
 
-          if (CFile::exists(fname2))
-            return fname2;
+    if (CFile::exists(fname1))
+      return fname1;
 
-          auto fname3 = textureDir() + "/" + fname2;
+    if (textureDir() != "") {
+      auto fname2 = fname;
 
-          if (CFile::exists(fname3))
-            return fname3;
-        }
+      auto p = fname2.rfind('/');
 
-        return std::string();
-      };
+      if (p == std::string::npos)
+        p = fname2.rfind('\\'); // DOS format
 
-      image.image = CImageMgrInst->createImage();
+      if (p != std::string::npos)
+        fname2 = fname2.substr(p + 1);
 
-      auto filename = remapTextureFile(image.uri);
+      if (CFile::exists(fname2))
+        return fname2;
 
-      if (filename == "")
-        return errorMsg("Invalid image file '" + image.uri + "'");
+      auto fname3 = textureDir() + "/" + fname2;
 
-      if (! image.image->read(filename))
-        return errorMsg("Failed to read image file '" + filename + "'");
+      if (CFile::exists(fname3))
+        return fname3;
     }
-  }
-  else {
-    return errorMsg("Invalid image data");
-  }
+
+    return std::string();
+  };
+
+  filename = remapTextureFile(image.uri);
+
+  if (filename == "")
+    return errorMsg("Invalid image file '" + image.uri + "'");
 
   return true;
 }
 
 bool
 CImportGLTF::
-getBufferView(const IndName &indName, BufferView &bufferView) const
+getBufferView(const IndName &indName, const BufferView* &bufferView) const
 {
   auto pn = jsonData_.bufferViews.find(indName);
   if (pn == jsonData_.bufferViews.end()) return false;
 
-  bufferView = (*pn).second;
+  bufferView = &(*pn).second;
 
   return true;
 }
 
 bool
 CImportGLTF::
-getBuffer(const IndName &indName, Buffer &buffer) const
+getBuffer(const IndName &indName, const Buffer* &buffer) const
 {
   auto pn = jsonData_.buffers.find(indName);
   if (pn == jsonData_.buffers.end()) return false;
 
-  buffer = (*pn).second;
+  buffer = &(*pn).second;
 
   return true;
 }
@@ -2364,24 +2734,24 @@ getOrderedNode(int order, Node* &node) const
 
 bool
 CImportGLTF::
-getAccessor(const IndName &indName, Accessor &accessor) const
+getAccessor(const IndName &indName, const Accessor* &accessor) const
 {
   auto pn = jsonData_.accessors.find(indName);
   if (pn == jsonData_.accessors.end()) return false;
 
-  accessor = (*pn).second;
+  accessor = &(*pn).second;
 
   return true;
 }
 
 bool
 CImportGLTF::
-getMesh(const IndName &indName, Mesh &mesh) const
+getMesh(const IndName &indName, const Mesh* &mesh) const
 {
   auto pm = jsonData_.meshes.find(indName);
   if (pm == jsonData_.meshes.end()) return false;
 
-  mesh = (*pm).second;
+  mesh = &(*pm).second;
 
   return true;
 }
@@ -2416,7 +2786,7 @@ writeFile(const std::string &filename, const uchar *data, long len) const
 
 bool
 CImportGLTF::
-parseJson(const std::string &jsonStr, JsonData &jsonData) const
+parseJson(std::string_view jsonStr, JsonData &jsonData) const
 {
   auto valueNumber = [](const CJson::ValueP &value, double &number) {
     if (! value->isNumber())
@@ -2551,13 +2921,13 @@ parseJson(const std::string &jsonStr, JsonData &jsonData) const
   //---
 
   if (isDebug())
-    debugMsg(jsonStr);
+    debugMsg(std::string(jsonStr));
 
   CJson json;
 
   CJson::ValueP value;
 
-  if (! json.loadString(jsonStr, value))
+  if (! json.loadString(std::string(jsonStr), value))
     return errorMsg("Invalid JSON");
 
   //value->print(); std::cout << "\n";
@@ -3236,18 +3606,24 @@ parseJson(const std::string &jsonStr, JsonData &jsonData) const
                     if (! valueLong(pnv5.second, ind))
                       return errorMsg("Invalid " + id + "/" + pnv2.first + "/" + pnv3.first +
                                       "/" + pnv4.first + "/" + pnv5.first + " value");
+
+                    node.instanceTranslation = IndName(ind);
                   }
                   else if (pnv5.first == "ROTATION") {
                     long ind;
                     if (! valueLong(pnv5.second, ind))
                       return errorMsg("Invalid " + id + "/" + pnv2.first + "/" + pnv3.first +
                                       "/" + pnv4.first + "/" + pnv5.first + " value");
+
+                    node.instanceRotation = IndName(ind);
                   }
                   else if (pnv5.first == "SCALE") {
                     long ind;
                     if (! valueLong(pnv5.second, ind))
                       return errorMsg("Invalid " + id + "/" + pnv2.first + "/" + pnv3.first +
                                       "/" + pnv4.first + "/" + pnv5.first + " value");
+
+                    node.instanceScale = IndName(ind);
                   }
                   else
                     debugValueMsg("Invalid name " + id + "/" + pnv2.first + "/" + pnv3.first +
@@ -4,7 +4,7 @@
 namespace {
 
 auto exitMsg(const std::string &msg) -> int {
-  std::cerr << "^[[33mError^[[0m: " << msg << "\n";
+  std::cerr << "\033[33mError\033[0m: " << msg << "\n";
   return 1;
 }
 
@@ -0,0 +1,346 @@
+#include <CImportImageCache.h>
+#include <CImageMgr.h>
+#include <CImage.h>
+
+namespace {
+
+// image manager is not known to be thread safe so image creation is serialized
+// (decoding into the created image is not)
+std::mutex s_createMutex;
+
+}
+
+//---
+
+CImportImageCache::
+~CImportImageCache()
+{
+  stopWorkers();
+}
+
+void
+CImportImageCache::
+setNumWorkers(uint n)
+{
+  if (n == numWorkers_)
+    return;
+
+  stopWorkers();
+
+  numWorkers_ = n;
+
+  startWorkers();
+}
+
+CImportImageCache::Id
+CImportImageCache::
+addFile(const std::string &filename, bool flipH)
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  auto key = filename + (flipH ? "|h" : "");
+
+  auto pf = fileIds_.find(key);
+
+  if (pf != fileIds_.end())
+    return (*pf).second;
+
+  auto id = Id(entries_.size());
+
+  entries_.emplace_back();
+
+  auto &source = entries_.back().source;
+
+  source.filename = filename;
+  source.flipH    = flipH;
+
+  fileIds_[key] = id;
+
+  return id;
+}
+
+CImportImageCache::Id
+CImportImageCache::
+addData(const uchar *data, long len, CFileType type, bool flipH)
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  auto id = Id(entries_.size());
+
+  entries_.emplace_back();
+
+  auto &source = entries_.back().source;
+
+  source.data  = data;
+  source.len   = len;
+  source.type  = type;
+  source.flipH = flipH;
+
+  return id;
+}
+
+size_t
+CImportImageCache::
+numImages() const
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  return entries_.size();
+}
+
+const std::string &
+CImportImageCache::
+filename(Id id) const
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  return entries_[id].source.filename;
+}
+
+bool
+CImportImageCache::
+isDecoded(Id id) const
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  return (entries_[id].state == State::DECODED);
+}
+
+void
+CImportImageCache::
+prefetch(Id id)
+{
+  if (numWorkers_ == 0)
+    return;
+
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  auto &entry = entries_[id];
+
+  if (entry.state != State::SOURCE)
+    return;
+
+  entry.state = State::QUEUED;
+
+  queue_.push_back(id);
+
+  queueCond_.notify_one();
+}
+
+CImagePtr
+CImportImageCache::
+image(Id id)
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  auto &entry = entries_[id];
+
+  entry.lastUse = ++useCount_;
+
+  for (;;) {
+    if (entry.state == State::DECODED)
+      break;
+
+    if (entry.state == State::FAILED)
+      return CImagePtr();
+
+    // being decoded by worker
+    if (entry.state == State::DECODING) {
+      doneCond_.wait(lock);
+      continue;
+    }
+
+    // not decoded (or still queued) so decode now (workers skip entry)
+    entry.state = State::DECODING;
+
+    auto source = entry.source;
+
+    lock.unlock();
+
+    auto image = decode(source);
+
+    lock.lock();
+
+    finish(id, image);
+  }
+
+  auto image = entry.image;
+
+  evict();
+
+  return image;
+}
+
+void
+CImportImageCache::
+clear()
+{
+  stopWorkers();
+
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  entries_.clear();
+  fileIds_.clear();
+
+  numDecoded_ = 0;
+  useCount_   = 0;
+
+  lock.unlock();
+
+  startWorkers();
+}
+
+CImagePtr
+CImportImageCache::
+decode(const Source &source)
+{
+  CImagePtr image;
+
+  {
+    std::unique_lock<std::mutex> lock(s_createMutex);
+
+    image = CImageMgrInst->createImage();
+  }
+
+  bool rc;
+
+  if (source.filename != "")
+    rc = image->read(source.filename);
+  else
+    rc = image->read(source.data, source.len, source.type);
+
+  if (! rc)
+    return CImagePtr();
+
+  if (source.flipH)
+    image = image->flippedH();
+
+  return image;
+}
+
+void
+CImportImageCache::
+startWorkers()
+{
+  stop_ = false;
+
+  for (uint i = 0; i < numWorkers_; ++i)
+    workers_.emplace_back(&CImportImageCache::workerLoop, this);
+}
+
+void
+CImportImageCache::
+stopWorkers()
+{
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    stop_ = true;
+
+    // return queued images to source state
+    for (auto id : queue_) {
+      auto &entry = entries_[id];
+
+      if (entry.state == State::QUEUED)
+        entry.state = State::SOURCE;
+    }
+
+    queue_.clear();
+  }
+
+  queueCond_.notify_all();
+
+  for (auto &worker : workers_)
+    worker.join();
+
+  workers_.clear();
+}
+
+void
+CImportImageCache::
+workerLoop()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  for (;;) {
+    queueCond_.wait(lock, [&]() { return (stop_ || ! queue_.empty()); });
+
+    if (stop_)
+      break;
+
+    auto id = queue_.front();
+
+    queue_.pop_front();
+
+    auto &entry = entries_[id];
+
+    // already decoded on first use
+    if (entry.state != State::QUEUED)
+      continue;
+
+    entry.state = State::DECODING;
+
+    auto source = entry.source;
+
+    lock.unlock();
+
+    auto image = decode(source);
+
+    lock.lock();
+
+    finish(id, image);
+
+    evict();
+  }
+}
+
+// store decoded image (mutex locked)
+void
+CImportImageCache::
+finish(Id id, const CImagePtr &image)
+{
+  auto &entry = entries_[id];
+
+  if (image) {
+    entry.state = State::DECODED;
+    entry.image = image;
+
+    // count decode as a use so prefetched images are not evicted before first use
+    entry.lastUse = ++useCount_;
+
+    ++numDecoded_;
+  }
+  else
+    entry.state = State::FAILED;
+
+  doneCond_.notify_all();
+}
+
+// drop least recently used decoded images over limit (mutex locked)
+void
+CImportImageCache::
+evict()
+{
+  if (maxImages_ == 0)
+    return;
+
+  while (numDecoded_ > maxImages_) {
+    Entry *lruEntry = nullptr;
+
+    for (auto &entry : entries_) {
+      if (entry.state != State::DECODED)
+        continue;
+
+      if (! lruEntry || entry.lastUse < lruEntry->lastUse)
+        lruEntry = &entry;
+    }
+
+    if (! lruEntry)
+      break;
+
+    lruEntry->state = State::SOURCE;
+    lruEntry->image = CImagePtr();
+
+    --numDecoded_;
+  }
+}
@@ -0,0 +1,30 @@
+#include <CImportInstance.h>
+
+#include <map>
+
+CImportInstancing::InstanceGroups
+CImportInstancing::
+instanceGroups() const
+{
+  InstanceGroups groups;
+
+  std::map<CGeomObject3D *, size_t> meshGroup;
+
+  for (const auto &instance : instances_) {
+    auto pg = meshGroup.find(instance.mesh);
+
+    if (pg == meshGroup.end()) {
+      pg = meshGroup.emplace(instance.mesh, groups.size()).first;
+
+      InstanceGroup group;
+
+      group.mesh = instance.mesh;
+
+      groups.push_back(group);
+    }
+
+    groups[(*pg).second].instances.push_back(&instance);
+  }
+
+  return groups;
+}
@@ -0,0 +1,118 @@
+#include <CImportMapFile.h>
+
+#include <algorithm>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+bool
+CImportMapFile::
+open(const std::string &filename, bool map)
+{
+  close();
+
+  int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+
+  struct stat st;
+
+  if (::fstat(fd, &st) != 0) {
+    ::close(fd);
+    return false;
+  }
+
+  size_ = size_t(st.st_size);
+
+  if (size_ == 0) {
+    ::close(fd);
+    open_ = true;
+    return true;
+  }
+
+  auto *addr = (map ? ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED);
+
+  if (addr != MAP_FAILED) {
+    // importers parse front to back
+    (void) ::madvise(addr, size_, MADV_SEQUENTIAL);
+
+    data_   = static_cast<const unsigned char *>(addr);
+    mapped_ = true;
+  }
+  else {
+    if (! readFile(fd)) {
+      ::close(fd);
+      size_ = 0;
+      return false;
+    }
+  }
+
+  ::close(fd);
+
+  open_ = true;
+
+  return true;
+}
+
+bool
+CImportMapFile::
+readFile(int fd)
+{
+  buffer_.resize(size_);
+
+  size_t pos = 0;
+
+  while (pos < size_) {
+    auto n = ::read(fd, &buffer_[pos], size_ - pos);
+
+    if (n <= 0)
+      return false;
+
+    pos += size_t(n);
+  }
+
+  data_ = buffer_.data();
+
+  return true;
+}
+
+void
+CImportMapFile::
+releaseTo(size_t pos)
+{
+  if (! mapped_)
+    return;
+
+  static auto pageSize = size_t(::sysconf(_SC_PAGESIZE));
+
+  auto end = (std::min(pos, size_)/pageSize)*pageSize;
+
+  if (end <= released_)
+    return;
+
+  // private read only mapping so pages are just re-read if accessed again
+  (void) ::madvise(const_cast<unsigned char *>(data_) + released_, end - released_,
+                   MADV_DONTNEED);
+
+  released_ = end;
+}
+
+void
+CImportMapFile::
+close()
+{
+  if (mapped_)
+    ::munmap(const_cast<unsigned char *>(data_), size_);
+
+  buffer_.clear();
+  buffer_.shrink_to_fit();
+
+  open_   = false;
+  mapped_ = false;
+  data_   = nullptr;
+  size_   = 0;
+
+  released_ = 0;
+}
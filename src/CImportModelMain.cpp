@@ -0,0 +1,364 @@
+#include <CImportBase.h>
+#include <CImportFBX.h>
+#include <CImportInstance.h>
+#include <CImportObj.h>
+#include <CImportPly.h>
+#include <CImportSTL.h>
+#include <CImportVoxel.h>
+#include <CGeometry3D.h>
+#include <CFile.h>
+#include <CStrUtil.h>
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+
+namespace {
+
+auto exitMsg(const std::string &msg) -> int {
+  std::cerr << "\033[33mError\033[0m: " << msg << "\n";
+  return 1;
+}
+
+template<typename T>
+void hashCombine(size_t &h, const T &v) {
+  h ^= std::hash<T>()(v) + 0x9e3779b9 + (h << 6) + (h >> 2);
+}
+
+// hash object geometry so loads can be compared (object boundaries, vertex
+// positions and face vertex indices, in scene order)
+void hashObject(size_t &h, CGeomObject3D *object) {
+  auto nv = object->getNumVertices();
+
+  hashCombine(h, nv);
+
+  for (uint i = 0; i < nv; ++i) {
+    const auto &p = object->getVertex(i).getModel();
+
+    hashCombine(h, p.x);
+    hashCombine(h, p.y);
+    hashCombine(h, p.z);
+  }
+
+  const auto &faces = object->getFaces();
+
+  hashCombine(h, faces.size());
+
+  for (const auto *face : faces) {
+    const auto &vertices = face->getVertices();
+
+    hashCombine(h, vertices.size());
+
+    for (const auto &v : vertices)
+      hashCombine(h, v);
+  }
+}
+
+struct LoadStats {
+  double secs         { 0.0 };
+  size_t numObjects   { 0 };
+  size_t numVertices  { 0 };
+  size_t numFaces     { 0 };
+  size_t numInstances { 0 };
+  size_t geomHash     { 0 }; // hash of each object's vertex positions and face indices
+};
+
+struct LoadOptions {
+  bool   debug      { false };
+  bool   mapFile    { false };
+  bool   timing     { false };
+  uint   numThreads { 1 };
+  bool   weld       { false };
+  double weldTol    { 0.0 };
+  double voxelSize  { 0.0 };
+  size_t maxPoints  { 0 };
+  bool   voxelBoxes { false };
+  bool   instancing { false };
+};
+
+bool loadFile(const std::string &filename, CGeom3DType format, const LoadOptions &options,
+              LoadStats &stats) {
+  auto *im = CImportBase::createModel(format, "model");
+  if (! im) return false;
+
+  im->setDebug     (options.debug);
+  im->setMapFile   (options.mapFile);
+  im->setNumThreads(options.numThreads);
+
+  auto *stl = dynamic_cast<CImportSTL *>(im);
+
+  if (stl) {
+    stl->setWeldVertices (options.weld);
+    stl->setWeldTolerance(options.weldTol);
+  }
+
+  auto *fbx = dynamic_cast<CImportFBX *>(im);
+
+  if (fbx)
+    fbx->setTiming(options.timing);
+
+  auto *obj = dynamic_cast<CImportObj *>(im);
+
+  if (obj)
+    obj->setTiming(options.timing);
+
+  auto *ply = dynamic_cast<CImportPly *>(im);
+
+  if (ply) {
+    ply->setDecimateVoxelSize(options.voxelSize);
+    ply->setDecimateMaxPoints(options.maxPoints);
+  }
+
+  auto *voxel = dynamic_cast<CImportVoxel *>(im);
+
+  if (voxel)
+    voxel->setGreedyMesh(! options.voxelBoxes);
+
+  // scene, glTF and DXF
+  auto *instancing = dynamic_cast<CImportInstancing *>(im);
+
+  if (instancing)
+    instancing->setInstancing(options.instancing);
+
+  CFile file(filename);
+
+  auto t1 = std::chrono::steady_clock::now();
+
+  bool rc = im->read(file);
+
+  auto t2 = std::chrono::steady_clock::now();
+
+  stats.secs = std::chrono::duration<double>(t2 - t1).count();
+
+  if (rc && stl && options.weld)
+    stl->printWeldStats();
+
+  if (rc) {
+    for (auto *object : im->getScene().getObjects()) {
+      ++stats.numObjects;
+
+      stats.numVertices += object->getNumVertices();
+      stats.numFaces    += object->getFaces().size();
+
+      hashObject(stats.geomHash, object);
+    }
+
+    if (instancing)
+      stats.numInstances = instancing->instances().size();
+  }
+
+  delete im;
+
+  return rc;
+}
+
+void printStats(const std::string &name, size_t fileSize, const LoadStats &stats) {
+  auto mb = double(fileSize)/(1024.0*1024.0);
+
+  std::cout << name << ": " << stats.secs << "s";
+
+  if (stats.secs > 0.0)
+    std::cout << " (" << mb/stats.secs << " MB/s)";
+
+  std::cout << " objects=" << stats.numObjects <<
+               " vertices=" << stats.numVertices <<
+               " faces=" << stats.numFaces;
+
+  if (stats.numInstances > 0)
+    std::cout << " instances=" << stats.numInstances;
+
+  std::cout << "\n";
+}
+
+}
+
+//---
+
+// load model and report load time and throughput (MB/s)
+//  -map   : use memory mapped fast path
+//  -bench : load with both paths (and threaded with -threads) and compare
+//  -timing : report FBX and threaded OBJ read phase times
+//  -threads <n> : number of parse threads (0 is one per core)
+//  -weld <tol>  : weld STL vertices within tolerance (and report reduction)
+//  -decimate <size> : PLY voxel grid decimation size
+//  -max_points <n>  : PLY max decimated points
+//  -voxel_boxes     : add box per voxel (no face culling or merging)
+//  -instancing      : scene/glTF/DXF objects share meshes
+int
+main(int argc, char **argv)
+{
+  std::string filename;
+  LoadOptions options;
+  bool        bench { false };
+
+  for (int i = 1; i < argc; ++i) {
+    if (argv[i][0] == '-') {
+      auto arg = std::string(&argv[i][1]);
+
+      if      (arg == "debug")
+        options.debug = true;
+      else if (arg == "map")
+        options.mapFile = true;
+      else if (arg == "bench")
+        bench = true;
+      else if (arg == "timing")
+        options.timing = true;
+      else if (arg == "threads") {
+        ++i;
+
+        if (i >= argc)
+          return exitMsg("Missing value for '-threads'");
+
+        int n;
+
+        if (! CStrUtil::toInteger(argv[i], &n) || n < 0)
+          return exitMsg("Invalid value '" + std::string(argv[i]) + "' for '-threads'");
+
+        options.numThreads = uint(n);
+      }
+      else if (arg == "weld") {
+        ++i;
+
+        if (i >= argc)
+          return exitMsg("Missing value for '-weld'");
+
+        double r;
+
+        if (! CStrUtil::toReal(argv[i], &r) || r < 0.0)
+          return exitMsg("Invalid value '" + std::string(argv[i]) + "' for '-weld'");
+
+        options.weld    = true;
+        options.weldTol = r;
+      }
+      else if (arg == "decimate") {
+        ++i;
+
+        if (i >= argc)
+          return exitMsg("Missing value for '-decimate'");
+
+        double r;
+
+        if (! CStrUtil::toReal(argv[i], &r) || r < 0.0)
+          return exitMsg("Invalid value '" + std::string(argv[i]) + "' for '-decimate'");
+
+        options.voxelSize = r;
+      }
+      else if (arg == "max_points") {
+        ++i;
+
+        if (i >= argc)
+          return exitMsg("Missing value for '-max_points'");
+
+        int n;
+
+        if (! CStrUtil::toInteger(argv[i], &n) || n < 0)
+          return exitMsg("Invalid value '" + std::string(argv[i]) + "' for '-max_points'");
+
+        options.maxPoints = size_t(n);
+      }
+      else if (arg == "voxel_boxes")
+        options.voxelBoxes = true;
+      else if (arg == "instancing")
+        options.instancing = true;
+      else if (arg == "h" || arg == "help") {
+        std::cerr << "CImportModel [-debug] [-map] [-bench] [-timing] [-threads <n>] [-weld <tol>] [-decimate <size>] [-max_points <n>] [-voxel_boxes] [-instancing] <filename>\n";
+        return 0;
+      }
+      else
+        return exitMsg("Invalid arg '" + arg + "'");
+    }
+    else
+      filename = argv[i];
+  }
+
+  if (filename == "")
+    return exitMsg("Missing filename");
+
+  auto format = CImportBase::filenameToType(filename);
+
+  if (format == CGEOM_3D_TYPE_NONE)
+    return exitMsg("Unknown format for '" + filename + "'");
+
+  size_t fileSize = 0;
+
+  {
+    CFile file(filename);
+
+    if (! file.exists())
+      return exitMsg("Missing file '" + filename + "'");
+
+    fileSize = size_t(file.getSize());
+  }
+
+  if (bench) {
+    LoadStats readStats, mapStats;
+
+    auto readOptions = options;
+
+    readOptions.mapFile    = false;
+    readOptions.numThreads = 1;
+
+    auto mapOptions = options;
+
+    mapOptions.mapFile    = true;
+    mapOptions.numThreads = 1;
+
+    if (! loadFile(filename, format, readOptions, readStats))
+      return exitMsg("Load '" + filename + "' failed");
+
+    if (! loadFile(filename, format, mapOptions, mapStats))
+      return exitMsg("Load (mapped) '" + filename + "' failed");
+
+    printStats("read", fileSize, readStats);
+    printStats("map ", fileSize, mapStats);
+
+    if (mapStats.secs > 0.0)
+      std::cout << "speedup: " << readStats.secs/mapStats.secs << "x\n";
+
+    // check load matches serial read
+    auto compareStats = [&](const std::string &name, const LoadStats &stats) {
+      if (readStats.numObjects  != stats.numObjects  ||
+          readStats.numVertices != stats.numVertices ||
+          readStats.numFaces    != stats.numFaces)
+        return exitMsg(name + " load mismatch (counts)");
+
+      if (readStats.geomHash != stats.geomHash)
+        return exitMsg(name + " load mismatch (vertex positions or face indices)");
+
+      return 0;
+    };
+
+    if (compareStats("Mapped", mapStats))
+      return 1;
+
+    // threaded load (chunked parse for large OBJ files)
+    if (options.numThreads != 1) {
+      LoadStats threadStats;
+
+      auto threadOptions = options;
+
+      threadOptions.mapFile = true;
+
+      if (! loadFile(filename, format, threadOptions, threadStats))
+        return exitMsg("Load (threaded) '" + filename + "' failed");
+
+      printStats("threads", fileSize, threadStats);
+
+      if (threadStats.secs > 0.0)
+        std::cout << "speedup: " << readStats.secs/threadStats.secs << "x\n";
+
+      if (compareStats("Threaded", threadStats))
+        return 1;
+    }
+  }
+  else {
+    LoadStats stats;
+
+    if (! loadFile(filename, format, options, stats))
+      return exitMsg("Load '" + filename + "' failed");
+
+    printStats(options.mapFile ? "map" : "read", fileSize, stats);
+  }
+
+  return 0;
+}
@@ -1,10 +1,21 @@
 #include <CImportObj.h>
+#include <CImportMapFile.h>
+#include <CImportParallel.h>
 #include <CGeometry3D.h>
 #include <CStrUtil.h>
 
+#include <algorithm>
+#include <charconv>
+#include <chrono>
 #include <set>
 
 namespace {
+  using Clock = std::chrono::steady_clock;
+
+  double elapsedSecs(const Clock::time_point &t1, const Clock::time_point &t2) {
+    return std::chrono::duration<double>(t2 - t1).count();
+  }
+
   static std::string s_line;
   static int         s_line_num { 0 };
   static std::string s_line1;
@@ -17,8 +28,264 @@ namespace {
   void warning(const std::string &msg) {
     std::cerr << "Warning: " << msg << ": '" << s_line1 << "' @" << s_line_num << "\n";
   }
+
+  bool isSpaceChar(char c) {
+    return (c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v');
+  }
+
+  std::string_view stripSpaces(std::string_view str) {
+    size_t i = 0, n = str.size();
+
+    while (i < n && isSpaceChar(str[i    ])) ++i;
+    while (n > i && isSpaceChar(str[n - 1])) --n;
+
+    return str.substr(i, n - i);
+  }
+
+  // in place parse of line values (no allocation)
+  class LineParse {
+   public:
+    LineParse(std::string_view str) :
+     p_(str.data()), e_(str.data() + str.size()) {
+    }
+
+    bool eof() const { return p_ >= e_; }
+
+    // skip spaces and return true if more data
+    bool skipSpace() {
+      while (p_ < e_ && isSpaceChar(*p_))
+        ++p_;
+
+      return (p_ < e_);
+    }
+
+    bool isSpace() const { return (p_ >= e_ || isSpaceChar(*p_)); }
+
+    bool isChar(char c) const { return (p_ < e_ && *p_ == c); }
+
+    void skipChar() { ++p_; }
+
+    bool readReal(double &r) {
+      auto *p = p_;
+
+      if (p < e_ && *p == '+')
+        ++p;
+
+      auto res = std::from_chars(p, e_, r);
+
+      if (res.ec != std::errc() || (res.ptr < e_ && ! isSpaceChar(*res.ptr)))
+        return false;
+
+      p_ = res.ptr;
+
+      return true;
+    }
+
+    bool readInteger(long &i) {
+      auto *p = p_;
+
+      if (p < e_ && *p == '+')
+        ++p;
+
+      auto res = std::from_chars(p, e_, i);
+
+      if (res.ec != std::errc())
+        return false;
+
+      p_ = res.ptr;
+
+      return true;
+    }
+
+   private:
+    const char *p_ { nullptr };
+    const char *e_ { nullptr };
+  };
+
+  // check line starts with keyword followed by space
+  bool isKeyword(std::string_view line, std::string_view name) {
+    auto len = name.size();
+
+    return (line.size() > len && line.substr(0, len) == name && isSpaceChar(line[len]));
+  }
+
+  // decode 'v' values : <x> <y> <z> [<r> <g> <b>]
+  bool decodeVertex(std::string_view line, double r[6], int &n) {
+    LineParse parse(line);
+
+    n = 0;
+
+    while (n < 6 && parse.skipSpace()) {
+      if (! parse.readReal(r[n]))
+        return false;
+
+      ++n;
+    }
+
+    return (n >= 3);
+  }
+
+  // decode 'vt' values : <u> <v> [<w>] (n is zero for unsupported value count)
+  void decodeTextureVertex(std::string_view line, double r[3], int &n) {
+    LineParse parse(line);
+
+    n = 0;
+
+    while (n < 3 && parse.skipSpace()) {
+      if (! parse.readReal(r[n])) {
+        n = 0;
+        return;
+      }
+
+      ++n;
+    }
+
+    if (n < 2 || parse.skipSpace())
+      n = 0;
+  }
+
+  // decode 'vn' values : <x> <y> <z>
+  bool decodeVertexNormal(std::string_view line, double r[3]) {
+    LineParse parse(line);
+
+    for (int i = 0; i < 3; ++i) {
+      if (! parse.skipSpace() || ! parse.readReal(r[i]))
+        return false;
+    }
+
+    return ! parse.skipSpace();
+  }
+
+  // decode 'f' words : <vertex>[/[<texture>][/[<normal>]]]
+  // calls func(v, t, n) with file indices for each word (zero if texture or normal not set)
+  template<typename FUNC>
+  bool decodeFace(std::string_view line, FUNC func) {
+    LineParse parse(line);
+
+    while (parse.skipSpace()) {
+      long num1 = 0, num2 = 0, num3 = 0;
+
+      if (! parse.readInteger(num1) || num1 == 0)
+        return false;
+
+      if (parse.isChar('/')) {
+        parse.skipChar();
+
+        if (! parse.isChar('/') && ! parse.isSpace()) {
+          if (! parse.readInteger(num2) || num2 == 0)
+            return false;
+        }
+
+        if (parse.isChar('/')) {
+          parse.skipChar();
+
+          if (! parse.isSpace()) {
+            if (! parse.readInteger(num3) || num3 == 0)
+              return false;
+          }
+        }
+      }
+
+      if (! parse.isSpace())
+        return false;
+
+      if (! func(num1, num2, num3))
+        return false;
+    }
+
+    return true;
+  }
 }
 
+//---
+
+// parsed records of one chunk of a mapped file (see readParallel)
+//
+// Vertex, texture, normal and face values are stored in flat arrays. The record
+// list holds run lengths of each record type (and single commands) so they can be
+// replayed in file order.
+struct CImportObj::ChunkData {
+  enum class RecordType {
+    VERTEX,
+    TEXTURE,
+    NORMAL,
+    FACE,
+    COMMAND
+  };
+
+  enum class CommandType {
+    OBJECT,
+    GROUP,
+    MATERIAL,
+    MATERIAL_LIB,
+    PARAMETER,
+    ERROR,
+    VERTEX_ERROR,
+    NORMAL_ERROR
+  };
+
+  struct Record {
+    RecordType type  { RecordType::VERTEX };
+    size_t     count { 0 };
+  };
+
+  struct Command {
+    CommandType type { CommandType::ERROR };
+    std::string arg;     // name or error message
+    std::string line;    // source line (for messages)
+    size_t      lineNum  { 0 };
+  };
+
+  struct VertexColor {
+    size_t ind { 0 };
+    double r   { 0.0 };
+    double g   { 0.0 };
+    double b   { 0.0 };
+  };
+
+  using Records  = std::vector<Record>;
+  using Commands = std::vector<Command>;
+  using Reals    = std::vector<double>;
+  using Colors   = std::vector<VertexColor>;
+  using Sizes    = std::vector<size_t>;
+  using Indices  = std::vector<long>;
+
+  void addRecord(RecordType type) {
+    if (! records.empty() && records.back().type == type && type != RecordType::COMMAND)
+      ++records.back().count;
+    else
+      records.push_back(Record{type, 1});
+  }
+
+  void addCommand(CommandType type, std::string_view arg, std::string_view line) {
+    addRecord(RecordType::COMMAND);
+
+    commands.push_back(Command{type, std::string(arg), std::string(line), numLines});
+  }
+
+  Records  records;
+  Commands commands;
+  Reals    vertices;       // x, y, z per vertex
+  Colors   colors;         // optional vertex colors (chunk vertex index)
+  Reals    texturePoints;  // x, y, z per texture point
+  Reals    normals;        // x, y, z per normal
+  Sizes    faceSizes;      // number of vertices per face
+  Indices  faceIndices;    // vertex, texture, normal index (zero based, -1 if not set)
+  Sizes    fixups;         // faceIndices positions relative to chunk start
+
+  // number of records (including invalid ones) for running index counters
+  size_t numVertices      { 0 };
+  size_t numTexturePoints { 0 };
+  size_t numNormals       { 0 };
+  size_t numLines         { 0 };
+
+  // counts of preceding chunks
+  size_t vertexOffset  { 0 };
+  size_t textureOffset { 0 };
+  size_t normalOffset  { 0 };
+  size_t lineOffset    { 0 };
+};
+
 CImportObj::
 CImportObj(CGeomScene3D *scene, const std::string &name) :
  scene_(scene)
@@ -52,8 +319,62 @@ read(CFile &file)
   file_ = &file;
 
   vnum_  = 0;
+  vtnum_ = 0;
   vnnum_ = 0;
 
+  // decode material images in background when threaded
+  imageCache_.setNumWorkers(numThreads() != 1 ? CImportParallel::numThreads(numThreads()) : 0);
+
+  if (isMapFile() || numThreads() != 1) {
+    CImportMapFile mapFile;
+
+    if (! mapFile.open(file.getPath()))
+      return false;
+
+    if (CImportParallel::numThreads(numThreads()) > 1) {
+      if (! readParallel(mapFile.view()))
+        return false;
+    }
+    else {
+      if (! readMapped(mapFile.view()))
+        return false;
+    }
+  }
+  else {
+    if (! readLines())
+      return false;
+  }
+
+  //---
+
+  if (isTriangulate())
+    object_->triangulate();
+
+  //---
+
+  // TODO: handle children
+
+  if (isSplitByMaterial()) {
+    std::vector<CGeomObject3D *> newObjects;
+
+    if (object_->splitFacesByMaterial(newObjects)) {
+      for (auto *newObject : newObjects) {
+        scene_->addObject(newObject);
+
+        object_->addChild(newObject);
+      }
+
+      object_->clearGeometry(/*destroy*/false);
+    }
+  }
+
+  return true;
+}
+
+bool
+CImportObj::
+readLines()
+{
   while (file_->readLine(s_line)) {
     ++s_line_num;
 
@@ -124,99 +445,653 @@ read(CFile &file)
     else if (len > 2 && line1[0] == 'o' && line1[1] == ' ') {
       auto name = CStrUtil::stripSpaces(line1.substr(2));
 
-      if      (numObjects_ == 0) {
-        currentObject_->setName(name);
-      }
-      else if (numObjects_ == 1) {
-        // add current object to new root object
-        object_ = CGeometry3DInst->createObject3D(scene_, "scene");
+      setObjectName(name);
+    }
+    else if (len > 2 && line1[0] == 's' && line1[1] == ' ') {
+      // skip smoothing group
+    }
+    else if (len > 2 && line1[0] == 'l' && line1[1] == ' ') {
+      // skip line
+    }
+    else if (len > 6 && line1.substr(0, 6) == "mtllib" && line1[6] == ' ') {
+      line1 = CStrUtil::stripSpaces(line1.substr(6));
+
+      if (! readMaterialFile(line1))
+        error("Invalid material file");
+    }
+    else if (len > 6 && line1.substr(0, 6) == "usemtl" && line1[6] == ' ') {
+      line1 = CStrUtil::stripSpaces(line1.substr(6));
 
-        scene_->addObject(object_);
+      useMaterial(line1);
+    }
+    else {
+      error("Unrecognised material line");
+    }
+  }
 
-        pobject_.release();
+  return true;
+}
 
-        pobject_ = ObjectP(object_);
+// parse lines of mapped file in place (v, vt, vn and f records are decoded
+// without copying the line or splitting it into words)
+bool
+CImportObj::
+readMapped(std::string_view data)
+{
+  auto lineError = [&](const std::string &msg, std::string_view line) {
+    s_line1 = std::string(line);
 
-        object_->addChild(currentObject_); // add current as child
+    error(msg);
+  };
 
-        // add new object to root object
-        currentObject_ = CGeometry3DInst->createObject3D(scene_, name);
+  auto pos = size_t(0);
+  auto len = data.size();
 
-        scene_->addObject(currentObject_);
+  while (pos < len) {
+    auto eol = data.find('\n', pos);
 
-        object_->addChild(currentObject_);
-      }
-      else {
-        // add new object to root object
-        currentObject_ = CGeometry3DInst->createObject3D(scene_, name);
+    if (eol == std::string_view::npos)
+      eol = len;
 
-        scene_->addObject(currentObject_);
+    auto line = stripSpaces(data.substr(pos, eol - pos));
 
-        object_->addChild(currentObject_);
-      }
+    pos = eol + 1;
 
-      voffset_  = vnum_ ;
-      vnoffset_ = vnnum_;
-      vtoffset_ = vtnum_;
+    ++s_line_num;
+
+    if (line.empty() || line[0] == '#')
+      continue;
+
+    // vertex
+    if      (isKeyword(line, "v")) {
+      if (numObjects_ == 0)
+        ++numObjects_;
+
+      if (! parseVertex(line.substr(2)))
+        lineError("Invalid vertex line", line);
 
-      ++numObjects_;
+      ++vnum_;
     }
-    else if (len > 2 && line1[0] == 's' && line1[1] == ' ') {
+    // vertex texture coord
+    else if (isKeyword(line, "vt")) {
+      if (! parseTextureVertex(line.substr(3)))
+        lineError("Invalid texture vertex line", line);
+
+      ++vtnum_;
+    }
+    // vertex normal coord
+    else if (isKeyword(line, "vn")) {
+      if (! parseVertexNormal(line.substr(3)))
+        lineError("Invalid vertex normal line", line);
+
+      ++vnnum_;
+    }
+    // face
+    else if (isKeyword(line, "f")) {
+      if (! parseFace(line.substr(2)))
+        lineError("Invalid face line", line);
+    }
+    // parameter space vertex
+    else if (isKeyword(line, "vp")) {
+      if (! readParameterVertex(std::string(stripSpaces(line.substr(3)))))
+        lineError("Invalid parameter vertex line", line);
+    }
+    // group
+    else if (isKeyword(line, "g")) {
+      if (! readGroupName(std::string(stripSpaces(line.substr(2)))))
+        lineError("Invalid group name line", line);
+    }
+    else if (line == "g") {
+      if (! readGroupName(""))
+        lineError("Invalid group name line", line);
+    }
+    else if (isKeyword(line, "o")) {
+      setObjectName(std::string(stripSpaces(line.substr(2))));
+    }
+    else if (isKeyword(line, "s")) {
       // skip smoothing group
     }
-    else if (len > 2 && line1[0] == 'l' && line1[1] == ' ') {
+    else if (isKeyword(line, "l")) {
       // skip line
     }
-    else if (len > 6 && line1.substr(0, 6) == "mtllib" && line1[6] == ' ') {
-      line1 = CStrUtil::stripSpaces(line1.substr(6));
+    else if (isKeyword(line, "mtllib")) {
+      s_line1 = std::string(line);
 
-      if (! readMaterialFile(line1))
+      if (! readMaterialFile(std::string(stripSpaces(line.substr(6)))))
         error("Invalid material file");
     }
-    else if (len > 6 && line1.substr(0, 6) == "usemtl" && line1[6] == ' ') {
-      line1 = CStrUtil::stripSpaces(line1.substr(6));
+    else if (isKeyword(line, "usemtl")) {
+      s_line1 = std::string(line);
+
+      useMaterial(std::string(stripSpaces(line.substr(6))));
+    }
+    else {
+      lineError("Unrecognised material line", line);
+    }
+  }
+
+  return true;
+}
+
+// parse mapped file in chunks on multiple threads
+//
+// The file is split at line boundaries and each chunk is decoded in parallel into
+// flat value arrays (see ChunkData). The running vertex, texture and normal counts
+// of the preceding chunks are then prefix summed so chunk relative (negative) face
+// indices can be resolved, and finally the chunks are merged in file order so
+// o/g/usemtl/mtllib records apply to the same faces as in the serial parse.
+//
+// Only decode and resolve run in parallel. The merge adds vertices and faces to the
+// scene objects one at a time (CGeomObject3D is not thread safe) so it bounds the
+// speedup; setTiming reports the time of each phase.
+bool
+CImportObj::
+readParallel(std::string_view data)
+{
+  static const size_t minChunkSize = 1024*1024;
+
+  auto numThreads = CImportParallel::numThreads(this->numThreads());
+
+  auto len = data.size();
+
+  // four chunks per thread to balance uneven line mix
+  auto numChunks = std::max(std::min(size_t(numThreads)*4, len/minChunkSize), size_t(1));
+
+  if (numChunks == 1)
+    return readMapped(data);
+
+  // split at line boundaries
+  std::vector<std::string_view> chunkData;
+
+  size_t pos = 0;
+
+  for (size_t i = 1; i <= numChunks && pos < len; ++i) {
+    auto end = (i < numChunks ? (len*i)/numChunks : len);
+
+    if (end < pos)
+      end = pos;
+
+    auto eol = data.find('\n', end);
+
+    end = (eol != std::string_view::npos ? eol + 1 : len);
+
+    if (i == numChunks)
+      end = len;
+
+    chunkData.push_back(data.substr(pos, end - pos));
+
+    pos = end;
+  }
+
+  numChunks = chunkData.size();
+
+  std::vector<ChunkData> chunks(numChunks);
+
+  phaseTimes_ = PhaseTimes();
+
+  auto t1 = Clock::now();
+
+  CImportParallel::parallelFor(numChunks, numThreads, [&](size_t i) {
+    parseChunk(chunkData[i], chunks[i]);
+  });
+
+  auto t2 = Clock::now();
+
+  phaseTimes_.decode = elapsedSecs(t1, t2);
+
+  //---
+
+  // prefix sum record counts
+  auto vertexOffset  = size_t(vnum_);
+  auto textureOffset = size_t(vtnum_);
+  auto normalOffset  = size_t(vnnum_);
+  auto lineOffset    = size_t(s_line_num);
+
+  for (auto &chunk : chunks) {
+    chunk.vertexOffset  = vertexOffset;
+    chunk.textureOffset = textureOffset;
+    chunk.normalOffset  = normalOffset;
+    chunk.lineOffset    = lineOffset;
+
+    vertexOffset  += chunk.numVertices;
+    textureOffset += chunk.numTexturePoints;
+    normalOffset  += chunk.numNormals;
+    lineOffset    += chunk.numLines;
+  }
+
+  // resolve chunk relative indices (position in triple gives index type)
+  CImportParallel::parallelFor(numChunks, numThreads, [&](size_t i) {
+    auto &chunk = chunks[i];
+
+    for (auto fpos : chunk.fixups) {
+      auto &ind = chunk.faceIndices[fpos];
+
+      switch (fpos % 3) {
+        case 0 : ind += long(chunk.vertexOffset ); break;
+        case 1 : ind += long(chunk.textureOffset); break;
+        default: ind += long(chunk.normalOffset ); break;
+      }
 
-      auto pm = materials_.find(line1);
+      // relative index before start of file
+      if (ind < 0)
+        ind = -2;
+    }
+  });
+
+  auto t3 = Clock::now();
+
+  phaseTimes_.resolve = elapsedSecs(t2, t3);
+
+  //---
+
+  for (auto &chunk : chunks) {
+    mergeChunk(chunk);
+
+    // free chunk memory as we go
+    chunk = ChunkData();
+  }
+
+  phaseTimes_.merge = elapsedSecs(t3, Clock::now());
+
+  if (isTiming())
+    std::cerr << "OBJ decode: " << phaseTimes_.decode  << "s" <<
+                 " resolve: "   << phaseTimes_.resolve << "s" <<
+                 " merge: "     << phaseTimes_.merge   << "s" <<
+                 " (" << numChunks << " chunks, " << numThreads << " threads)\n";
+
+  return true;
+}
+
+// decode chunk lines into chunk arrays (no access to object state)
+void
+CImportObj::
+parseChunk(std::string_view data, ChunkData &chunk) const
+{
+  using RecordType  = ChunkData::RecordType;
+  using CommandType = ChunkData::CommandType;
+
+  auto addIndex = [&](long num, size_t count) {
+    if (num < 0) {
+      chunk.fixups.push_back(chunk.faceIndices.size());
+
+      chunk.faceIndices.push_back(long(count) + num);
+    }
+    else
+      chunk.faceIndices.push_back(num - 1);
+  };
+
+  // rough reserve from chunk size (~32 bytes per record)
+  chunk.records.reserve(64);
+  chunk.vertices.reserve(data.size()/32);
+
+  auto pos = size_t(0);
+  auto len = data.size();
+
+  while (pos < len) {
+    auto eol = data.find('\n', pos);
+
+    if (eol == std::string_view::npos)
+      eol = len;
+
+    auto line = stripSpaces(data.substr(pos, eol - pos));
+
+    pos = eol + 1;
+
+    ++chunk.numLines;
+
+    if (line.empty() || line[0] == '#')
+      continue;
 
-      if (pm == materials_.end()) {
-        warning("Invalid material name");
+    // vertex
+    if      (isKeyword(line, "v")) {
+      double r[6]; int n;
+
+      if (decodeVertex(line.substr(2), r, n)) {
+        if (n == 6)
+          chunk.colors.push_back(ChunkData::VertexColor{chunk.vertices.size()/3, r[3], r[4], r[5]});
+
+        chunk.vertices.push_back(r[0]);
+        chunk.vertices.push_back(r[1]);
+        chunk.vertices.push_back(r[2]);
+
+        chunk.addRecord(RecordType::VERTEX);
+      }
+      else
+        chunk.addCommand(CommandType::VERTEX_ERROR, "Invalid vertex line", line);
+
+      ++chunk.numVertices;
+    }
+    // vertex texture coord
+    else if (isKeyword(line, "vt")) {
+      double r[3]; int n;
+
+      decodeTextureVertex(line.substr(3), r, n);
+
+      chunk.texturePoints.push_back(n > 0 ? r[0] : 0.0);
+      chunk.texturePoints.push_back(n > 0 ? r[1] : 0.0);
+      chunk.texturePoints.push_back(n > 2 ? r[2] : 0.0);
+
+      chunk.addRecord(RecordType::TEXTURE);
+
+      ++chunk.numTexturePoints;
+    }
+    // vertex normal coord
+    else if (isKeyword(line, "vn")) {
+      double r[3];
 
-        material_ = addMaterial(line1);
+      if (decodeVertexNormal(line.substr(3), r)) {
+        chunk.normals.push_back(r[0]);
+        chunk.normals.push_back(r[1]);
+        chunk.normals.push_back(r[2]);
+
+        chunk.addRecord(RecordType::NORMAL);
       }
       else
-        material_ = (*pm).second;
+        chunk.addCommand(CommandType::NORMAL_ERROR, "Invalid vertex normal line", line);
+
+      ++chunk.numNormals;
+    }
+    // face
+    else if (isKeyword(line, "f")) {
+      auto nind = chunk.faceIndices.size();
+      auto nfix = chunk.fixups.size();
+
+      auto rc = decodeFace(line.substr(2), [&](long v, long t, long n) {
+        addIndex(v, chunk.numVertices);
+
+        if (t != 0) addIndex(t, chunk.numTexturePoints); else chunk.faceIndices.push_back(-1);
+        if (n != 0) addIndex(n, chunk.numNormals      ); else chunk.faceIndices.push_back(-1);
+
+        return true;
+      });
+
+      if (rc) {
+        chunk.faceSizes.push_back((chunk.faceIndices.size() - nind)/3);
+
+        chunk.addRecord(RecordType::FACE);
+      }
+      else {
+        chunk.faceIndices.resize(nind);
+        chunk.fixups     .resize(nfix);
+
+        chunk.addCommand(CommandType::ERROR, "Invalid face line", line);
+      }
+    }
+    // parameter space vertex
+    else if (isKeyword(line, "vp")) {
+      chunk.addCommand(CommandType::PARAMETER, stripSpaces(line.substr(3)), line);
+    }
+    // group
+    else if (isKeyword(line, "g")) {
+      chunk.addCommand(CommandType::GROUP, stripSpaces(line.substr(2)), line);
+    }
+    else if (line == "g") {
+      chunk.addCommand(CommandType::GROUP, "", line);
+    }
+    else if (isKeyword(line, "o")) {
+      chunk.addCommand(CommandType::OBJECT, stripSpaces(line.substr(2)), line);
+    }
+    else if (isKeyword(line, "s")) {
+      // skip smoothing group
+    }
+    else if (isKeyword(line, "l")) {
+      // skip line
+    }
+    else if (isKeyword(line, "mtllib")) {
+      chunk.addCommand(CommandType::MATERIAL_LIB, stripSpaces(line.substr(6)), line);
+    }
+    else if (isKeyword(line, "usemtl")) {
+      chunk.addCommand(CommandType::MATERIAL, stripSpaces(line.substr(6)), line);
     }
     else {
-      error("Unrecognised material line");
+      chunk.addCommand(CommandType::ERROR, "Unrecognised material line", line);
     }
   }
+}
 
-  //---
+// add decoded chunk records to current object in file order
+void
+CImportObj::
+mergeChunk(const ChunkData &chunk)
+{
+  using RecordType  = ChunkData::RecordType;
+  using CommandType = ChunkData::CommandType;
 
-  if (isTriangulate())
-    object_->triangulate();
+  size_t iv = 0, it = 0, in = 0, icolor = 0, iface = 0, iind = 0, icmd = 0;
 
-  //---
+  for (const auto &record : chunk.records) {
+    switch (record.type) {
+      case RecordType::VERTEX: {
+        if (numObjects_ == 0)
+          ++numObjects_;
 
-  // TODO: handle children
+        for (size_t i = 0; i < record.count; ++i, ++iv) {
+          const auto *r = &chunk.vertices[3*iv];
 
-  if (isSplitByMaterial()) {
-    std::vector<CGeomObject3D *> newObjects;
+          int ind = currentObject_->addVertex(CPoint3D(r[0], r[1], r[2]));
 
-    if (object_->splitFacesByMaterial(newObjects)) {
-      for (auto *newObject : newObjects) {
-        scene_->addObject(newObject);
+          if (icolor < chunk.colors.size() && chunk.colors[icolor].ind == iv) {
+            const auto &c = chunk.colors[icolor++];
 
-        object_->addChild(newObject);
+            currentObject_->setVertexColor(ind, CRGBA(c.r, c.g, c.b));
+          }
+        }
+
+        vnum_ += int(record.count);
+
+        break;
       }
+      case RecordType::TEXTURE: {
+        for (size_t i = 0; i < record.count; ++i, ++it) {
+          const auto *r = &chunk.texturePoints[3*it];
 
-      object_->clearGeometry(/*destroy*/false);
+          currentObject_->addTexturePoint(CPoint3D(r[0], r[1], r[2]));
+        }
+
+        vtnum_ += int(record.count);
+
+        break;
+      }
+      case RecordType::NORMAL: {
+        for (size_t i = 0; i < record.count; ++i, ++in) {
+          const auto *r = &chunk.normals[3*in];
+
+          currentObject_->addNormal(CVector3D(r[0], r[1], r[2]));
+        }
+
+        vnnum_ += int(record.count);
+
+        break;
+      }
+      case RecordType::FACE: {
+        for (size_t i = 0; i < record.count; ++i, ++iface) {
+          faceVertices_     .clear();
+          faceTexturePoints_.clear();
+          faceNormals_      .clear();
+
+          auto nfv = chunk.faceSizes[iface];
+
+          bool valid = true;
+
+          for (size_t j = 0; j < nfv; ++j, iind += 3) {
+            auto v = chunk.faceIndices[iind    ];
+            auto t = chunk.faceIndices[iind + 1];
+            auto n = chunk.faceIndices[iind + 2];
+
+            if (v < 0 || t < -1 || n < -1)
+              valid = false;
+
+            faceVertices_     .push_back(uint(v));
+            faceTexturePoints_.push_back(t);
+            faceNormals_      .push_back(n);
+          }
+
+          if (valid)
+            (void) addFace();
+          else {
+            s_line_num = int(chunk.lineOffset);
+            s_line1    = "";
+
+            error("Invalid face index");
+          }
+        }
+
+        break;
+      }
+      case RecordType::COMMAND: {
+        const auto &command = chunk.commands[icmd++];
+
+        s_line_num = int(chunk.lineOffset + command.lineNum);
+        s_line1    = command.line;
+
+        switch (command.type) {
+          case CommandType::OBJECT:
+            setObjectName(command.arg);
+            break;
+          case CommandType::GROUP:
+            if (! readGroupName(command.arg))
+              error("Invalid group name line");
+            break;
+          case CommandType::MATERIAL:
+            useMaterial(command.arg);
+            break;
+          case CommandType::MATERIAL_LIB:
+            if (! readMaterialFile(command.arg))
+              error("Invalid material file");
+            break;
+          case CommandType::PARAMETER:
+            if (! readParameterVertex(command.arg))
+              error("Invalid parameter vertex line");
+            break;
+          case CommandType::VERTEX_ERROR:
+            if (numObjects_ == 0)
+              ++numObjects_;
+
+            error(command.arg);
+
+            ++vnum_;
+
+            break;
+          case CommandType::NORMAL_ERROR:
+            error(command.arg);
+
+            ++vnnum_;
+
+            break;
+          default:
+            error(command.arg);
+            break;
+        }
+
+        break;
+      }
     }
   }
 
+  s_line_num = int(chunk.lineOffset + chunk.numLines);
+}
+
+bool
+CImportObj::
+parseVertex(std::string_view line)
+{
+  double r[6]; int n;
+
+  if (! decodeVertex(line, r, n))
+    return false;
+
+  int ind = currentObject_->addVertex(CPoint3D(r[0], r[1], r[2]));
+
+  if (n == 6)
+    currentObject_->setVertexColor(ind, CRGBA(r[3], r[4], r[5]));
+
+  return true;
+}
+
+bool
+CImportObj::
+parseTextureVertex(std::string_view line)
+{
+  double r[3]; int n;
+
+  decodeTextureVertex(line, r, n);
+
+  CPoint3D p;
+
+  if      (n == 2)
+    p = CPoint3D(r[0], r[1], 0.0);
+  else if (n == 3)
+    p = CPoint3D(r[0], r[1], r[2]);
+
+  currentObject_->addTexturePoint(p);
+
   return true;
 }
 
+bool
+CImportObj::
+parseVertexNormal(std::string_view line)
+{
+  double r[3];
+
+  if (! decodeVertexNormal(line, r))
+    return false;
+
+  currentObject_->addNormal(CVector3D(r[0], r[1], r[2]));
+
+  return true;
+}
+
+bool
+CImportObj::
+parseFace(std::string_view line)
+{
+  faceVertices_     .clear();
+  faceTexturePoints_.clear();
+  faceNormals_      .clear();
+
+  // relative indices are from end of file data read so far (all objects)
+  auto nv = long(vnum_);
+  auto nt = long(vtnum_);
+  auto nn = long(vnnum_);
+
+  auto rc = decodeFace(line, [&](long num1, long num2, long num3) {
+    if (num1 < 0)
+      num1 += nv + 1;
+
+    if (num1 <= 0)
+      return false;
+
+    faceVertices_.push_back(uint(num1 - 1));
+
+    if (num2 != 0) {
+      if (num2 < 0)
+        num2 += nt + 1;
+
+      if (num2 <= 0)
+        return false;
+    }
+
+    if (num3 != 0) {
+      if (num3 < 0)
+        num3 += nn + 1;
+
+      if (num3 <= 0)
+        return false;
+    }
+
+    faceTexturePoints_.push_back(num2 - 1);
+    faceNormals_      .push_back(num3 - 1);
+
+    return true;
+  });
+
+  if (! rc)
+    return false;
+
+  return addFace();
+}
+
 bool
 CImportObj::
 readVertex(const std::string &line)
@@ -346,17 +1221,18 @@ bool
 CImportObj::
 readFace(const std::string &line)
 {
-  std::vector<uint> vertices;
-  std::vector<long> texturePoints;
-  std::vector<long> normals;
+  faceVertices_     .clear();
+  faceTexturePoints_.clear();
+  faceNormals_      .clear();
 
   std::vector<std::string> words;
 
   CStrUtil::addWords(line, words);
 
-  auto nv = currentObject_->getNumVertices();
-  auto nt = currentObject_->getNumTextuePoints();
-  auto nn = currentObject_->getNumNormals();
+  // relative indices are from end of file data read so far (all objects)
+  auto nv = long(vnum_);
+  auto nt = long(vtnum_);
+  auto nn = long(vnnum_);
 
   auto num_words = words.size();
 
@@ -380,7 +1256,7 @@ readFace(const std::string &line)
       num1 += nv + 1;
 
     if (num1 > 0)
-      vertices.push_back(uint(num1 - 1));
+      faceVertices_.push_back(uint(num1 - 1));
     else
       assert(false);
 
@@ -397,12 +1273,12 @@ readFace(const std::string &line)
         num2 += nt + 1;
 
       if (num2 > 0)
-        texturePoints.push_back(long(num2 - 1));
+        faceTexturePoints_.push_back(long(num2 - 1));
       else
         assert(false);
     }
     else
-      texturePoints.push_back(-1);
+      faceTexturePoints_.push_back(-1);
 
     //---
 
@@ -417,22 +1293,92 @@ readFace(const std::string &line)
         num3 += nn + 1;
 
       if (num3 > 0)
-        normals.push_back(long(num3 - 1));
+        faceNormals_.push_back(long(num3 - 1));
       else
         assert(false);
     }
     else
-      normals.push_back(-1);
+      faceNormals_.push_back(-1);
   }
 
-  //---
+  return addFace();
+}
 
-  std::vector<uint> vertices1;
+void
+CImportObj::
+setObjectName(const std::string &name)
+{
+  if      (numObjects_ == 0) {
+    currentObject_->setName(name);
+  }
+  else if (numObjects_ == 1) {
+    // add current object to new root object
+    object_ = CGeometry3DInst->createObject3D(scene_, "scene");
+
+    scene_->addObject(object_);
 
-  for (auto &v : vertices)
-    vertices1.push_back(v - voffset_);
+    pobject_.release();
 
-  auto faceNum = currentObject_->addFace(vertices1);
+    pobject_ = ObjectP(object_);
+
+    object_->addChild(currentObject_); // add current as child
+
+    // add new object to root object
+    currentObject_ = CGeometry3DInst->createObject3D(scene_, name);
+
+    scene_->addObject(currentObject_);
+
+    object_->addChild(currentObject_);
+  }
+  else {
+    // add new object to root object
+    currentObject_ = CGeometry3DInst->createObject3D(scene_, name);
+
+    scene_->addObject(currentObject_);
+
+    object_->addChild(currentObject_);
+  }
+
+  voffset_  = vnum_ ;
+  vnoffset_ = vnnum_;
+  vtoffset_ = vtnum_;
+
+  ++numObjects_;
+}
+
+void
+CImportObj::
+useMaterial(const std::string &name)
+{
+  auto pm = materials_.find(name);
+
+  if (pm == materials_.end()) {
+    warning("Invalid material name");
+
+    material_ = addMaterial(name);
+  }
+  else
+    material_ = (*pm).second;
+
+  // queue decode of maps used by faces (see addFace)
+  for (auto *map : { &material_->diffuseMap, &material_->bumpMap,
+                     &material_->specularMap, &material_->emissiveMap }) {
+    if (! map->name.empty() && ! map->image)
+      imageCache_.prefetch(map->id);
+  }
+}
+
+// add face from current face vertex, texture point and normal indices
+bool
+CImportObj::
+addFace()
+{
+  faceVertices1_.clear();
+
+  for (auto &v : faceVertices_)
+    faceVertices1_.push_back(v - voffset_);
+
+  auto faceNum = currentObject_->addFace(faceVertices1_);
 
   auto *face = currentObject_->getFaceP(faceNum);
 
@@ -446,22 +1392,22 @@ readFace(const std::string &line)
 
   //---
 
-  auto ntp = texturePoints.size();
-  auto nn1 = normals.size();
+  auto ntp = faceTexturePoints_.size();
+  auto nn1 = faceNormals_.size();
 
   assert(ntp == nn1);
 
-  std::vector<CPoint2D>  texturePoints1;
-  std::vector<CVector3D> normals1;
+  faceTexturePoints1_.clear();
+  faceNormals1_      .clear();
 
   for (size_t i = 0; i < ntp; ++i) {
-    assert(int(vertices[i]) >= voffset_);
+    assert(int(faceVertices_[i]) >= voffset_);
 
-    auto ind = vertices[i] - voffset_;
+    auto ind = faceVertices_[i] - voffset_;
 
     auto &v = currentObject_->getVertex(ind);
 
-    auto ti = texturePoints[i];
+    auto ti = faceTexturePoints_[i];
 
     if (ti >= 0) {
       ti -= vtoffset_;
@@ -470,18 +1416,18 @@ readFace(const std::string &line)
 
       auto p1 = CPoint2D(p.x, p.y);
 
-      texturePoints1.push_back(p1);
+      faceTexturePoints1_.push_back(p1);
 
       v.setTextureMap(p1);
     }
 
-    auto ni = normals[i];
+    auto ni = faceNormals_[i];
     if (ni >= 0) {
       ni -= vnoffset_;
 
       const auto &n = currentObject_->normal(uint(ni));
 
-      normals1.push_back(n);
+      faceNormals1_.push_back(n);
 
       v.setNormal(n);
     }
@@ -511,13 +1457,23 @@ readFace(const std::string &line)
     if (material_->specularColor)
       material->setSpecular(*material_->specularColor);
 
-    auto getTexture = [&](const std::string &name, CImagePtr &image) {
-      auto *texture = pscene_->getTextureByName(name);
+    auto getTexture = [&](MapImage &map) {
+      auto *texture = pscene_->getTextureByName(map.name);
 
       if (! texture) {
-        texture = CGeometry3DInst->createTexture(image);
+        // decode image on first use
+        if (! map.image)
+          map.image = imageCache_.image(map.id);
+
+        if (! map.image) {
+          error("Failed to read image '" + map.name + "'");
+          map.name.clear();
+          return texture;
+        }
+
+        texture = CGeometry3DInst->createTexture(map.image);
 
-        texture->setName(name);
+        texture->setName(map.name);
 
         pscene_->addTexture(texture);
       }
@@ -526,28 +1482,28 @@ readFace(const std::string &line)
     };
 
     if (! material_->diffuseMap.name.empty()) {
-      auto *texture = getTexture(material_->diffuseMap.name, material_->diffuseMap.image);
+      auto *texture = getTexture(material_->diffuseMap);
 
       material->setDiffuseTexture(texture);
       face    ->setDiffuseTexture(texture);
     }
 
     if (! material_->bumpMap.name.empty()) {
-      auto *texture = getTexture(material_->bumpMap.name, material_->bumpMap.image);
+      auto *texture = getTexture(material_->bumpMap);
 
       material->setNormalTexture(texture);
       face    ->setNormalTexture(texture);
     }
 
     if (! material_->specularMap.name.empty()) {
-      auto *texture = getTexture(material_->specularMap.name, material_->specularMap.image);
+      auto *texture = getTexture(material_->specularMap);
 
       material->setSpecularTexture(texture);
       face    ->setSpecularTexture(texture);
     }
 
     if (! material_->emissiveMap.name.empty()) {
-      auto *texture = getTexture(material_->emissiveMap.name, material_->emissiveMap.image);
+      auto *texture = getTexture(material_->emissiveMap);
 
       material->setEmissiveTexture(texture);
       face    ->setEmissiveTexture(texture);
@@ -561,11 +1517,11 @@ readFace(const std::string &line)
 
   //---
 
-  if (texturePoints1.size() == ntp)
-    face->setTexturePoints(texturePoints1);
+  if (faceTexturePoints1_.size() == ntp)
+    face->setTexturePoints(faceTexturePoints1_);
 
-  if (normals1.size() == nn1)
-    face->setVertexNormals(normals1);
+  if (faceNormals1_.size() == nn1)
+    face->setVertexNormals(faceNormals1_);
 
   return true;
 }
@@ -670,16 +1626,8 @@ readMaterialFile(const std::string &filename)
 
       CFile imageFile(imageFilename);
 
-      if (imageFile.exists()) {
-        CImageFileSrc src(imageFile);
-
-        auto image = CImageMgrInst->createImage(src);
-
-        image = image->flippedH();
-
-        material->emissiveMap.image = image;
-        material->emissiveMap.name  = imageFilename;
-      }
+      if (imageFile.exists())
+        setMapImage(material->emissiveMap, imageFilename);
       else
         error("Invalid file for map_Ke");
     }
@@ -750,16 +1698,8 @@ readMaterialFile(const std::string &filename)
 
       CFile imageFile(imageFilename);
 
-      if (imageFile.exists()) {
-        CImageFileSrc src(imageFile);
-
-        auto image = CImageMgrInst->createImage(src);
-
-        image = image->flippedH();
-
-        material->ambientMap.image = image;
-        material->ambientMap.name  = imageFilename;
-      }
+      if (imageFile.exists())
+        setMapImage(material->ambientMap, imageFilename);
       else
         error("Invalid file '" + imageFilename + "' for map_Ka");
     }
@@ -769,16 +1709,8 @@ readMaterialFile(const std::string &filename)
 
       CFile imageFile(imageFilename);
 
-      if (imageFile.exists()) {
-        CImageFileSrc src(imageFile);
-
-        auto image = CImageMgrInst->createImage(src);
-
-        image = image->flippedH();
-
-        material->diffuseMap.image = image;
-        material->diffuseMap.name  = imageFilename;
-      }
+      if (imageFile.exists())
+        setMapImage(material->diffuseMap, imageFilename);
       else
         error("Invalid file for map_Kd");
     }
@@ -788,16 +1720,8 @@ readMaterialFile(const std::string &filename)
 
       CFile imageFile(imageFilename);
 
-      if (imageFile.exists()) {
-        CImageFileSrc src(imageFile);
-
-        auto image = CImageMgrInst->createImage(src);
-
-        image = image->flippedH();
-
-        material->specularMap.image = image;
-        material->specularMap.name  = imageFilename;
-      }
+      if (imageFile.exists())
+        setMapImage(material->specularMap, imageFilename);
       else
         error("Invalid file for map_Ks");
     }
@@ -813,16 +1737,8 @@ readMaterialFile(const std::string &filename)
 
       CFile imageFile(imageFilename);
 
-      if (imageFile.exists()) {
-        CImageFileSrc src(imageFile);
-
-        auto image = CImageMgrInst->createImage(src);
-
-        image = image->flippedH();
-
-        material->bumpMap.image = image;
-        material->bumpMap.name  = imageFilename;
-      }
+      if (imageFile.exists())
+        setMapImage(material->bumpMap, imageFilename);
       else
         error("Invalid file for map_Bump");
     }
@@ -839,16 +1755,8 @@ readMaterialFile(const std::string &filename)
 
       CFile imageFile(imageFilename);
 
-      if (imageFile.exists()) {
-        CImageFileSrc src(imageFile);
-
-        auto image = CImageMgrInst->createImage(src);
-
-        image = image->flippedH();
-
-        material->metallicMap.image = image;
-        material->metallicMap.name  = imageFilename;
-      }
+      if (imageFile.exists())
+        setMapImage(material->metallicMap, imageFilename);
       else
         error("Invalid file for map_Pm");
     }
@@ -865,16 +1773,8 @@ readMaterialFile(const std::string &filename)
 
       CFile imageFile(imageFilename);
 
-      if (imageFile.exists()) {
-        CImageFileSrc src(imageFile);
-
-        auto image = CImageMgrInst->createImage(src);
-
-        image = image->flippedH();
-
-        material->roughnessMap.image = image;
-        material->roughnessMap.name  = imageFilename;
-      }
+      if (imageFile.exists())
+        setMapImage(material->roughnessMap, imageFilename);
       else
         error("Invalid file for map_Pr");
     }
@@ -957,6 +1857,16 @@ readMaterialFile(const std::string &filename)
   return true;
 }
 
+// record material map image (decoded on first use)
+void
+CImportObj::
+setMapImage(MapImage &map, const std::string &filename)
+{
+  map.name  = filename;
+  map.image = CImagePtr();
+  map.id    = imageCache_.addFile(filename, /*flipH*/true);
+}
+
 CImportObj::Material *
 CImportObj::
 addMaterial(const std::string &name)
@@ -1,5 +1,11 @@
 #include <CImportPly.h>
 #include <CGeometry3D.h>
+#include <CImportMapFile.h>
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
 
 namespace {
 
@@ -44,10 +50,213 @@ bool readLine(CFile *file, Line &line) {
   return true;
 }
 
+bool isHostBigEndian() {
+  const ushort i = 1;
+
+  uchar c;
+
+  memcpy(&c, &i, 1);
+
+  return (c == 0);
+}
+
+size_t formatSize(CImportPly::FormatType type) {
+  using FormatType = CImportPly::FormatType;
+
+  switch (type) {
+    case FormatType::CHAR  : return 1;
+    case FormatType::UCHAR : return 1;
+    case FormatType::SHORT : return 2;
+    case FormatType::USHORT: return 2;
+    case FormatType::INT   : return 4;
+    case FormatType::UINT  : return 4;
+    case FormatType::FLOAT : return 4;
+    case FormatType::DOUBLE: return 8;
+    default                : return 0;
+  }
+}
+
+// load (unaligned) value optionally swapping byte order
+template<typename T>
+T loadValue(const uchar *p, bool swap) {
+  T v;
+
+  if (swap) {
+    uchar b[sizeof(T)];
+
+    for (size_t i = 0; i < sizeof(T); ++i)
+      b[i] = p[sizeof(T) - 1 - i];
+
+    memcpy(&v, b, sizeof(T));
+  }
+  else
+    memcpy(&v, p, sizeof(T));
+
+  return v;
+}
+
+double loadReal(const uchar *p, CImportPly::FormatType type, bool swap) {
+  using FormatType = CImportPly::FormatType;
+
+  switch (type) {
+    case FormatType::CHAR  : return double(loadValue<int8_t  >(p, swap));
+    case FormatType::UCHAR : return double(loadValue<uint8_t >(p, swap));
+    case FormatType::SHORT : return double(loadValue<int16_t >(p, swap));
+    case FormatType::USHORT: return double(loadValue<uint16_t>(p, swap));
+    case FormatType::INT   : return double(loadValue<int32_t >(p, swap));
+    case FormatType::UINT  : return double(loadValue<uint32_t>(p, swap));
+    case FormatType::FLOAT : return double(loadValue<float   >(p, swap));
+    case FormatType::DOUBLE: return double(loadValue<double  >(p, swap));
+    default                : return 0.0;
+  }
+}
+
+// decode strided column of n values to packed floats
+template<typename T>
+void decodeColumn(const uchar *p, size_t stride, size_t n, bool swap, float scale, float *out) {
+  if (swap) {
+    for (size_t i = 0; i < n; ++i, p += stride)
+      out[i] = float(loadValue<T>(p, true))*scale;
+  }
+  else if (scale == 1.0f) {
+    for (size_t i = 0; i < n; ++i, p += stride)
+      out[i] = float(loadValue<T>(p, false));
+  }
+  else {
+    for (size_t i = 0; i < n; ++i, p += stride)
+      out[i] = float(loadValue<T>(p, false))*scale;
+  }
+}
+
+void decodeColumn(CImportPly::FormatType type, const uchar *p, size_t stride, size_t n,
+                  bool swap, float scale, float *out) {
+  using FormatType = CImportPly::FormatType;
+
+  switch (type) {
+    case FormatType::CHAR  : decodeColumn<int8_t  >(p, stride, n, swap, scale, out); break;
+    case FormatType::UCHAR : decodeColumn<uint8_t >(p, stride, n, swap, scale, out); break;
+    case FormatType::SHORT : decodeColumn<int16_t >(p, stride, n, swap, scale, out); break;
+    case FormatType::USHORT: decodeColumn<uint16_t>(p, stride, n, swap, scale, out); break;
+    case FormatType::INT   : decodeColumn<int32_t >(p, stride, n, swap, scale, out); break;
+    case FormatType::UINT  : decodeColumn<uint32_t>(p, stride, n, swap, scale, out); break;
+    case FormatType::FLOAT : decodeColumn<float   >(p, stride, n, swap, scale, out); break;
+    case FormatType::DOUBLE: decodeColumn<double  >(p, stride, n, swap, scale, out); break;
+    default: break;
+  }
+}
+
 }
 
 //---
 
+// voxel grid point decimation (keeps first point in each occupied voxel)
+//
+// When a max point count is set the voxel size is doubled (and the kept points
+// re-binned) whenever it is exceeded so memory use stays bounded.
+class CImportPly::VoxelGrid {
+ public:
+  VoxelGrid(double size, size_t maxPoints) :
+   size_(size), maxPoints_(maxPoints) {
+  }
+
+  double voxelSize() const { return size_; }
+
+  VertexData &points() { return points_; }
+
+  void add(const VertexData &vertices) {
+    if (vertices.size == 0)
+      return;
+
+    if (! init_) {
+      for (int c = 0; c < VertexData::NUM_CHANNELS; ++c)
+        points_.has[c] = vertices.has[c];
+
+      if (size_ <= 0.0)
+        size_ = estimateSize(vertices);
+
+      init_ = true;
+    }
+
+    for (size_t i = 0; i < vertices.size; ++i) {
+      if (! cells_.emplace(cellKey(vertices, i), points_.size).second)
+        continue;
+
+      points_.append(vertices, i);
+
+      if (maxPoints_ > 0 && points_.size > maxPoints_)
+        coarsen();
+    }
+  }
+
+ private:
+  // initial size from first batch extent assuming points fill bounding box surface
+  double estimateSize(const VertexData &vertices) const {
+    double extent = 0.0;
+
+    for (int c = VertexData::X; c <= VertexData::Z; ++c) {
+      if (! vertices.has[c])
+        continue;
+
+      auto mm = std::minmax_element(vertices.channels[c].begin(), vertices.channels[c].end());
+
+      extent = std::max(extent, double(*mm.second - *mm.first));
+    }
+
+    if (extent <= 0.0)
+      return 1.0;
+
+    return extent/std::sqrt(double(std::max(maxPoints_, size_t(1))));
+  }
+
+  uint64_t cellKey(const VertexData &vertices, size_t i) const {
+    static const double maxCell = double(1 << 20);
+
+    auto coord = [&](int c) {
+      if (! vertices.has[c])
+        return uint64_t(0);
+
+      auto r = std::floor(double(vertices.channels[c][i])/size_);
+
+      r = std::min(std::max(r, -maxCell), maxCell - 1);
+
+      return uint64_t(int64_t(r) + int64_t(maxCell));
+    };
+
+    return coord(VertexData::X) | (coord(VertexData::Y) << 21) | (coord(VertexData::Z) << 42);
+  }
+
+  void coarsen() {
+    while (points_.size > maxPoints_) {
+      size_ *= 2.0;
+
+      VertexData points;
+
+      for (int c = 0; c < VertexData::NUM_CHANNELS; ++c)
+        points.has[c] = points_.has[c];
+
+      cells_.clear();
+
+      for (size_t i = 0; i < points_.size; ++i) {
+        if (cells_.emplace(cellKey(points_, i), points.size).second)
+          points.append(points_, i);
+      }
+
+      points_ = std::move(points);
+    }
+  }
+
+ private:
+  using Cells = std::unordered_map<uint64_t, size_t>;
+
+  double     size_      { 0.0 };
+  size_t     maxPoints_ { 0 };
+  bool       init_      { false };
+  Cells      cells_;
+  VertexData points_;
+};
+
+//---
+
 bool
 CImportPly::
 stringToFormat(const std::string &format, FormatType &formatType)
@@ -60,9 +269,9 @@ stringToFormat(const std::string &format, FormatType &formatType)
     formatType = FormatType::SHORT;
   else if (format == "ushort" || format == "uint16")
     formatType = FormatType::USHORT;
-  else if (format == "int"    || format == "int3s")
+  else if (format == "int"    || format == "int32" || format == "int3s")
     formatType = FormatType::INT;
-  else if (format == "uint"   || format == "uint3s")
+  else if (format == "uint"   || format == "uint32" || format == "uint3s")
     formatType = FormatType::UINT;
   else if (format == "float"  || format == "float32")
     formatType = FormatType::FLOAT;
@@ -102,8 +311,114 @@ read(CFile &file)
 {
   file_ = &file;
 
+  if (! readHeader())
+    return false;
+
+  vertices_.clear();
+  faces_   .clear();
+
+  texturePoints_.clear();
+  textureFaces_ .clear();
+
+  if (isDecimate()) {
+    // stream batches into voxel grid (faces are dropped)
+    VoxelGrid grid(decimateVoxelSize_, decimateMaxPoints_);
+
+    struct DecimateProc : public StreamProc {
+      DecimateProc(VoxelGrid &grid) : grid(grid) { }
+
+      bool vertices(VertexData &vertices, size_t) override {
+        grid.add(vertices);
+        return true;
+      }
+
+      VoxelGrid &grid;
+    };
+
+    DecimateProc proc(grid);
+
+    if (! readElements(proc, batchSize_, /*map*/true))
+      return false;
+
+    if (isDebug())
+      std::cerr << "Decimated to " << grid.points().size << " points (voxel size " <<
+                   grid.voxelSize() << ")\n";
+
+    vertices_ = std::move(grid.points());
+
+    textureFaces_.clear();
+  }
+  else {
+    // read all elements in one batch
+    struct CollectProc : public StreamProc {
+      CollectProc(VertexData &vertices, FaceData &faces) :
+       vertices_(vertices), faces_(faces) {
+      }
+
+      bool vertices(VertexData &vertices, size_t first) override {
+        if (first == 0)
+          vertices_ = std::move(vertices);
+        else
+          vertices_.append(vertices);
+
+        return true;
+      }
+
+      bool faces(FaceData &faces, size_t first) override {
+        if (first == 0)
+          faces_ = std::move(faces);
+        else
+          faces_.append(faces);
+
+        return true;
+      }
+
+      VertexData &vertices_;
+      FaceData   &faces_;
+    };
+
+    CollectProc proc(vertices_, faces_);
+
+    if (! readElements(proc, std::numeric_limits<size_t>::max(), isMapFile()))
+      return false;
+  }
+
   //---
 
+  buildObject();
+
+  return true;
+}
+
+bool
+CImportPly::
+readStream(CFile &file, StreamProc &proc)
+{
+  file_ = &file;
+
+  if (! readHeader())
+    return false;
+
+  texturePoints_.clear();
+  textureFaces_ .clear();
+
+  return readElements(proc, batchSize_, /*map*/true);
+}
+
+bool
+CImportPly::
+readElements(StreamProc &proc, size_t batchSize, bool map)
+{
+  if (ascii_)
+    return readAscii(proc, batchSize);
+  else
+    return readBinary(proc, batchSize, map);
+}
+
+bool
+CImportPly::
+readHeader()
+{
   Line line;
 
   if (! readLine(file_, line) || line.line != "ply") {
@@ -114,10 +429,14 @@ read(CFile &file)
   std::string elementName;
 
   bool in_header = true;
-  bool ascii     = false;
 
+  ascii_      = false;
   big_endian_ = false;
 
+  elementNames_     .clear();
+  elementCount_     .clear();
+  elementProperties_.clear();
+
   while (readLine(file_, line)) {
     std::string word;
 
@@ -130,13 +449,13 @@ read(CFile &file)
 
         if (line.getWord(word1)) {
           if      (word1 == "ascii")
-            ascii = true;
+            ascii_ = true;
           else if (word1 == "binary_little_endian") {
-            ascii       = false;
+            ascii_      = false;
             big_endian_ = false;
           }
           else if (word1 == "binary_big_endian") {
-            ascii       = false;
+            ascii_      = false;
             big_endian_ = true;
           }
           else {
@@ -225,20 +544,12 @@ read(CFile &file)
               return false;
             }
 
-            if      (format == FormatType::UCHAR ||
-                     format == FormatType::UINT  ||
-                     format == FormatType::FLOAT) {
-              std::string name;
+            std::string name;
 
-              if (line.getWord(name)) {
-                //std::cerr << "      " << name << "\n";
+            if (line.getWord(name)) {
+              //std::cerr << "      " << name << "\n";
 
-                properties.emplace_back(name, type, format);
-              }
-            }
-            else {
-              std::cerr << "Unhandled property format : " << type << "\n";
-              return false;
+              properties.emplace_back(name, type, format);
             }
           }
         }
@@ -259,185 +570,136 @@ read(CFile &file)
     return false;
   }
 
-  bool rc;
-
-  if (ascii)
-    rc = readAscii();
-  else
-    rc = readBinary();
-
-  return rc;
+  return compilePlans();
 }
 
+
 bool
 CImportPly::
-readAscii()
+readAscii(StreamProc &proc, size_t batchSize)
 {
-  const auto &vertexProperties = getElementProperties("vertex");
-
-  auto numVertexProperties = vertexProperties.size();
+  const ElementPlan *vertexPlan = nullptr;
 
-#if 0
-  for (const auto &p : vertexProperties) {
-    std::cerr << "V: " << p.name << " : " << p.type << "\n";
+  for (const auto &plan : plans_) {
+    if (plan.type == ElementType::VERTEX)
+      vertexPlan = &plan;
   }
-#endif
 
-#if 0
-  const auto &faceProperties = getElementProperties("face");
-
-  for (const auto &p : faceProperties) {
-    std::cerr << "F: " << p.name << " : " << p.type << "\n";
-  }
-#endif
-
-  auto num_vertices = elementCount_["vertex"];
+  auto num_vertices = size_t(std::max(elementCount_["vertex"], 0));
 
   //std::cerr << "num_vertices: " << num_vertices << "\n";
 
-  for (int i = 0; i < num_vertices; ++i) {
-    Line line1;
+  if (! vertexPlan && num_vertices > 0) {
+    std::cerr << "Missing vertex element\n";
+    return false;
+  }
 
-    if (! readLine(file_, line1)) {
-      std::cerr << "Missing vertex line\n";
-      return false;
+  VertexData vertices;
+
+  if (vertexPlan) {
+    for (const auto &p : vertexPlan->props) {
+      if (p.target >= 0 && p.target < VertexData::NUM_CHANNELS)
+        vertices.has[p.target] = true;
     }
+  }
 
-    std::vector<std::string> words;
+  std::vector<std::string> words;
 
-    std::string word1;
+  for (size_t first = 0; first < num_vertices; first += batchSize) {
+    auto n = std::min(batchSize, num_vertices - first);
 
-    while (line1.getWord(word1))
-      words.push_back(word1);
+    vertices.resize(n);
 
-    if (words.size() != numVertexProperties) {
-      std::cerr << "Bad vertex properties: " <<
-        words.size() << " != " << numVertexProperties << "\n";
-      return false;
-    }
+    for (size_t i = 0; i < n; ++i) {
+      Line line1;
 
-    Vertex v;
-
-    int iw = 0;
-
-    for (const auto &p : vertexProperties) {
-      const auto &word = words[iw++];
-
-      if      (p.name == "x")
-        v.x = std::stod(word);
-      else if (p.name == "y")
-        v.y = std::stod(word);
-      else if (p.name == "z")
-        v.z = std::stod(word);
-      else if (p.name == "r" || p.name == "red")
-        v.r = std::stod(word);
-      else if (p.name == "g" || p.name == "green")
-        v.g = std::stod(word);
-      else if (p.name == "b" || p.name == "blue")
-        v.b = std::stod(word);
-      else if (p.name == "a" || p.name == "alpha")
-        v.a = std::stod(word);
-      else if (p.name == "nx")
-        v.nx = std::stod(word);
-      else if (p.name == "ny")
-        v.ny = std::stod(word);
-      else if (p.name == "nz")
-        v.nz = std::stod(word);
-      else if (p.name == "s" || p.name == "u")
-        v.s = std::stod(word);
-      else if (p.name == "t" || p.name == "v")
-        v.t = std::stod(word);
-      else {
-        std::cerr << "Bad vertex name : " << p.name << "\n";
+      if (! readLine(file_, line1)) {
+        std::cerr << "Missing vertex line\n";
         return false;
       }
-    }
 
-    vertices_.push_back(v);
-  }
+      words.clear();
 
-  //---
+      std::string word1;
 
-  auto num_faces = elementCount_["face"];
+      while (line1.getWord(word1))
+        words.push_back(word1);
 
-  //std::cerr << "num_faces: " << num_faces << "\n";
+      if (words.size() != vertexPlan->props.size()) {
+        std::cerr << "Bad vertex properties: " <<
+          words.size() << " != " << vertexPlan->props.size() << "\n";
+        return false;
+      }
 
-  for (int i = 0; i < num_faces; ++i) {
-    Line line1;
+      int iw = 0;
 
-    if (! readLine(file_, line1)) {
-      std::cerr << "Missing face line\n";
-      return false;
+      for (const auto &p : vertexPlan->props) {
+        const auto &word = words[iw++];
+
+        if (p.target >= 0 && p.target < VertexData::NUM_CHANNELS)
+          vertices.channels[p.target][i] = float(std::stod(word))*p.scale;
+      }
     }
 
-    // TODO: face properties ?
+    if (! proc.vertices(vertices, first))
+      return false;
+  }
 
-    std::string word1;
+  //---
 
-    if (! line1.getWord(word1)) {
-      std::cerr << "Bad face line: " << line1.line << "\n";
-      return false;
-    }
+  auto num_faces = size_t(std::max(elementCount_["face"], 0));
 
-    int ni = std::stoi(word1);
+  //std::cerr << "num_faces: " << num_faces << "\n";
 
-    std::vector<std::string> words;
+  FaceData faces;
 
-    while (line1.getWord(word1))
-      words.push_back(word1);
+  for (size_t first = 0; first < num_faces; first += batchSize) {
+    auto n = std::min(batchSize, num_faces - first);
 
-    if (int(words.size()) != ni) {
-      std::cerr << "Bad face line: " << line1.line << "\n";
-      return false;
-    }
+    faces.clear();
 
-    Face f;
+    faces.starts.reserve(n);
 
-    for (const auto &w : words) {
-      int vi = std::stoi(w);
+    for (size_t i = 0; i < n; ++i) {
+      Line line1;
 
-      if (vi < 0 || vi >= num_vertices) {
-        std::cerr << "Bad vertex index: " << vi << "\n";
+      if (! readLine(file_, line1)) {
+        std::cerr << "Missing face line\n";
         return false;
       }
 
-      f.inds.push_back(vi);
-    }
-
-    faces_.push_back(f);
-  }
-
-  //---
-
-  int i = 0;
+      // TODO: face properties ?
 
-  for (const auto &v : vertices_) {
-    int i1 = object_->addVertex(CPoint3D(v.x, v.y, v.z));
-    assert(i == i1);
+      std::string word1;
 
-    double a = v.a;
-
-    if (a < 0.0)
-      a = 1.0;
+      if (! line1.getWord(word1)) {
+        std::cerr << "Bad face line: " << line1.line << "\n";
+        return false;
+      }
 
-    object_->setVertexColor(i, CRGBA(v.r, v.g, v.b, a));
+      int ni = std::stoi(word1);
 
-    object_->setVertexNormal(i, CVector3D(v.nx, v.ny, v.nz));
+      faces.starts.push_back(faces.inds.size());
 
-    object_->setVertexTextureMap(i, CPoint2D(v.s, v.t));
+      while (line1.getWord(word1)) {
+        int vi = std::stoi(word1);
 
-    ++i;
-  }
+        if (vi < 0 || size_t(vi) >= num_vertices) {
+          std::cerr << "Bad vertex index: " << vi << "\n";
+          return false;
+        }
 
-  for (const auto &f : faces_) {
-    auto ni = f.inds.size();
+        faces.inds.push_back(vi);
+      }
 
-    if (ni != 3) {
-      std::cerr << "Invalid face vertex count\n";
-      continue;
+      if (int(faces.numInds(faces.size() - 1)) != ni) {
+        std::cerr << "Bad face line: " << line1.line << "\n";
+        return false;
+      }
     }
 
-    (void) object_->addITriangle(f.inds[0], f.inds[1], f.inds[2]);
+    if (! proc.faces(faces, first))
+      return false;
   }
 
   return true;
@@ -445,341 +707,470 @@ readAscii()
 
 bool
 CImportPly::
-readBinary()
+readBinary(StreamProc &proc, size_t batchSize, bool map)
 {
-  const auto &vertexProperties = getElementProperties("vertex");
+  // decode elements in bulk from mapped (or single read) file data
+  CImportMapFile mapFile;
 
-#if 0
-  for (const auto &p : vertexProperties) {
-    std::cerr << "V: " << p.name << " : " << p.type << "\n";
-  }
-#endif
+  if (! mapFile.open(file_->getPath(), map))
+    return false;
 
-  auto num_vertices = elementCount_["vertex"];
-//std::cerr << "num_vertices: " << num_vertices << "\n";
+  auto view = mapFile.view();
 
-  for (int i = 0; i < num_vertices; ++i) {
-    Vertex v;
+  auto pos = view.find("end_header");
 
-    for (const auto &p : vertexProperties) {
-      float f;
+  if (pos != std::string_view::npos)
+    pos = view.find('\n', pos);
 
-      if (p.type == FormatType::FLOAT) {
-        readFloat(&f);
-      }
-      else {
-        std::cerr << "Bad vertex format : " << p.typeStr << "\n";
-        continue;
-      }
+  if (pos == std::string_view::npos) {
+    std::cerr << "No end_header\n";
+    return false;
+  }
 
-      if      (p.name == "x")
-        v.x = f;
-      else if (p.name == "y")
-        v.y = f;
-      else if (p.name == "z")
-        v.z = f;
-      else if (p.name == "r")
-        v.r = f;
-      else if (p.name == "g")
-        v.g = f;
-      else if (p.name == "b")
-        v.b = f;
-      else if (p.name == "a")
-        v.a = f;
-      else if (p.name == "nx")
-        v.nx = f;
-      else if (p.name == "ny")
-        v.ny = f;
-      else if (p.name == "nz")
-        v.nz = f;
-      else if (p.name == "s" || p.name == "u")
-        v.s = f;
-      else if (p.name == "t" || p.name == "v")
-        v.t = f;
-      else {
-        std::cerr << "Bad vertex name : " << p.name << "\n";
+  const uchar *start = mapFile.data();
+  const uchar *data  = start + pos + 1;
+  const uchar *end   = start + mapFile.size();
+
+  // drop decoded pages from mapping so resident memory stays bounded
+  auto releaseData = [&]() {
+    mapFile.releaseTo(size_t(data - start));
+  };
+
+  for (const auto &plan : plans_) {
+    if      (plan.type == ElementType::VERTEX && plan.stride > 0) {
+      if (plan.count > size_t(end - data)/plan.stride) {
+        std::cerr << "Truncated element data: " << plan.name << "\n";
         return false;
       }
-    }
 
-    vertices_.push_back(v);
-  }
+      VertexData vertices;
 
-  //---
+      for (size_t first = 0; first < plan.count; first += batchSize) {
+        auto n = std::min(batchSize, plan.count - first);
 
-#if 0
-  const auto &faceProperties = getElementProperties("face");
+        if (! decodeVertices(plan, data, n, vertices))
+          return false;
 
-  for (const auto &p : faceProperties) {
-    std::cerr << "F: " << p.name << " : " << p.type << "\n";
-  }
-#endif
+        data += n*plan.stride;
+
+        if (! proc.vertices(vertices, first))
+          return false;
+
+        releaseData();
+      }
+    }
+    else if (plan.type == ElementType::FACE && plan.stride == 0) {
+      FaceData faces;
+
+      for (size_t first = 0; first < plan.count; first += batchSize) {
+        auto n = std::min(batchSize, plan.count - first);
 
-  auto num_faces = elementCount_["face"];
-//std::cerr << "num_faces: " << num_faces << "\n";
+        faces.clear();
 
-  for (int i = 0; i < num_faces; ++i) {
-    // TODO: face properties ?
+        size_t len = 0;
 
-    uchar ni;
-    readUChar(&ni);
+        if (! decodeVariable(plan, data, end, n, len, faces))
+          return false;
 
-    Face f;
+        data += len;
 
-    for (int i1 = 0; i1 < ni; ++i1) {
-      int vi;
-      readInt(&vi);
+        if (! proc.faces(faces, first))
+          return false;
 
-      if (vi < 0 || vi >= num_vertices) {
-        std::cerr << "Bad vertex index: " << vi << "\n";
+        releaseData();
+      }
+    }
+    else if (plan.stride > 0) {
+      if (plan.count > size_t(end - data)/plan.stride) {
+        std::cerr << "Truncated element data: " << plan.name << "\n";
         return false;
       }
 
-      f.inds.push_back(vi);
+      if (! decodeFixed(plan, data, plan.count))
+        return false;
+
+      data += plan.count*plan.stride;
     }
+    else {
+      FaceData faces;
+
+      size_t len = 0;
 
-    faces_.push_back(f);
+      if (! decodeVariable(plan, data, end, plan.count, len, faces))
+        return false;
+
+      data += len;
+    }
   }
 
-  //---
+  return true;
+}
 
-  auto num_texture_vertices = elementCount_["multi_texture_vertex"];
+CImportPly::Properties &
+CImportPly::
+getElementProperties(const std::string &name)
+{
+  auto pe = elementProperties_.find(name);
 
-  for (int i = 0; i < num_texture_vertices; ++i) {
-    // TODO: properties ?
+  if (pe == elementProperties_.end())
+    pe = elementProperties_.insert(pe, ElementProperties::value_type(name, Properties()));
 
-    TexturePoint tp;
+  return (*pe).second;
+}
 
-    readUChar(&tp.tx);
-    readFloat(&tp.u);
-    readFloat(&tp.v);
+// compile header elements into decode plans (property offsets, record stride,
+// value targets and byte swap)
+bool
+CImportPly::
+compilePlans()
+{
+  plans_.clear();
 
-    texturePoints_.push_back(tp);
-  }
+  swap_ = (big_endian_ != isHostBigEndian());
 
-  //---
+  auto vertexTarget = [](const std::string &name) {
+    using VD = VertexData;
 
-  auto num_texture_faces = elementCount_["multi_texture_face"];
+    if      (name == "x"                   ) return int(VD::X);
+    else if (name == "y"                   ) return int(VD::Y);
+    else if (name == "z"                   ) return int(VD::Z);
+    else if (name == "r"  || name == "red"  ) return int(VD::R);
+    else if (name == "g"  || name == "green") return int(VD::G);
+    else if (name == "b"  || name == "blue" ) return int(VD::B);
+    else if (name == "a"  || name == "alpha") return int(VD::A);
+    else if (name == "nx"                  ) return int(VD::NX);
+    else if (name == "ny"                  ) return int(VD::NY);
+    else if (name == "nz"                  ) return int(VD::NZ);
+    else if (name == "s"  || name == "u"    ) return int(VD::S);
+    else if (name == "t"  || name == "v"    ) return int(VD::T);
+    else return int(TARGET_NONE);
+  };
 
-  for (int i = 0; i < num_texture_faces; ++i) {
-    // TODO: properties ?
+  for (const auto &name : elementNames_) {
+    ElementPlan plan;
 
-    TextureFace tf;
+    plan.name  = name;
+    plan.count = size_t(std::max(elementCount_[name], 0));
 
-    readUChar(&tf.tx);
-    readUInt (&tf.tn);
+    if      (name == "vertex"              ) plan.type = ElementType::VERTEX;
+    else if (name == "face"                ) plan.type = ElementType::FACE;
+    else if (name == "multi_texture_vertex") plan.type = ElementType::TEXTURE_VERTEX;
+    else if (name == "multi_texture_face"  ) plan.type = ElementType::TEXTURE_FACE;
 
-    uchar ni;
-    readUChar(&ni);
+    size_t offset = 0;
+    bool   fixed  = true;
 
-    for (int i1 = 0; i1 < ni; ++i1) {
-      int vi;
-      readInt(&vi);
+    for (const auto &prop : getElementProperties(name)) {
+      PropertyPlan pp;
 
-      if (vi < 0 || vi >= num_texture_vertices) {
-        std::cerr << "Bad texture vertex index: " << vi << "\n";
-        return false;
-      }
+      pp.list   = prop.list;
+      pp.offset = offset;
 
-      tf.inds.push_back(vi);
-    }
+      if (prop.list) {
+        pp.countType = prop.type;
+        pp.type      = prop.type1;
 
-    textureFaces_.push_back(tf);
-  }
+        fixed = false;
+      }
+      else {
+        pp.type = prop.type;
 
-  //---
+        offset += formatSize(pp.type);
+      }
 
-  int i = 0;
+      switch (plan.type) {
+        case ElementType::VERTEX: {
+          pp.target = vertexTarget(prop.name);
 
-  for (const auto &v : vertices_) {
-    int i1 = object_->addVertex(CPoint3D(v.x, v.y, v.z));
-    assert(i == i1);
+          // vertices are decoded as fixed size records so list properties (even
+          // unused ones) are not supported
+          if (prop.list) {
+            std::cerr << "Unsupported vertex list property : " << prop.name << "\n";
+            return false;
+          }
 
-    double a = v.a;
+          if (pp.target == TARGET_NONE) {
+            if (isDebug())
+              std::cerr << "Skip vertex property : " << prop.name << "\n";
+          }
 
-    if (a < 0.0)
-      a = 1.0;
+          // integer colors are normalized to 0-1
+          if (pp.target >= VertexData::R && pp.target <= VertexData::A) {
+            if      (pp.type == FormatType::UCHAR ) pp.scale = 1.0f/255.0f;
+            else if (pp.type == FormatType::USHORT) pp.scale = 1.0f/65535.0f;
+          }
 
-    object_->setVertexColor(i, CRGBA(v.r, v.g, v.b, a));
+          break;
+        }
+        case ElementType::FACE: {
+          if (prop.list && (prop.name == "vertex_indices" || prop.name == "vertex_index"))
+            pp.target = TARGET_INDICES;
 
-    object_->setVertexNormal(i, CVector3D(v.nx, v.ny, v.nz));
+          break;
+        }
+        case ElementType::TEXTURE_VERTEX: {
+          if      (prop.name == "tx") pp.target = TARGET_TX;
+          else if (prop.name == "u" ) pp.target = TARGET_U;
+          else if (prop.name == "v" ) pp.target = TARGET_V;
 
-    object_->setVertexTextureMap(i, CPoint2D(v.s, v.t));
+          break;
+        }
+        case ElementType::TEXTURE_FACE: {
+          if      (prop.list        ) pp.target = TARGET_INDICES;
+          else if (prop.name == "tx") pp.target = TARGET_TX;
+          else if (prop.name == "tn") pp.target = TARGET_TN;
 
-    ++i;
-  }
+          break;
+        }
+        default:
+          break;
+      }
 
-  bool has_texture_points = (num_texture_faces == num_faces);
+      plan.props.push_back(pp);
+    }
 
-  i = 0;
+    plan.stride = (fixed ? offset : 0);
 
-  for (const auto &f : faces_) {
-    auto ni = f.inds.size();
+    plans_.push_back(plan);
+  }
 
-    if (ni != 3) {
-      std::cerr << "Invalid face vertex count\n";
-      continue;
-    }
+  return true;
+}
 
-    auto faceInd = object_->addITriangle(f.inds[0], f.inds[1], f.inds[2]);
+// decode n fixed size records
+bool
+CImportPly::
+decodeFixed(const ElementPlan &plan, const uchar *data, size_t n)
+{
+  if (plan.type == ElementType::TEXTURE_VERTEX) {
+    texturePoints_.resize(n);
 
-    if (has_texture_points) {
-      auto &face = object_->getFace(faceInd);
+    for (size_t i = 0; i < n; ++i) {
+      auto &tp = texturePoints_[i];
 
-      const auto &tf = textureFaces_[i];
+      const uchar *record = data + i*plan.stride;
 
-      std::vector<CPoint2D> tpoints;
+      for (const auto &p : plan.props) {
+        if (p.target == TARGET_NONE)
+          continue;
 
-      for (const auto &ti : tf.inds) {
-        const auto &tp = texturePoints_[ti];
+        auto r = loadReal(record + p.offset, p.type, swap_);
 
-        tpoints.push_back(CPoint2D(tp.u, tp.v));
+        if      (p.target == TARGET_TX) tp.tx = uchar(r);
+        else if (p.target == TARGET_U ) tp.u  = float(r);
+        else if (p.target == TARGET_V ) tp.v  = float(r);
       }
-
-      face.setTexturePoints(tpoints);
     }
-
-    ++i;
   }
 
   return true;
 }
 
-CImportPly::Properties &
+// decode n vertex records into packed channels (one strided column per property)
+bool
 CImportPly::
-getElementProperties(const std::string &name)
+decodeVertices(const ElementPlan &plan, const uchar *data, size_t n, VertexData &vertices) const
 {
-  auto pe = elementProperties_.find(name);
+  for (const auto &p : plan.props) {
+    if (p.target >= 0 && p.target < VertexData::NUM_CHANNELS)
+      vertices.has[p.target] = true;
+  }
 
-  if (pe == elementProperties_.end())
-    pe = elementProperties_.insert(pe, ElementProperties::value_type(name, Properties()));
+  vertices.resize(n);
 
-  return (*pe).second;
+  for (const auto &p : plan.props) {
+    if (p.target < 0 || p.target >= VertexData::NUM_CHANNELS)
+      continue;
+
+    decodeColumn(p.type, data + p.offset, plan.stride, n, swap_, p.scale,
+                 vertices.channels[p.target].data());
+  }
+
+  return true;
 }
 
+// decode n variable size (list) records, returns bytes used in len
 bool
 CImportPly::
-readFloat(float *f) const
+decodeVariable(const ElementPlan &plan, const uchar *data, const uchar *end,
+               size_t n, size_t &len, FaceData &faces)
 {
-  CFileData file_data(sizeof(float));
+  auto num_vertices         = size_t(std::max(elementCount_["vertex"], 0));
+  auto num_texture_vertices = size_t(std::max(elementCount_["multi_texture_vertex"], 0));
+
+  bool isFace        = (plan.type == ElementType::FACE);
+  bool isTextureFace = (plan.type == ElementType::TEXTURE_FACE);
 
-  try {
-    file_->read(&file_data);
+  if      (isFace) {
+    faces.starts.reserve(faces.starts.size() + n);
+    faces.inds  .reserve(faces.inds  .size() + 3*n);
   }
-  catch (...) {
+  else if (isTextureFace)
+    textureFaces_.reserve(textureFaces_.size() + n);
+
+  auto truncated = [&]() {
+    std::cerr << "Truncated element data: " << plan.name << "\n";
     return false;
-  }
+  };
 
-  auto *data = file_data.getData();
+  const uchar *p = data;
 
-  uint fi;
+  for (size_t i = 0; i < n; ++i) {
+    TextureFace tf;
 
-  if (big_endian_)
-    fi = ((data[3] & 0xFF)      ) |
-         ((data[2] & 0xFF) <<  8) |
-         ((data[1] & 0xFF) << 16) |
-         ((data[0] & 0xFF) << 24);
-  else
-    fi = ((data[0] & 0xFF)      ) |
-         ((data[1] & 0xFF) <<  8) |
-         ((data[2] & 0xFF) << 16) |
-         ((data[3] & 0xFF) << 24);
+    for (const auto &pp : plan.props) {
+      if (! pp.list) {
+        auto size = formatSize(pp.type);
 
-  *f = *reinterpret_cast<float *>(&fi);
+        if (size > size_t(end - p))
+          return truncated();
 
-//std::cerr << "f: " << *f << "\n";
+        if (isTextureFace) {
+          if      (pp.target == TARGET_TX) tf.tx = uchar(loadReal(p, pp.type, swap_));
+          else if (pp.target == TARGET_TN) tf.tn = uint (loadReal(p, pp.type, swap_));
+        }
 
-  return true;
-}
+        p += size;
 
-bool
-CImportPly::
-readInt(int *i) const
-{
-  CFileData file_data(sizeof(int));
+        continue;
+      }
 
-  try {
-    file_->read(&file_data);
-  }
-  catch (...) {
-    return false;
-  }
+      //---
 
-  auto *data = file_data.getData();
+      auto countSize = formatSize(pp.countType);
 
-  uint ii;
+      if (countSize > size_t(end - p))
+        return truncated();
 
-  if (big_endian_)
-    ii = ((data[3] & 0xFF)      ) |
-         ((data[2] & 0xFF) <<  8) |
-         ((data[1] & 0xFF) << 16) |
-         ((data[0] & 0xFF) << 24);
-  else
-    ii = ((data[0] & 0xFF)      ) |
-         ((data[1] & 0xFF) <<  8) |
-         ((data[2] & 0xFF) << 16) |
-         ((data[3] & 0xFF) << 24);
+      auto count = loadReal(p, pp.countType, swap_);
 
-  *i = *reinterpret_cast<int *>(&ii);
+      p += countSize;
 
-//std::cerr << "i: " << *i << "\n";
+      auto itemSize = formatSize(pp.type);
 
-  return true;
-}
+      // check count before conversion (negative, nan or huge count in bad file)
+      if (! std::isfinite(count) || count < 0.0) {
+        std::cerr << "Bad list count: " << count << "\n";
+        return false;
+      }
 
-bool
-CImportPly::
-readUInt(uint *i) const
-{
-  CFileData file_data(sizeof(int));
+      if (count > double(size_t(end - p)/std::max(itemSize, size_t(1))))
+        return truncated();
 
-  try {
-    file_->read(&file_data);
-  }
-  catch (...) {
-    return false;
-  }
+      auto ni = size_t(count);
 
-  auto *data = file_data.getData();
+      if      (pp.target == TARGET_INDICES && isFace) {
+        faces.starts.push_back(faces.inds.size());
 
-  uint ii;
+        for (size_t j = 0; j < ni; ++j, p += itemSize) {
+          auto vi = loadReal(p, pp.type, swap_);
 
-  if (big_endian_)
-    ii = ((data[3] & 0xFF)      ) |
-         ((data[2] & 0xFF) <<  8) |
-         ((data[1] & 0xFF) << 16) |
-         ((data[0] & 0xFF) << 24);
-  else
-    ii = ((data[0] & 0xFF)      ) |
-         ((data[1] & 0xFF) <<  8) |
-         ((data[2] & 0xFF) << 16) |
-         ((data[3] & 0xFF) << 24);
+          if (! (vi >= 0.0 && vi < double(num_vertices))) {
+            std::cerr << "Bad vertex index: " << vi << "\n";
+            return false;
+          }
+
+          faces.inds.push_back(int(vi));
+        }
+      }
+      else if (pp.target == TARGET_INDICES && isTextureFace) {
+        for (size_t j = 0; j < ni; ++j, p += itemSize) {
+          auto vi = loadReal(p, pp.type, swap_);
+
+          if (! (vi >= 0.0 && vi < double(num_texture_vertices))) {
+            std::cerr << "Bad texture vertex index: " << vi << "\n";
+            return false;
+          }
+
+          tf.inds.push_back(int(vi));
+        }
+      }
+      else
+        p += ni*itemSize;
+    }
 
-  *i = *reinterpret_cast<uint *>(&ii);
+    if (isTextureFace)
+      textureFaces_.push_back(std::move(tf));
+  }
 
-//std::cerr << "i: " << *i << "\n";
+  len = size_t(p - data);
 
   return true;
 }
 
-bool
+// add decoded vertices and faces to object
+void
 CImportPly::
-readUChar(uchar *i) const
+buildObject()
 {
-  CFileData file_data(sizeof(char));
-
-  try {
-    file_->read(&file_data);
-  }
-  catch (...) {
-    return false;
+  using VD = VertexData;
+
+  auto value = [&](int c, size_t i, float def) {
+    return (vertices_.has[c] ? vertices_.channels[c][i] : def);
+  };
+
+  bool hasColor   = (vertices_.has[VD::R] || vertices_.has[VD::G] ||
+                     vertices_.has[VD::B] || vertices_.has[VD::A]);
+  bool hasNormal  = (vertices_.has[VD::NX] || vertices_.has[VD::NY] || vertices_.has[VD::NZ]);
+  bool hasTexture = (vertices_.has[VD::S] || vertices_.has[VD::T]);
+
+  for (size_t i = 0; i < vertices_.size; ++i) {
+    int i1 = object_->addVertex(CPoint3D(value(VD::X, i, 0.0f),
+                                         value(VD::Y, i, 0.0f),
+                                         value(VD::Z, i, 0.0f)));
+    assert(int(i) == i1);
+
+    if (hasColor)
+      object_->setVertexColor(i1, CRGBA(value(VD::R, i, 1.0f), value(VD::G, i, 1.0f),
+                                        value(VD::B, i, 1.0f), value(VD::A, i, 1.0f)));
+
+    if (hasNormal)
+      object_->setVertexNormal(i1, CVector3D(value(VD::NX, i, 0.0f),
+                                             value(VD::NY, i, 0.0f),
+                                             value(VD::NZ, i, 0.0f)));
+
+    if (hasTexture)
+      object_->setVertexTextureMap(i1, CPoint2D(value(VD::S, i, 0.0f), value(VD::T, i, 0.0f)));
   }
 
-  auto *data = file_data.getData();
+  //---
 
-  *i = uchar(data[0] & 0xFF);
+  auto num_faces = faces_.size();
 
-//std::cerr << "i: " << *i << "\n";
+  bool has_texture_points = (textureFaces_.size() == num_faces);
 
-  return true;
+  std::vector<CPoint2D> tpoints;
+
+  for (size_t i = 0; i < num_faces; ++i) {
+    auto ni = faces_.numInds(i);
+
+    if (ni != 3) {
+      std::cerr << "Invalid face vertex count\n";
+      continue;
+    }
+
+    const auto *inds = faces_.faceInds(i);
+
+    auto faceInd = object_->addITriangle(inds[0], inds[1], inds[2]);
+
+    if (has_texture_points) {
+      auto &face = object_->getFace(faceInd);
+
+      const auto &tf = textureFaces_[i];
+
+      tpoints.clear();
+
+      for (const auto &ti : tf.inds) {
+        const auto &tp = texturePoints_[size_t(ti)];
+
+        tpoints.push_back(CPoint2D(tp.u, tp.v));
+      }
+
+      face.setTexturePoints(tpoints);
+    }
+  }
+
+  // geometry now owned by object
+  vertices_.clear();
+  faces_   .clear();
 }
@@ -1,7 +1,13 @@
 #include <CImportSTL.h>
 #include <CGeometry3D.h>
+#include <CImportMapFile.h>
 #include <CStrParse.h>
 
+#include <cfloat>
+#include <climits>
+#include <cmath>
+#include <cstring>
+
 CImportSTL::
 CImportSTL(CGeomScene3D *scene, const std::string &name) :
  scene_(scene)
@@ -30,6 +36,17 @@ read(CFile &file)
 {
   file_ = &file;
 
+  triangles_.clear();
+  zvals_    .clear();
+
+  weldCells_ .clear();
+  weldPoints_.clear();
+  weldNext_  .clear();
+  weldVertex_.clear();
+
+  numInputVertices_ = 0;
+  numDegenerate_    = 0;
+
   //---
 
   uchar header[81];
@@ -41,197 +58,138 @@ read(CFile &file)
 
   //if (header[80]) return false;
 
+  bool rc;
+
   if (strncmp(reinterpret_cast<char *>(&header[0]), "solid ", 6) == 0)
-    return readAscii();
+    rc = readAscii();
   else
-    return readBinary();
+    rc = readBinary();
+
+  return rc;
 }
 
 bool
 CImportSTL::
 readBinary()
 {
-  file_->rewind();
-
-  uchar header[81];
+  static const size_t headerSize = 84; // 80 byte header + triangle count
+  static const size_t recordSize = 50; // normal + 3 points + attribute count
 
-  if (! file_->read(header, 80))
-    return false;
+  static_assert(sizeof(Triangle) == 48, "Triangle must match record layout");
 
-  header[80] = '\0';
+  // read whole file in one read (or map it) and decode records from memory
+  CImportMapFile     mapFile;
+  std::vector<uchar> buffer;
 
-  if (isDebug())
-    std::cerr << "Header: " << header << "\n";
-
-  //---
+  const uchar *data = nullptr;
+  size_t       size = 0;
 
-  auto readShort = [&](ushort *integer) {
-    uchar buffer[2];
-
-    if (! file_->read(buffer, 2))
+  if (isMapFile()) {
+    if (! mapFile.open(file_->getPath()))
       return false;
 
-    *integer = ((buffer[0] & 0xFF)     ) |
-               ((buffer[1] & 0xFF) << 8);
-/*
-    *integer = ((buffer[1] & 0xFF)     ) |
-               ((buffer[0] & 0xFF) << 8);
-*/
-    return true;
-  };
-
-  auto readInteger = [&](uint *integer) {
-    uchar buffer[4];
-
-    if (! file_->read(buffer, 4))
-      return false;
+    data = mapFile.data();
+    size = mapFile.size();
+  }
+  else {
+    file_->rewind();
 
-    *integer = ((buffer[0] & 0xFF)      ) |
-               ((buffer[1] & 0xFF) <<  8) |
-               ((buffer[2] & 0xFF) << 16) |
-               ((buffer[3] & 0xFF) << 24);
-/*
-    *integer = ((buffer[3] & 0xFF)      ) |
-               ((buffer[2] & 0xFF) <<  8) |
-               ((buffer[1] & 0xFF) << 16) |
-               ((buffer[0] & 0xFF) << 24);
-*/
-    return true;
-  };
+    size = size_t(file_->getSize());
 
-  auto readFloat = [&](float *real) {
-#if 0
-    uchar buffer[4];
+    buffer.resize(size);
 
-    if (! file_->read(buffer, 4))
+    if (size > 0 && ! file_->read(&buffer[0], size))
       return false;
 
-    *real = ((buffer[0] & 0xFF)      ) |
-            ((buffer[1] & 0xFF) <<  8) |
-            ((buffer[2] & 0xFF) << 16) |
-            ((buffer[3] & 0xFF) << 24);
-/*
-    *real = ((buffer[3] & 0xFF)      ) |
-            ((buffer[2] & 0xFF) <<  8) |
-            ((buffer[1] & 0xFF) << 16) |
-            ((buffer[0] & 0xFF) << 24);
-*/
-    return true;
-#else
-    float f;
-
-    if (! file_->read(reinterpret_cast<uchar *>(&f), 4))
-      return false;
+    data = buffer.data();
+  }
 
-    *real = f;
+  if (size < headerSize)
+    return false;
 
-    return true;
-#endif
-  };
+  if (isDebug()) {
+    std::string header(reinterpret_cast<const char *>(data), 80);
 
-  auto readPoint = [&](Vector &v) {
-    float x, y, z;
-    if (! readFloat(&x) || ! readFloat(&y) || ! readFloat(&z))
-      return false;
+    std::cerr << "Header: " << header.c_str() << "\n";
+  }
 
-    auto p = adjustPoint(CPoint3D(x, y, z));
+  //---
 
-    v.x = float(p.x);
-    v.y = float(p.y);
-    v.z = float(p.z);
+  // little endian triangle count
+  uint nt = (uint(data[80])      ) |
+            (uint(data[81]) <<  8) |
+            (uint(data[82]) << 16) |
+            (uint(data[83]) << 24);
 
-    return true;
-  };
+  if (isDebug())
+    std::cerr << "Num Objects: " << nt << "\n";
 
-  auto readNormal = [&](Vector &v) {
-    float x, y, z;
-    if (! readFloat(&x) || ! readFloat(&y) || ! readFloat(&z))
-      return false;
+  if (size_t(nt) > (size - headerSize)/recordSize)
+    return false;
 
-    auto p = adjustNormal(CVector3D(x, y, z));
+  triangles_.resize(nt);
 
-    v.x = float(p.x());
-    v.y = float(p.y());
-    v.z = float(p.z());
+  //---
 
-    return true;
-  };
+  bool adjust = (isSwapXY() || isSwapYZ() || isSwapZX() ||
+                 isInvertX() || isInvertY() || isInvertZ());
 
-  auto readTriangle = [&](Triangle &t) {
-    if (! readNormal(t.normal)) return false;
+  // bounds as 4 lane min/max (pad lane unused) so update loops vectorize
+  float lo[4] = {  FLT_MAX,  FLT_MAX,  FLT_MAX, 0.0f };
+  float hi[4] = { -FLT_MAX, -FLT_MAX, -FLT_MAX, 0.0f };
 
-    if (! readPoint(t.p1)) return false;
-    if (! readPoint(t.p2)) return false;
-    if (! readPoint(t.p3)) return false;
+  auto updateRange = [&](const Vector &v) {
+    const float p[4] = { v.x, v.y, v.z, 0.0f };
 
-    return true;
+    for (int k = 0; k < 4; ++k) {
+      lo[k] = std::min(lo[k], p[k]);
+      hi[k] = std::max(hi[k], p[k]);
+    }
   };
 
-#if 0
-  auto printVector = [&](const Vector &v) {
-    std::cerr << v.x << " " << v.y << " " << v.z << "\n";
-  };
+  auto adjustVector = [&](Vector &v, bool isNormal) {
+    if (isNormal) {
+      auto n = adjustNormal(CVector3D(v.x, v.y, v.z));
+
+      v = Vector{float(n.x()), float(n.y()), float(n.z())};
+    }
+    else {
+      auto p = adjustPoint(CPoint3D(v.x, v.y, v.z));
 
-  auto printTriangle = [&](const Triangle &t) {
-    printVector(t.normal);
-    printVector(t.p1);
-    printVector(t.p2);
-    printVector(t.p3);
+      v = Vector{float(p.x), float(p.y), float(p.z)};
+    }
   };
-#endif
 
-  uint nt = 0;
-  if (! readInteger(&nt))
-    return false;
+  const uchar *record = data + headerSize;
 
-  if (isDebug())
-    std::cerr << "Num Objects: " << nt << "\n";
+  for (uint i = 0; i < nt; ++i, record += recordSize) {
+    auto &t = triangles_[i];
 
-  triangles_.resize(nt);
-
-  for (uint i = 0; i < nt; ++i) {
-    if (! readTriangle(triangles_[i]))
-      return false;
+    // floats are stored in host (little endian) order, attribute count ignored
+    memcpy(&t, record, sizeof(Triangle));
 
-    ushort na;
-    if (! readShort(&na))
-      return false;
+    if (adjust) {
+      adjustVector(t.normal, /*isNormal*/true );
+      adjustVector(t.p1    , /*isNormal*/false);
+      adjustVector(t.p2    , /*isNormal*/false);
+      adjustVector(t.p3    , /*isNormal*/false);
+    }
 
-//  if (na > 0)
-//    std::cerr << "NA: " << na << "\n";
+    updateRange(t.p1);
+    updateRange(t.p2);
+    updateRange(t.p3);
 
-//  printTriangle(triangles_[i]);
+    if (isCollectZVals())
+      zvals_.insert(t.p1.z);
   }
 
-  minV_ = Vector();
-  maxV_ = Vector();
-
-  uint i = 0;
-
-  for (const auto &t : triangles_) {
-    zvals_.insert(t.p1.z);
-
-    if (i == 0) {
-      minV_ = t.p1;
-      maxV_ = t.p1;
-    }
-    else {
-      auto updateRange = [&](const Vector &v) {
-        minV_.x = std::min(minV_.x, v.x);
-        minV_.y = std::min(minV_.y, v.y);
-        minV_.z = std::min(minV_.z, v.z);
-
-        maxV_.x = std::max(maxV_.x, v.x);
-        maxV_.y = std::max(maxV_.y, v.y);
-        maxV_.z = std::max(maxV_.z, v.z);
-      };
-
-      updateRange(t.p1);
-      updateRange(t.p2);
-      updateRange(t.p3);
-    }
-
-    ++i;
+  if (nt > 0) {
+    minV_ = Vector{lo[0], lo[1], lo[2]};
+    maxV_ = Vector{hi[0], hi[1], hi[2]};
+  }
+  else {
+    minV_ = Vector();
+    maxV_ = Vector();
   }
 
   if (isDebug()) {
@@ -240,13 +198,13 @@ readBinary()
     std::cerr << "Z Range: " << minV_.z << " " << maxV_.z << "\n";
   }
 
-  auto addFace = [&](int i1, int i2, int i3, const CVector3D &n) {
-    auto faceId = object_->addITriangle(i1, i2, i3);
-
-    auto &face = object_->getFace(faceId);
-
-    face.setNormal(n);
-  };
+  if (isWeldVertices()) {
+    // typically each position is shared by ~6 triangles
+    weldPoints_.reserve(nt/2);
+    weldNext_  .reserve(nt/2);
+    weldVertex_.reserve(nt/2);
+    weldCells_ .reserve(nt/2);
+  }
 
   for (const auto &t : triangles_) {
     auto p1 = CPoint3D(t.p1.x, t.p1.y, t.p1.z);
@@ -256,12 +214,12 @@ readBinary()
     auto n1 = CVector3D( t.normal.x,  t.normal.y,  t.normal.z);
 //  auto n2 = CVector3D(-t.normal.x, -t.normal.y, -t.normal.z);
 
-    int i1 = object_->addVertex(p1);
-    int i2 = object_->addVertex(p2);
-    int i3 = object_->addVertex(p3);
+    int i1 = addVertex(p1);
+    int i2 = addVertex(p2);
+    int i3 = addVertex(p3);
 
-    addFace(i1, i2, i3, n1);
-//  addFace(i3, i2, i1, n2);
+    (void) addTriangle(i1, i2, i3, n1);
+//  (void) addTriangle(i3, i2, i1, n2);
   }
 
   return true;
@@ -384,11 +342,7 @@ readAscii()
         if (vertices.size() != 3)
           return errorMsg("Invalid number of vertices");
 
-        auto faceId = object_->addITriangle(vertices[0], vertices[1], vertices[2]);
-
-        auto &face = object_->getFace(faceId);
-
-        face.setNormal(normal);
+        (void) addTriangle(vertices[0], vertices[1], vertices[2], normal);
 
         state = State::FACET;
       }
@@ -409,7 +363,7 @@ readAscii()
         if (! parse.readReal(&z))
           return errorMsg("Invalid real for z");
 
-        int iv = object_->addVertex(CPoint3D(x, y, z));
+        int iv = addVertex(CPoint3D(x, y, z));
 
         vertices.push_back(iv);
       }
@@ -422,3 +376,146 @@ readAscii()
 
   return true;
 }
+
+// add triangle vertex (returns existing vertex if welding and position already added)
+int
+CImportSTL::
+addVertex(const CPoint3D &p)
+{
+  ++numInputVertices_;
+
+  if (! isWeldVertices())
+    return object_->addVertex(p);
+
+  //---
+
+  auto tol = weldTolerance_;
+
+  // cell is position quantized to tolerance (or float bits for exact match)
+  auto cellValue = [&](double r) {
+    if (tol > 0.0) {
+      auto c = std::floor(r/tol);
+
+      c = std::min(std::max(c, double(INT_MIN + 1)), double(INT_MAX - 1));
+
+      return int(c);
+    }
+    else {
+      float f = float(r) + 0.0f; // -0.0 -> 0.0
+
+      int i;
+
+      memcpy(&i, &f, sizeof(i));
+
+      return i;
+    }
+  };
+
+  auto isMatch = [&](const CPoint3D &p1) {
+    if (tol > 0.0)
+      return (std::abs(p1.x - p.x) <= tol &&
+              std::abs(p1.y - p.y) <= tol &&
+              std::abs(p1.z - p.z) <= tol);
+    else
+      return (p1.x == p.x && p1.y == p.y && p1.z == p.z);
+  };
+
+  auto findCell = [&](const WeldCell &cell) {
+    auto pc = weldCells_.find(cell);
+
+    if (pc == weldCells_.end())
+      return -1;
+
+    for (int i = (*pc).second; i >= 0; i = weldNext_[size_t(i)]) {
+      if (isMatch(weldPoints_[size_t(i)]))
+        return weldVertex_[size_t(i)];
+    }
+
+    return -1;
+  };
+
+  WeldCell cell { cellValue(p.x), cellValue(p.y), cellValue(p.z) };
+
+  int ind = findCell(cell);
+
+  // matching point within tolerance may be in neighbouring cell
+  if (ind < 0 && tol > 0.0) {
+    for (int dz = -1; dz <= 1 && ind < 0; ++dz) {
+      for (int dy = -1; dy <= 1 && ind < 0; ++dy) {
+        for (int dx = -1; dx <= 1 && ind < 0; ++dx) {
+          if (dx == 0 && dy == 0 && dz == 0)
+            continue;
+
+          ind = findCell(WeldCell{cell.x + dx, cell.y + dy, cell.z + dz});
+        }
+      }
+    }
+  }
+
+  if (ind >= 0)
+    return ind;
+
+  //---
+
+  ind = object_->addVertex(p);
+
+  auto iw = int(weldPoints_.size());
+
+  weldPoints_.push_back(p);
+  weldVertex_.push_back(ind);
+
+  auto pc = weldCells_.find(cell);
+
+  if (pc != weldCells_.end()) {
+    weldNext_.push_back((*pc).second);
+
+    (*pc).second = iw;
+  }
+  else {
+    weldNext_.push_back(-1);
+
+    weldCells_[cell] = iw;
+  }
+
+  return ind;
+}
+
+// add triangle face (degenerate triangles from welded vertices are skipped)
+bool
+CImportSTL::
+addTriangle(int i1, int i2, int i3, const CVector3D &n)
+{
+  if (i1 == i2 || i2 == i3 || i3 == i1) {
+    ++numDegenerate_;
+    return false;
+  }
+
+  auto faceId = object_->addITriangle(i1, i2, i3);
+
+  auto &face = object_->getFace(faceId);
+
+  face.setNormal(n);
+
+  return true;
+}
+
+void
+CImportSTL::
+printWeldStats() const
+{
+  if (! isWeldVertices())
+    return;
+
+  auto numWeld = numWeldVertices();
+
+  auto percent = (numInputVertices_ > 0 ?
+    100.0*(1.0 - double(numWeld)/double(numInputVertices_)) : 0.0);
+
+  // object vertex storage no longer needed
+  auto savedBytes = double(numInputVertices_ - numWeld)*sizeof(CGeomVertex3D);
+
+  std::cerr << "Weld Vertices: " << numInputVertices_ << " -> " << numWeld <<
+               " (" << percent << "% reduction)\n";
+  std::cerr << "Weld Degenerate Faces: " << numDegenerate_ << "\n";
+  std::cerr << "Weld Memory Saved: " << savedBytes/(1024.0*1024.0) << " MB\n";
+}
@@ -12,7 +12,7 @@
 #include <CGeomPyramid3D.h>
 #include <CGeomSphere3D.h>
 #include <CGeomTorus3D.h>
-#include <CSG.h>
+#include <CSGMesh.h>
 
 #include <CStrUtil.h>
 #include <CMathGen.h>
@@ -97,6 +97,8 @@ CImportScene(CGeomScene3D *scene, const std::string &) :
 CImportScene::
 ~CImportScene()
 {
+  for (auto *object : unsharedBuiltins_)
+    delete object;
 }
 
 bool
@@ -230,7 +232,7 @@ readScene()
       case SCENE_OBJECT_CMD: {
         auto *object = getPrimitive(words.getWord(1));
 
-        if (! object) {
+        if (! object && objectInstances_.find(words.getWord(1)) == objectInstances_.end()) {
           errorMsg("Unrecognised Object '" + words.getWord(1) + "'");
           return;
         }
@@ -260,69 +262,121 @@ void
 CImportScene::
 addObject(const std::string &name)
 {
+  // instance of object (shares object's mesh)
+  if (isInstancing()) {
+    auto pi = objectInstances_.find(name);
+
+    if (pi != objectInstances_.end()) {
+      instances_.push_back((*pi).second);
+      return;
+    }
+  }
+
   auto *primitive = getPrimitive(name);
 
+  if (! primitive)
+    primitive = builtinPrimitive(name);
+
   if (! primitive) {
-    if      (name == "Sphere") {
-      primitive = CGeometry3DInst->createObject3D(scene_, "sphere");
+    errorMsg("Unrecognised Primitive '" + name + "'");
+    return;
+  }
 
-      CGeomSphere3D::addGeometry(primitive, CPoint3D(0.0, 0.0, 0.0), 1.0);
+  if (isInstancing()) {
+    Instance instance;
 
-      CGeomSphere3D::addTexturePoints(primitive);
-      CGeomSphere3D::addNormals(primitive, 1.0);
-    }
-    else if (name == "Cube" || name == "Box") {
-      primitive = CGeometry3DInst->createObject3D(scene_, "cube");
+    instance.name = name;
+    instance.mesh = primitive;
 
-      CGeomBox3D::addGeometry(primitive, 0.0, 0.0, 0.0, 1.0, 1.0, 1.0);
-    }
-    else if (name == "Cone") {
-      primitive = CGeometry3DInst->createObject3D(scene_, "cone");
+    instances_.push_back(instance);
 
-      CGeomCone3D::addGeometry(primitive, CPoint3D(0.0, 0.0, 0.0), 1.0, 1.0);
-      CGeomCone3D::addNormals(primitive, 1.0, 1.0);
-    }
-    else if (name == "Cylinder") {
-      primitive = CGeometry3DInst->createObject3D(scene_, "cylinder");
+    return;
+  }
 
-      CGeomCylinder3D::addGeometry(primitive, CPoint3D(0.0, 0.0, 0.0), 1.0, 1.0);
+  auto *object1 = CGeometry3DInst->dupObject(primitive);
 
-      CGeomCylinder3D::addNormals(primitive, 1.0, 1.0);
-    }
-    else if (name == "Torus") {
-      primitive = CGeometry3DInst->createObject3D(scene_, "torus");
+  object1->setScene(scene_);
 
-      CGeomTorus3D::addGeometry(primitive,
-                                0.0, 0.0, 0.0, // center
-                                1.0, 0.25, // radii);
-                                1.0, 0.2, 36, 36);
-    }
-    else if (name == "Pyramid") {
-      primitive = CGeometry3DInst->createObject3D(scene_, "pyramid");
+  scene_->addObject(object1, /*hier*/true);
+}
 
-      CGeomPyramid3D::addGeometry(primitive,
-                                  0.0, 0.0, 0.0, // center
-                                  1.0, 1.0); // w, h
-    }
-    else if (name == "Hyperboloid") {
-      primitive = CGeometry3DInst->createObject3D(scene_, "hyperboloid");
+// mesh for built-in primitive (created on first use). Only registered with the
+// scene (under a reserved name) when instancing, otherwise only copies are added
+CGeomObject3D *
+CImportScene::
+builtinPrimitive(const std::string &name)
+{
+  auto pb = builtins_.find(name);
 
-      CGeomHyperboloid3D::addGeometry(primitive, CPoint3D(0.0, 0.0, 0.0), CPoint3D(1.0, 1.0, 1.0));
+  if (pb != builtins_.end())
+    return (*pb).second;
 
-      CGeomHyperboloid3D::addNormals(primitive, CPoint3D(0.0, 0.0, 0.0), CPoint3D(1.0, 1.0, 1.0));
-    }
+  auto primitiveName = [&](const std::string &name1) {
+    return (isInstancing() ? "__builtin_" + name1 : name1);
+  };
+
+  CGeomObject3D *primitive = nullptr;
+
+  if      (name == "Sphere") {
+    primitive = CGeometry3DInst->createObject3D(scene_, primitiveName("sphere"));
+
+    CGeomSphere3D::addGeometry(primitive, CPoint3D(0.0, 0.0, 0.0), 1.0);
+
+    CGeomSphere3D::addTexturePoints(primitive);
+    CGeomSphere3D::addNormals(primitive, 1.0);
   }
+  else if (name == "Cube" || name == "Box") {
+    primitive = CGeometry3DInst->createObject3D(scene_, primitiveName("cube"));
 
-  if (! primitive) {
-    errorMsg("Unrecognised Primitive '" + name + "'");
-    return;
+    CGeomBox3D::addGeometry(primitive, 0.0, 0.0, 0.0, 1.0, 1.0, 1.0);
   }
+  else if (name == "Cone") {
+    primitive = CGeometry3DInst->createObject3D(scene_, primitiveName("cone"));
 
-  auto *object1 = CGeometry3DInst->dupObject(primitive);
+    CGeomCone3D::addGeometry(primitive, CPoint3D(0.0, 0.0, 0.0), 1.0, 1.0);
+    CGeomCone3D::addNormals(primitive, 1.0, 1.0);
+  }
+  else if (name == "Cylinder") {
+    primitive = CGeometry3DInst->createObject3D(scene_, primitiveName("cylinder"));
 
-  object1->setScene(scene_);
+    CGeomCylinder3D::addGeometry(primitive, CPoint3D(0.0, 0.0, 0.0), 1.0, 1.0);
 
-  scene_->addObject(object1, /*hier*/true);
+    CGeomCylinder3D::addNormals(primitive, 1.0, 1.0);
+  }
+  else if (name == "Torus") {
+    primitive = CGeometry3DInst->createObject3D(scene_, primitiveName("torus"));
+
+    CGeomTorus3D::addGeometry(primitive,
+                              0.0, 0.0, 0.0, // center
+                              1.0, 0.25, // radii);
+                              1.0, 0.2, 36, 36);
+  }
+  else if (name == "Pyramid") {
+    primitive = CGeometry3DInst->createObject3D(scene_, primitiveName("pyramid"));
+
+    CGeomPyramid3D::addGeometry(primitive,
+                                0.0, 0.0, 0.0, // center
+                                1.0, 1.0); // w, h
+  }
+  else if (name == "Hyperboloid") {
+    primitive = CGeometry3DInst->createObject3D(scene_, primitiveName("hyperboloid"));
+
+    CGeomHyperboloid3D::addGeometry(primitive, CPoint3D(0.0, 0.0, 0.0), CPoint3D(1.0, 1.0, 1.0));
+
+    CGeomHyperboloid3D::addNormals(primitive, CPoint3D(0.0, 0.0, 0.0), CPoint3D(1.0, 1.0, 1.0));
+  }
+
+  if (! primitive)
+    return nullptr;
+
+  if (isInstancing())
+    scene_->addPrimitive(primitive);
+  else
+    unsharedBuiltins_.push_back(primitive);
+
+  builtins_[name] = primitive;
+
+  return primitive;
 }
 
 void
@@ -588,6 +642,32 @@ readObject(const std::string &name)
 
   object->setName(name);
 
+  // instancing: overrides applied to shared mesh
+  Instance instance;
+
+  bool shared = false;
+
+  // object to change (copy of shared mesh with overrides applied on first edit)
+  auto editObject = [&]() {
+    if (shared) {
+      delete object;
+
+      object = CGeometry3DInst->dupObject(instance.mesh);
+
+      object->setScene(scene_);
+      object->setName(name);
+
+      if (instance.faceColor) object->setFaceColor(instance.faceColor.value());
+      if (instance.material ) object->setMaterialP(instance.material);
+      if (instance.shadowed ) object->setShadowed (instance.shadowed.value());
+
+      instance = Instance();
+      shared   = false;
+    }
+
+    return object;
+  };
+
   std::string line;
 
   bool endCommand = false;
@@ -606,64 +686,22 @@ readObject(const std::string &name)
 
         auto *primitive = getPrimitive(name1);
 
-        if (! primitive) {
-          if      (name1 == "Sphere") {
-            primitive = CGeometry3DInst->createObject3D(scene_, name);
-
-            CGeomSphere3D::addGeometry(primitive, CPoint3D(0.0, 0.0, 0.0), 1.0);
-
-            CGeomSphere3D::addTexturePoints(primitive);
-            CGeomSphere3D::addNormals(primitive, 1.0);
-          }
-          else if (name1 == "Cube" || name == "Box") {
-            primitive = CGeometry3DInst->createObject3D(scene_, name);
-
-            CGeomBox3D::addGeometry(primitive, 0.0, 0.0, 0.0, 1.0, 1.0, 1.0);
-          }
-          else if (name1 == "Cone") {
-            primitive = CGeometry3DInst->createObject3D(scene_, name);
-
-            CGeomCone3D::addGeometry(primitive, CPoint3D(0.0, 0.0, 0.0), 1.0, 1.0);
-            CGeomCone3D::addNormals(primitive, 1.0, 1.0);
-          }
-          else if (name1 == "Cylinder") {
-            primitive = CGeometry3DInst->createObject3D(scene_, name);
-
-            CGeomCylinder3D::addGeometry(primitive, CPoint3D(0.0, 0.0, 0.0), 1.0, 1.0);
-
-            CGeomCylinder3D::addNormals(primitive, 1.0, 1.0);
-          }
-          else if (name == "Torus") {
-            primitive = CGeometry3DInst->createObject3D(scene_, name);
-
-            CGeomTorus3D::addGeometry(primitive,
-                                      0.0, 0.0, 0.0, // center
-                                      1.0, 0.25, // radii);
-                                      1.0, 0.2, 36, 36);
-          }
-          else if (name == "Pyramid") {
-            primitive = CGeometry3DInst->createObject3D(scene_, name);
-
-            CGeomPyramid3D::addGeometry(primitive,
-                                        0.0, 0.0, 0.0, // center
-                                        1.0, 1.0); // w, h
-          }
-          else if (name == "Hyperboloid") {
-            primitive = CGeometry3DInst->createObject3D(scene_, "hyperboloid");
-
-            CGeomHyperboloid3D::addGeometry(primitive, CPoint3D(0.0, 0.0, 0.0),
-                                            CPoint3D(1.0, 1.0, 1.0));
-
-            CGeomHyperboloid3D::addNormals(primitive, CPoint3D(0.0, 0.0, 0.0),
-                                           CPoint3D(1.0, 1.0, 1.0));
-          }
-        }
+        if (! primitive)
+          primitive = builtinPrimitive(name1);
 
         if (! primitive) {
           errorMsg("Unrecognised Primitive '" + name1 + "'");
           break;
         }
 
+        // share primitive mesh until object is edited
+        if (isInstancing()) {
+          instance.mesh = primitive;
+          shared        = true;
+
+          break;
+        }
+
         delete object;
 
         object = CGeometry3DInst->dupObject(primitive);
@@ -684,7 +722,10 @@ readObject(const std::string &name)
       case OBJECT_FACE_COLOUR_CMD: {
         auto rgba = wordToColor(words.getWord(1));
 
-        object->setFaceColor(rgba);
+        if (shared)
+          instance.faceColor = rgba;
+        else
+          object->setFaceColor(rgba);
 
         break;
       }
@@ -692,7 +733,7 @@ readObject(const std::string &name)
       case OBJECT_SUB_FACE_COLOUR_CMD: {
         auto rgba = wordToColor(words.getWord(1));
 
-        object->setSubFaceColor(rgba);
+        editObject()->setSubFaceColor(rgba);
 
         break;
       }
@@ -708,7 +749,7 @@ readObject(const std::string &name)
         if (texture_num >= 1 && texture_num <= int(textures_.size())) {
           auto *texture = textures_[uint(texture_num - 1)];
 
-          object->setTexture(texture);
+          editObject()->setTexture(texture);
         }
         else
           errorMsg("Invalid texture number " + std::to_string(texture_num));
@@ -721,7 +762,7 @@ readObject(const std::string &name)
         if (texture_num >= 1 && texture_num <= int(textures_.size())) {
           auto *texture = textures_[uint(texture_num - 1)];
 
-          object->mapTexture(texture);
+          editObject()->mapTexture(texture);
         }
         else
           errorMsg("Invalid texture number " + std::to_string(texture_num));
@@ -734,7 +775,7 @@ readObject(const std::string &name)
         if (mask_num >= 1 && mask_num <= int(textures_.size())) {
           auto *texture = textures_[uint(mask_num - 1)];
 
-          object->setMask(texture->image()->image());
+          editObject()->setMask(texture->image()->image());
         }
         else
           errorMsg("Invalid mask number " + std::to_string(mask_num));
@@ -747,7 +788,7 @@ readObject(const std::string &name)
         if (mask_num >= 1 && mask_num <= int(textures_.size())) {
           auto *texture = textures_[uint(mask_num - 1)];
 
-          object->mapMask(texture->image()->image());
+          editObject()->mapMask(texture->image()->image());
         }
         else
           errorMsg("Invalid mask number " + std::to_string(mask_num));
@@ -759,7 +800,9 @@ readObject(const std::string &name)
 
         auto *material = getMaterial(materialName);
 
-        if (material)
+        if      (material && shared)
+          instance.material = material;
+        else if (material)
           object->setMaterialP(material);
         else
           errorMsg("Invalid material name '" + materialName + "'");
@@ -772,7 +815,7 @@ readObject(const std::string &name)
         auto *material = getMaterial(materialName);
 
         if (material)
-          object->setSubFaceMaterialP(material);
+          editObject()->setSubFaceMaterialP(material);
         else
           errorMsg("Invalid material name '" + materialName + "'");
 
@@ -786,7 +829,10 @@ readObject(const std::string &name)
       case OBJECT_SHADOWED_CMD: {
         auto b = words.getBool(1);
 
-        object->setShadowed(b);
+        if (shared)
+          instance.shadowed = b;
+        else
+          object->setShadowed(b);
 
         break;
       }
@@ -805,7 +851,7 @@ readObject(const std::string &name)
   if (transformData.center || transformData.fit) {
     CBBox3D bbox;
     //object->getModelBBox(bbox);
-    object->getMeshBBox(bbox);
+    (shared ? instance.mesh : object)->getMeshBBox(bbox);
 
     auto c = bbox.getCenter();
     auto s = bbox.getSize();
@@ -853,6 +899,24 @@ readObject(const std::string &name)
     transform = transform*m;
   }
 
+  // scene objects are instances of object's mesh (shared primitive or edited copy)
+  if (isInstancing()) {
+    instance.name      = name;
+    instance.transform = transform;
+
+    if (shared)
+      delete object;
+    else {
+      instance.mesh = object;
+
+      scene_->addPrimitive(object);
+    }
+
+    objectInstances_[name] = instance;
+
+    return;
+  }
+
   object->setTransform(transform);
 
   scene_->addPrimitive(object);
@@ -1605,70 +1669,6 @@ getMaterial(const std::string &name) const
 
 //----
 
-class CCSGPolygon : public CSG::Polygon {
- public:
-  CCSGPolygon(const std::vector<CSG::Vertex *> &v, const Polygon *p) :
-   Polygon(v, p) {
-    if (p) c_ = static_cast<const CCSGPolygon *>(p)->getColor();
-  }
-
-  const CRGBA &getColor() const { return c_; }
-  void setColor(const CRGBA &c) { c_ = c; }
-
- private:
-  CRGBA c_ { 1.0, 1.0, 1.0 };
-};
-
-class CCSGNode : public CSG::Node {
- public:
-  CCSGNode() : Node() { }
-
-  void setColor(const CRGBA &c) {
-    int np = polygons.size();
-
-    for (int i = 0; i < np; ++i)
-      static_cast<CCSGPolygon *>(polygons[i])->setColor(c);
-
-    if (back ) static_cast<CCSGNode *>(back )->setColor(c);
-    if (front) static_cast<CCSGNode *>(front)->setColor(c);
-  }
-};
-
-class CCSG : public CSG::CSG {
- public:
-  CCSG() : CSG() { }
-
-  void setColor(const CRGBA &c) {
-    static_cast<CCSGNode *>(root())->setColor(c);
-  }
-};
-
-class CCSGFactory : public CSG::Factory {
- public:
-  CCSGFactory() { }
-
-  CSG::CSG *createCSG() override {
-    return new CCSG;
-  }
-
-  CSG::Node *createNode() override {
-    return new CCSGNode;
-  }
-
-  CSG::Vertex *createVertex(const CSG::Vector &p, const CSG::Vector &n) override {
-    return new CSG::Vertex(p, n);
-  }
-
-  CSG::Polygon *createPolygon(const std::vector<CSG::Vertex *> &v, const CSG::Polygon *p) override {
-    auto *p1 = new CCSGPolygon(v, p);
-
-    if (p)
-      p1->setColor(static_cast<const CCSGPolygon *>(p)->getColor());
-
-    return p1;
-  }
-};
-
 void
 CImportScene::
 readCSG(const std::string &name)
@@ -1678,7 +1678,8 @@ readCSG(const std::string &name)
     CSG_SPHERE_CMD   = 2,
     CSG_CYLINDER_CMD = 3,
     CSG_COLOR_CMD    = 4,
-    CSG_END_CMD      = 5
+    CSG_ROBUST_CMD   = 5,
+    CSG_END_CMD      = 6
   };
 
   static const char *
@@ -1687,6 +1688,7 @@ readCSG(const std::string &name)
     "Sphere",
     "Cylinder",
     "Color",
+    "Robust",
     "End",
     nullptr,
   };
@@ -1699,16 +1701,34 @@ readCSG(const std::string &name)
 
   CRGBA color;
 
+  // polygon tags are indices into colors
+  std::vector<CRGBA> colors;
+
   struct Shape {
-    CSG::CSG*   csg { nullptr };
+    CSG::Mesh   mesh;
     std::string op;
   };
 
   std::vector<Shape> shapes;
 
-  //---
+  CSG::Mesh::Options csgOptions;
+
+  csgOptions.numThreads = numThreads();
+
+  auto addShape = [&](CSG::Mesh &&mesh, const std::string &op) {
+    Shape shape;
+
+    shape.mesh = std::move(mesh);
+    shape.op   = op;
+
+    shape.mesh.setTag(uint(colors.size()));
 
-  CSGMgrInst->setFactory(new CCSGFactory);
+    colors.push_back(color);
+
+    shapes.push_back(std::move(shape));
+  };
+
+  //---
 
   std::string line;
 
@@ -1730,14 +1750,7 @@ readCSG(const std::string &name)
         auto z = words.getReal(4);
         auto r = words.getReal(5);
 
-        Shape shape;
-
-        shape.csg = CSG::cube(CSG::Vector(x, y, z), r);
-        shape.op  = words.getWord(1);
-
-        static_cast<CCSG *>(shape.csg)->setColor(color);
-
-        shapes.push_back(shape);
+        addShape(CSG::Mesh::cube(CSG::Vector(x, y, z), r), words.getWord(1));
 
         break;
       }
@@ -1748,14 +1761,7 @@ readCSG(const std::string &name)
         auto z = words.getReal(4);
         auto r = words.getReal(5);
 
-        Shape shape;
-
-        shape.csg = CSG::sphere(CSG::Vector(x, y, z), r);
-        shape.op  = words.getWord(1);
-
-        static_cast<CCSG *>(shape.csg)->setColor(color);
-
-        shapes.push_back(shape);
+        addShape(CSG::Mesh::sphere(CSG::Vector(x, y, z), r), words.getWord(1));
 
         break;
       }
@@ -1769,14 +1775,8 @@ readCSG(const std::string &name)
         auto z2 = words.getReal(7);
         auto r  = words.getReal(8);
 
-        Shape shape;
-
-        shape.csg = CSG::cylinder(CSG::Vector(x1, y1, z1), CSG::Vector(x2, y2, z2), r);
-        shape.op  = words.getWord(1);
-
-        static_cast<CCSG *>(shape.csg)->setColor(color);
-
-        shapes.push_back(shape);
+        addShape(CSG::Mesh::cylinder(CSG::Vector(x1, y1, z1), CSG::Vector(x2, y2, z2), r),
+                 words.getWord(1));
 
         break;
       }
@@ -1785,6 +1785,13 @@ readCSG(const std::string &name)
 
         break;
       }
+      case CSG_ROBUST_CMD: {
+        // optional snap size
+        csgOptions.robust   = true;
+        csgOptions.snapSize = words.getReal(1, csgOptions.snapSize);
+
+        break;
+      }
       case CSG_END_CMD:
         endCommand = true;
 
@@ -1797,11 +1804,15 @@ readCSG(const std::string &name)
 
   //---
 
-  CSG::CSG *csg { nullptr };
+  CSG::Mesh csg;
+
+  bool first = true;
 
-  for (const auto &shape : shapes) {
-    if (! csg)
-      csg = shape.csg;
+  for (auto &shape : shapes) {
+    if (first) {
+      csg   = std::move(shape.mesh);
+      first = false;
+    }
     else {
       auto op = shape.op;
 
@@ -1813,43 +1824,48 @@ readCSG(const std::string &name)
       }
 
       if (negate)
-        shape.csg->inverseOp();
+        shape.mesh = shape.mesh.inverseOp();
 
       if      (op == "&")
-        csg = csg->unionOp(shape.csg);
+        csg = csg.unionOp(shape.mesh, csgOptions);
       else if (op == "|")
-        csg = csg->intersectOp(shape.csg);
+        csg = csg.intersectOp(shape.mesh, csgOptions);
       else if (op == "^")
-        csg = csg->subtractOp(shape.csg);
+        csg = csg.subtractOp(shape.mesh, csgOptions);
     }
   }
 
   //---
 
-  auto polygons = csg->toPolygons();
+  // object vertex for each mesh vertex and color
+  std::map<std::pair<uint, uint>, uint> vertexMap;
 
-  for (auto *poly : polygons) {
+  for (const auto &poly : csg.polygons()) {
     std::vector<uint> inds;
 
-    auto *poly1 = static_cast<CCSGPolygon *>(poly);
+    for (uint i = 0; i < poly.count; ++i) {
+      auto vi = csg.indices()[poly.first + i];
 
-    for (auto *v : poly->vertices) {
-      auto ind = object->addVertex(CPoint3D(v->pos.x, v->pos.y, v->pos.z));
+      auto pv = vertexMap.find(std::make_pair(vi, poly.tag));
 
-      object->setVertexNormal(ind, CVector3D(v->normal.x, v->normal.y, v->normal.z));
-      object->setVertexColor (ind, poly1->getColor());
+      if (pv == vertexMap.end()) {
+        const auto &v = csg.vertices()[vi];
 
-      inds.push_back(ind);
+        auto ind = object->addVertex(CPoint3D(v.pos.x, v.pos.y, v.pos.z));
+
+        object->setVertexNormal(ind, CVector3D(v.normal.x, v.normal.y, v.normal.z));
+        object->setVertexColor (ind, colors[poly.tag]);
+
+        pv = vertexMap.insert(pv, std::make_pair(std::make_pair(vi, poly.tag), ind));
+      }
+
+      inds.push_back((*pv).second);
     }
 
     object->addFace(inds);
   }
 
   scene_->addPrimitive(object);
-
-  //---
-
-  CSGMgrInst->setFactory(nullptr);
 }
 
 CImportScene::TransformData
@@ -2001,6 +2017,28 @@ getPrimitive(const std::string &name)
   return scene_->getPrimitiveP(name);
 }
 
+CGeomObject3D *
+CImportScene::
+editInstance(size_t i)
+{
+  auto &instance = instances_[i];
+
+  // copy shared mesh on first edit
+  if (! instance.owned) {
+    auto *object = CGeometry3DInst->dupObject(instance.mesh);
+
+    object->setScene(scene_);
+    object->setName(instance.name);
+
+    scene_->addPrimitive(object);
+
+    instance.mesh  = object;
+    instance.owned = true;
+  }
+
+  return instance.mesh;
+}
+
 int
 CImportScene::
 lookupCommand(const std::string &command, const char **commands)
@@ -4,6 +4,10 @@
 #include <CVoxel.h>
 #include <CStrUtil.h>
 
+#include <algorithm>
+#include <unordered_map>
+#include <cstdint>
+
 CImportVoxel::
 CImportVoxel(CGeomScene3D *scene, const std::string &name) :
  scene_(scene)
@@ -47,6 +51,20 @@ read(CFile &file)
 
   double scale = std::max(std::max(xs, ys), zs);
 
+  auto center = CPoint3D(xc, yc, zc);
+
+  if (isGreedyMesh())
+    addGreedyMesh(voxel, center, scale);
+  else
+    addBoxes(voxel, center, scale);
+
+  return true;
+}
+
+void
+CImportVoxel::
+addBoxes(const CVoxel &voxel, const CPoint3D &center, double scale)
+{
   double bs = 1.0/scale;
 
   auto addBox = [&](double x, double y, double z, const CRGBA &c) {
@@ -61,12 +79,185 @@ read(CFile &file)
   for (const auto &v : voxel.voxels()) {
     auto c = voxel.color(v.c);
 
-    double x = (v.x - xc)/scale;
-    double y = (v.y - yc)/scale;
-    double z = (v.z - zc)/scale;
+    double x = (v.x - center.x)/scale;
+    double y = (v.y - center.y)/scale;
+    double z = (v.z - center.z)/scale;
 
     addBox(x, y, z, c);
   }
+}
 
-  return true;
+// mesh visible faces of voxels.
+//
+// For each axis and direction the faces of each slice which have no solid neighbour
+// are collected into a color mask and covered by maximal same color rectangles (grown
+// along u then v), each added as one quad (counter clockwise seen from outside).
+// Quad corners on the voxel grid share vertices.
+void
+CImportVoxel::
+addGreedyMesh(const CVoxel &voxel, const CPoint3D &center, double scale)
+{
+  const auto &voxels = voxel.voxels();
+
+  if (voxels.empty())
+    return;
+
+  // grid bounds
+  int pmin[3] { 0, 0, 0 }, pmax[3] { 0, 0, 0 };
+
+  bool first = true;
+
+  for (const auto &v : voxels) {
+    int p[3] = { int(v.x), int(v.y), int(v.z) };
+
+    for (int i = 0; i < 3; ++i) {
+      if (first || p[i] < pmin[i]) pmin[i] = p[i];
+      if (first || p[i] > pmax[i]) pmax[i] = p[i];
+    }
+
+    first = false;
+  }
+
+  int size[3];
+
+  for (int i = 0; i < 3; ++i)
+    size[i] = pmax[i] - pmin[i] + 1;
+
+  //---
+
+  // occupancy grid of color index + 1 (0 is empty)
+  std::vector<uint16_t> cells(size_t(size[0])*size_t(size[1])*size_t(size[2]), 0);
+
+  auto cellIndex = [&](const int p[3]) {
+    return (size_t(p[2])*size_t(size[1]) + size_t(p[1]))*size_t(size[0]) + size_t(p[0]);
+  };
+
+  auto cell = [&](const int p[3]) -> uint16_t {
+    for (int i = 0; i < 3; ++i) {
+      if (p[i] < 0 || p[i] >= size[i])
+        return 0;
+    }
+
+    return cells[cellIndex(p)];
+  };
+
+  for (const auto &v : voxels) {
+    int p[3] = { int(v.x) - pmin[0], int(v.y) - pmin[1], int(v.z) - pmin[2] };
+
+    cells[cellIndex(p)] = uint16_t(v.c + 1);
+  }
+
+  //---
+
+  // vertex for each used grid corner
+  std::unordered_map<uint64_t, uint> cornerVertex;
+
+  auto cornerInd = [&](const int p[3]) {
+    auto key = (uint64_t(p[2])*uint64_t(size[1] + 1) + uint64_t(p[1]))*
+               uint64_t(size[0] + 1) + uint64_t(p[0]);
+
+    auto pc = cornerVertex.find(key);
+
+    if (pc != cornerVertex.end())
+      return (*pc).second;
+
+    // voxel p is centered on p so its cell starts half a voxel before
+    auto pos = CPoint3D((pmin[0] + p[0] - 0.5 - center.x)/scale,
+                        (pmin[1] + p[1] - 0.5 - center.y)/scale,
+                        (pmin[2] + p[2] - 0.5 - center.z)/scale);
+
+    auto ind = uint(object_->addVertex(pos));
+
+    cornerVertex[key] = ind;
+
+    return ind;
+  };
+
+  //---
+
+  std::vector<uint16_t> mask;
+
+  for (int d = 0; d < 3; ++d) {
+    int u = (d + 1) % 3;
+    int v = (d + 2) % 3;
+
+    int su = size[u];
+    int sv = size[v];
+
+    mask.resize(size_t(su)*size_t(sv));
+
+    for (int dir = -1; dir <= 1; dir += 2) {
+      for (int s = 0; s < size[d]; ++s) {
+        // faces of slice without solid neighbour in direction
+        int p[3], q[3];
+
+        p[d] = s;
+        q[d] = s + dir;
+
+        for (int j = 0; j < sv; ++j) {
+          for (int i = 0; i < su; ++i) {
+            p[u] = i; q[u] = i;
+            p[v] = j; q[v] = j;
+
+            auto c = cell(p);
+
+            mask[size_t(j)*su + i] = (c && ! cell(q) ? c : 0);
+          }
+        }
+
+        // cover mask with same color rectangles
+        for (int j = 0; j < sv; ++j) {
+          for (int i = 0; i < su; ) {
+            auto c = mask[size_t(j)*su + i];
+
+            if (! c) {
+              ++i;
+              continue;
+            }
+
+            int w = 1;
+
+            while (i + w < su && mask[size_t(j)*su + i + w] == c)
+              ++w;
+
+            int h = 1;
+
+            for ( ; j + h < sv; ++h) {
+              auto *row = &mask[size_t(j + h)*su + i];
+
+              if (std::any_of(row, row + w, [&](uint16_t c1) { return c1 != c; }))
+                break;
+            }
+
+            for (int k = 0; k < h; ++k) {
+              auto *row = &mask[size_t(j + k)*su + i];
+
+              std::fill(row, row + w, uint16_t(0));
+            }
+
+            // quad on face plane (u x v is along d so reverse for negative direction)
+            int corners[4][2] = { { i, j }, { i + w, j }, { i + w, j + h }, { i, j + h } };
+
+            uint inds[4];
+
+            for (int k = 0; k < 4; ++k) {
+              int pc[3];
+
+              pc[d] = (dir > 0 ? s + 1 : s);
+              pc[u] = corners[k][0];
+              pc[v] = corners[k][1];
+
+              inds[dir > 0 ? k : 3 - k] = cornerInd(pc);
+            }
+
+            auto faceNum = object_->addIPolygon(inds, 4);
+
+            object_->getFace(faceNum).setColor(voxel.color(c - 1));
+
+            i += w;
+          }
+        }
+      }
+    }
+  }
 }
@@ -0,0 +1,516 @@
+#include <CImportXML.h>
+
+#include <algorithm>
+#include <charconv>
+#include <iostream>
+#include <cstring>
+
+namespace {
+
+bool isSpace(char c) {
+  return (c == ' ' || c == '\t' || c == '\n' || c == '\r');
+}
+
+bool isNameEnd(char c) {
+  return (isSpace(c) || c == '>' || c == '/' || c == '=');
+}
+
+void appendUtf8(std::string &str, unsigned long c) {
+  if      (c < 0x80)
+    str += char(c);
+  else if (c < 0x800) {
+    str += char(0xC0 | (c >> 6));
+    str += char(0x80 | (c & 0x3F));
+  }
+  else if (c < 0x10000) {
+    str += char(0xE0 | (c >> 12));
+    str += char(0x80 | ((c >> 6) & 0x3F));
+    str += char(0x80 | (c & 0x3F));
+  }
+  else {
+    str += char(0xF0 | (c >> 18));
+    str += char(0x80 | ((c >> 12) & 0x3F));
+    str += char(0x80 | ((c >> 6) & 0x3F));
+    str += char(0x80 | (c & 0x3F));
+  }
+}
+
+}
+
+//---
+
+CImportXMLToken::
+~CImportXMLToken()
+{
+  delete tag_;
+}
+
+CImportXMLTag::
+~CImportXMLTag()
+{
+  for (auto *option : options_)
+    delete option;
+
+  for (auto *child : children_)
+    delete child;
+}
+
+//---
+
+bool
+CImportXML::
+read(const char *data, size_t len, const TagFunc &rootFunc, const TagFunc &childFunc)
+{
+  data_ = data;
+  pos_  = data;
+  end_  = data + len;
+
+  numErrors_ = 0;
+  errorMsg_  = "";
+
+  // skip UTF-8 byte order mark
+  if (isNext("\xEF\xBB\xBF"))
+    pos_ += 3;
+
+  if (! skipMisc())
+    return false;
+
+  if (pos_ >= end_)
+    return fail("Missing root tag");
+
+  CImportXMLTag *root = nullptr;
+  bool           empty;
+
+  if (! readStartTag(nullptr, root, empty)) {
+    delete root;
+    return false;
+  }
+
+  bool rc = rootFunc(root);
+
+  if (rc && ! empty)
+    rc = readContent(root, &childFunc);
+
+  delete root;
+
+  return rc;
+}
+
+// skip prolog, comments, processing instructions and doctype
+bool
+CImportXML::
+skipMisc()
+{
+  for (;;) {
+    skipSpace();
+
+    if      (isNext("<?")) {
+      if (! skipTo("?>"))
+        return fail("Unterminated processing instruction");
+    }
+    else if (isNext("<!--")) {
+      if (! skipTo("-->"))
+        return fail("Unterminated comment");
+    }
+    else if (isNext("<!")) {
+      // doctype (may contain bracketed internal subset)
+      int brackets = 0;
+
+      for (pos_ += 2; pos_ < end_; ++pos_) {
+        if      (*pos_ == '[') ++brackets;
+        else if (*pos_ == ']') --brackets;
+        else if (*pos_ == '>' && brackets <= 0) break;
+      }
+
+      if (pos_ >= end_)
+        return fail("Unterminated doctype");
+
+      ++pos_;
+    }
+    else
+      break;
+  }
+
+  return true;
+}
+
+// move past next occurrence of str
+bool
+CImportXML::
+skipTo(const char *str)
+{
+  auto len = strlen(str);
+
+  auto *p = std::search(pos_, end_, str, str + len);
+
+  if (p == end_) {
+    pos_ = end_;
+    return false;
+  }
+
+  pos_ = p + len;
+
+  return true;
+}
+
+bool
+CImportXML::
+readStartTag(CImportXMLTag *parent, CImportXMLTag* &tag, bool &empty)
+{
+  ++pos_; // '<'
+
+  std::string name;
+
+  if (! readName(name))
+    return fail("Missing tag name");
+
+  tag = new CImportXMLTag(parent, name);
+
+  empty = false;
+
+  for (;;) {
+    skipSpace();
+
+    if (pos_ >= end_)
+      return fail("Unterminated tag '" + name + "'");
+
+    if (*pos_ == '>') {
+      ++pos_;
+      break;
+    }
+
+    if (isNext("/>")) {
+      pos_ += 2;
+      empty = true;
+      break;
+    }
+
+    std::string optName;
+
+    if (! readName(optName))
+      return fail("Bad option for tag '" + name + "'");
+
+    skipSpace();
+
+    if (pos_ >= end_ || *pos_ != '=')
+      return fail("Missing '=' for option '" + optName + "'");
+
+    ++pos_;
+
+    skipSpace();
+
+    if (pos_ >= end_ || (*pos_ != '"' && *pos_ != '\''))
+      return fail("Missing quote for option '" + optName + "'");
+
+    auto quote = *pos_++;
+
+    auto *s = pos_;
+
+    while (pos_ < end_ && *pos_ != quote)
+      ++pos_;
+
+    if (pos_ >= end_)
+      return fail("Unterminated value for option '" + optName + "'");
+
+    std::string optValue;
+
+    decodeText(s, pos_, optValue);
+
+    ++pos_;
+
+    tag->options_.push_back(new CImportXMLOption(optName, optValue));
+  }
+
+  return true;
+}
+
+bool
+CImportXML::
+readEndTag(const CImportXMLTag *tag)
+{
+  pos_ += 2; // '</'
+
+  std::string name;
+
+  if (! readName(name))
+    return fail("Missing end tag name");
+
+  if (name != tag->getName())
+    return fail("Mismatched end tag '" + name + "' for '" + tag->getName() + "'");
+
+  skipSpace();
+
+  if (pos_ >= end_ || *pos_ != '>')
+    return fail("Unterminated end tag '" + name + "'");
+
+  ++pos_;
+
+  return true;
+}
+
+// read children and text up to end tag (children passed to childFunc and deleted
+// when specified, otherwise added to tag)
+bool
+CImportXML::
+readContent(CImportXMLTag *tag, const TagFunc *childFunc)
+{
+  auto arrayType = ArrayType::NONE;
+
+  if      (realTags_.find(tag->getName()) != realTags_.end())
+    arrayType = ArrayType::REAL;
+  else if (intTags_.find(tag->getName()) != intTags_.end())
+    arrayType = ArrayType::INT;
+
+  for (;;) {
+    if (pos_ >= end_)
+      return fail("Missing end tag for '" + tag->getName() + "'");
+
+    if (*pos_ != '<') {
+      if (arrayType != ArrayType::NONE) {
+        if (! readNumbers(tag, arrayType))
+          return false;
+      }
+      else {
+        if (! readText(tag))
+          return false;
+      }
+
+      continue;
+    }
+
+    if      (isNext("</")) {
+      if (! readEndTag(tag))
+        return false;
+
+      break;
+    }
+    else if (isNext("<!--")) {
+      if (! skipTo("-->"))
+        return fail("Unterminated comment");
+    }
+    else if (isNext("<![CDATA[")) {
+      pos_ += 9;
+
+      auto *s = pos_;
+
+      if (! skipTo("]]>"))
+        return fail("Unterminated CDATA");
+
+      tag->text_.append(s, pos_ - 3);
+    }
+    else if (isNext("<?")) {
+      if (! skipTo("?>"))
+        return fail("Unterminated processing instruction");
+    }
+    else {
+      CImportXMLTag *child = nullptr;
+      bool           empty;
+
+      if (! readStartTag(tag, child, empty)) {
+        delete child;
+        return false;
+      }
+
+      if (! empty && ! readContent(child, nullptr)) {
+        delete child;
+        return false;
+      }
+
+      if (childFunc) {
+        bool rc = (*childFunc)(child);
+
+        delete child;
+
+        if (! rc)
+          return false;
+      }
+      else
+        tag->children_.push_back(new CImportXMLToken(child));
+    }
+  }
+
+  // trim text
+  auto &text = tag->text_;
+
+  auto p1 = text.find_first_not_of(" \t\r\n");
+
+  if (p1 == std::string::npos)
+    text.clear();
+  else {
+    auto p2 = text.find_last_not_of(" \t\r\n");
+
+    text = text.substr(p1, p2 - p1 + 1);
+  }
+
+  return true;
+}
+
+bool
+CImportXML::
+readText(CImportXMLTag *tag)
+{
+  auto *s = pos_;
+
+  while (pos_ < end_ && *pos_ != '<')
+    ++pos_;
+
+  decodeText(s, pos_, tag->text_);
+
+  return true;
+}
+
+// parse whitespace separated numbers up to next tag
+bool
+CImportXML::
+readNumbers(CImportXMLTag *tag, ArrayType type)
+{
+  // size from count option
+  if (tag->reals_.empty() && tag->ints_.empty()) {
+    for (const auto *option : tag->options_) {
+      if (option->getName() != "count")
+        continue;
+
+      long count = 0;
+
+      const auto &value = option->getValue();
+
+      std::from_chars(value.data(), value.data() + value.size(), count);
+
+      if (count > 0) {
+        // cap to max numbers remaining text can hold (one char plus separator each)
+        auto n = std::min<size_t>(size_t(count), size_t(end_ - pos_)/2 + 1);
+
+        if (type == ArrayType::REAL)
+          tag->reals_.reserve(n);
+        else
+          tag->ints_.reserve(n);
+      }
+    }
+  }
+
+  for (;;) {
+    skipSpace();
+
+    if (pos_ >= end_ || *pos_ == '<')
+      break;
+
+    auto *s = pos_;
+
+    while (pos_ < end_ && ! isSpace(*pos_) && *pos_ != '<')
+      ++pos_;
+
+    auto *s1 = (*s == '+' ? s + 1 : s);
+
+    bool ok;
+
+    if (type == ArrayType::REAL) {
+      double r = 0.0;
+
+      auto res = std::from_chars(s1, pos_, r);
+
+      ok = (res.ec == std::errc() && res.ptr == pos_);
+
+      tag->reals_.push_back(ok ? r : 0.0);
+    }
+    else {
+      int i = 0;
+
+      auto res = std::from_chars(s1, pos_, i);
+
+      ok = (res.ec == std::errc() && res.ptr == pos_);
+
+      tag->ints_.push_back(ok ? i : 0);
+    }
+
+    if (! ok && numErrors_++ < 10)
+      std::cerr << "Invalid " << tag->getName() << " value '" << std::string(s, pos_) << "'\n";
+  }
+
+  return true;
+}
+
+bool
+CImportXML::
+readName(std::string &name)
+{
+  auto *s = pos_;
+
+  while (pos_ < end_ && ! isNameEnd(*pos_))
+    ++pos_;
+
+  name = std::string(s, pos_);
+
+  return ! name.empty();
+}
+
+// append text decoding entity references
+void
+CImportXML::
+decodeText(const char *s, const char *e, std::string &str) const
+{
+  while (s < e) {
+    auto *amp = std::find(s, e, '&');
+
+    str.append(s, amp);
+
+    if (amp == e)
+      break;
+
+    auto *semi = std::find(amp, e, ';');
+
+    if (semi == e) {
+      str.append(amp, e);
+      break;
+    }
+
+    auto ref = std::string(amp + 1, semi);
+
+    if      (ref == "lt"  ) str += '<';
+    else if (ref == "gt"  ) str += '>';
+    else if (ref == "amp" ) str += '&';
+    else if (ref == "quot") str += '"';
+    else if (ref == "apos") str += '\'';
+    else if (ref.size() > 1 && ref[0] == '#') {
+      unsigned long c = 0;
+
+      if (ref[1] == 'x' || ref[1] == 'X')
+        std::from_chars(ref.data() + 2, ref.data() + ref.size(), c, 16);
+      else
+        std::from_chars(ref.data() + 1, ref.data() + ref.size(), c, 10);
+
+      appendUtf8(str, c);
+    }
+    else
+      str.append(amp, semi + 1);
+
+    s = semi + 1;
+  }
+}
+
+void
+CImportXML::
+skipSpace()
+{
+  while (pos_ < end_ && isSpace(*pos_))
+    ++pos_;
+}
+
+bool
+CImportXML::
+isNext(const char *str) const
+{
+  auto len = strlen(str);
+
+  return (size_t(end_ - pos_) >= len && memcmp(pos_, str, len) == 0);
+}
+
+bool
+CImportXML::
+fail(const std::string &msg)
+{
+  auto line = 1 + std::count(data_, std::min(pos_, end_), '\n');
+
+  errorMsg_ = msg + " (line " + std::to_string(line) + ")";
+
+  return false;
+}
@@ -0,0 +1,183 @@
+#include <CSGMesh.h>
+#include <CStrUtil.h>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+namespace {
+
+auto exitMsg(const std::string &msg) -> int {
+  std::cerr << "\033[33mError\033[0m: " << msg << "\n";
+  return 1;
+}
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedSecs(const Clock::time_point &t1) {
+  return std::chrono::duration<double>(Clock::now() - t1).count();
+}
+
+struct BenchResult {
+  double secs        { 0.0 };
+  size_t numPolygons { 0 };
+};
+
+// scene CSG primitives (cube, sphere, cylinder) combined with each operation
+enum class Op {
+  UNION,
+  SUBTRACT,
+  INTERSECT
+};
+
+const char *opName(Op op) {
+  switch (op) {
+    case Op::UNION   : return "union";
+    case Op::SUBTRACT: return "subtract";
+    default          : return "intersect";
+  }
+}
+
+BenchResult benchOld(Op op, int slices, int stacks) {
+  auto t1 = Clock::now();
+
+  auto *cube     = CSG::cube();
+  auto *sphere   = CSG::sphere(CSG::Vector(0, 0, 0), 1.3, slices, stacks);
+  auto *cylinder = CSG::cylinder(CSG::Vector(0, -2, 0), CSG::Vector(0, 2, 0), 0.5, slices);
+
+  CSG::CSG *csg1 = nullptr, *csg2 = nullptr;
+
+  switch (op) {
+    case Op::UNION   : csg1 = cube->unionOp    (sphere); csg2 = csg1->unionOp    (cylinder); break;
+    case Op::SUBTRACT: csg1 = cube->subtractOp (sphere); csg2 = csg1->subtractOp (cylinder); break;
+    default          : csg1 = cube->intersectOp(sphere); csg2 = csg1->intersectOp(cylinder); break;
+  }
+
+  BenchResult result;
+
+  result.numPolygons = csg2->toPolygons().size();
+  result.secs        = elapsedSecs(t1);
+
+  delete cube;
+  delete sphere;
+  delete cylinder;
+  delete csg1;
+  delete csg2;
+
+  return result;
+}
+
+BenchResult benchMesh(Op op, int slices, int stacks, const CSG::Mesh::Options &options) {
+  auto t1 = Clock::now();
+
+  auto cube     = CSG::Mesh::cube();
+  auto sphere   = CSG::Mesh::sphere(CSG::Vector(0, 0, 0), 1.3, slices, stacks);
+  auto cylinder = CSG::Mesh::cylinder(CSG::Vector(0, -2, 0), CSG::Vector(0, 2, 0), 0.5, slices);
+
+  CSG::Mesh mesh;
+
+  switch (op) {
+    case Op::UNION:
+      mesh = cube.unionOp(sphere, options).unionOp(cylinder, options); break;
+    case Op::SUBTRACT:
+      mesh = cube.subtractOp(sphere, options).subtractOp(cylinder, options); break;
+    default:
+      mesh = cube.intersectOp(sphere, options).intersectOp(cylinder, options); break;
+  }
+
+  BenchResult result;
+
+  result.numPolygons = mesh.numPolygons();
+  result.secs        = elapsedSecs(t1);
+
+  return result;
+}
+
+}
+
+//---
+
+// compare CSG (pointer based) and CSG::Mesh (index based) on scene primitives
+//  -slices <n>  : sphere/cylinder slices
+//  -stacks <n>  : sphere stacks
+//  -repeat <n>  : number of runs (best time reported)
+//  -threads <n> : CSG::Mesh threads (0 for one per core)
+//  -robust      : CSG::Mesh robust (snapped) mode
+int
+main(int argc, char **argv)
+{
+  int slices = 96;
+  int stacks = 64;
+  int repeat = 3;
+  int threads = 1;
+
+  CSG::Mesh::Options options;
+
+  for (int i = 1; i < argc; ++i) {
+    if (argv[i][0] != '-')
+      return exitMsg("Invalid arg '" + std::string(argv[i]) + "'");
+
+    auto arg = std::string(&argv[i][1]);
+
+    if (arg == "h" || arg == "help") {
+      std::cerr << "CSGBench [-slices <n>] [-stacks <n>] [-repeat <n>] [-threads <n>] [-robust]\n";
+      return 0;
+    }
+
+    if (arg == "robust") {
+      options.robust = true;
+      continue;
+    }
+
+    ++i;
+
+    if (i >= argc)
+      return exitMsg("Missing value for '-" + arg + "'");
+
+    int *value = nullptr;
+    int  minValue = 0;
+
+    if      (arg == "slices" ) { value = &slices ; minValue = 3; }
+    else if (arg == "stacks" ) { value = &stacks ; minValue = 2; }
+    else if (arg == "repeat" ) { value = &repeat ; minValue = 1; }
+    else if (arg == "threads") { value = &threads; minValue = 0; }
+    else
+      return exitMsg("Invalid arg '" + arg + "'");
+
+    int n;
+
+    if (! CStrUtil::toInteger(argv[i], &n) || n < minValue)
+      return exitMsg("Invalid value '" + std::string(argv[i]) + "' for '-" + arg + "' (min " +
+                     std::to_string(minValue) + ")");
+
+    *value = n;
+  }
+
+  options.numThreads = uint(threads);
+
+  std::cout << "slices=" << slices << " stacks=" << stacks << " threads=" << threads <<
+               (options.robust ? " robust" : "") << "\n";
+
+  for (auto op : {Op::UNION, Op::SUBTRACT, Op::INTERSECT}) {
+    BenchResult oldResult, meshResult;
+
+    for (int i = 0; i < repeat; ++i) {
+      auto oldResult1  = benchOld (op, slices, stacks);
+      auto meshResult1 = benchMesh(op, slices, stacks, options);
+
+      if (i == 0 || oldResult1 .secs < oldResult .secs) oldResult  = oldResult1;
+      if (i == 0 || meshResult1.secs < meshResult.secs) meshResult = meshResult1;
+    }
+
+    std::cout << opName(op) << ": old " << oldResult.secs << "s (" <<
+                 oldResult.numPolygons << " polygons) mesh " << meshResult.secs << "s (" <<
+                 meshResult.numPolygons << " polygons)";
+
+    if (meshResult.secs > 0.0)
+      std::cout << " speedup: " << oldResult.secs/meshResult.secs << "x";
+
+    std::cout << "\n";
+  }
+
+  return 0;
+}
@@ -0,0 +1,1494 @@
+#include <CSGMesh.h>
+#include <CImportParallel.h>
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <utility>
+#include <cassert>
+#include <cmath>
+
+namespace CSG {
+
+namespace {
+
+// tolerance used to decide if a point is on a plane
+const double EPSILON = 1e-5;
+
+// robust mode coordinates are integers on a grid (at most 2^30 grid units from the
+// origin) so exact plane tests fit in 128 bit integers
+using Int128 = __int128;
+
+const double MAX_GRID_COORD = double(1 << 30);
+
+// distance (in grid units) within which a point is on an exact plane
+const int SNAP_TOLERANCE = 2;
+
+Int128 toInt(double r) {
+  return Int128(static_cast<long long>(r));
+}
+
+Int128 absInt(Int128 i) {
+  return (i < 0 ? -i : i);
+}
+
+Int128 gcdInt(Int128 a, Int128 b) {
+  a = absInt(a);
+  b = absInt(b);
+
+  while (b != 0) {
+    auto t = a % b;
+
+    a = b;
+    b = t;
+  }
+
+  return a;
+}
+
+enum SideType {
+  COPLANAR = 0,
+  FRONT    = 1,
+  BACK     = 2,
+  SPANNING = 3
+};
+
+struct PlaneData {
+  Vector normal;
+  double w { 0.0 };
+
+  // exact plane (robust mode): point p is on plane if |in.p - id| <= itol
+  Int128 in[3] { 0, 0, 0 };
+  Int128 id    { 0 };
+  Int128 itol  { 0 };
+
+  static PlaneData fromPoints(const Vector &a, const Vector &b, const Vector &c) {
+    auto n = b.minus(a).cross(c.minus(a)).unit();
+
+    return PlaneData { n, n.dot(a) };
+  }
+
+  // plane from exact (non-zero) normal through grid point p
+  static PlaneData fromExact(const Int128 n[3], const Vector &p) {
+    PlaneData plane;
+
+    for (int i = 0; i < 3; ++i)
+      plane.in[i] = n[i];
+
+    plane.id   = n[0]*toInt(p.x) + n[1]*toInt(p.y) + n[2]*toInt(p.z);
+    plane.itol = SNAP_TOLERANCE*(absInt(n[0]) + absInt(n[1]) + absInt(n[2]));
+
+    plane.normal = Vector(double(n[0]), double(n[1]), double(n[2])).unit();
+    plane.w      = plane.normal.dot(p);
+
+    return plane;
+  }
+
+  bool isExactSame(const PlaneData &plane) const {
+    return (in[0] == plane.in[0] && in[1] == plane.in[1] && in[2] == plane.in[2] &&
+            id == plane.id);
+  }
+
+  bool isExactOpposite(const PlaneData &plane) const {
+    return (in[0] == -plane.in[0] && in[1] == -plane.in[1] && in[2] == -plane.in[2] &&
+            id == -plane.id);
+  }
+
+  Int128 exactSide(const Vector &p) const {
+    return in[0]*toInt(p.x) + in[1]*toInt(p.y) + in[2]*toInt(p.z) - id;
+  }
+
+  void flip() {
+    normal = normal.negated();
+    w      = -w;
+
+    for (int i = 0; i < 3; ++i)
+      in[i] = -in[i];
+
+    id = -id;
+  }
+};
+
+// Storage for one CSG operation.
+//
+// Both operand trees live in the same arrays and are referenced by root node index.
+// Polygons are index ranges into the index array (split polygons get new ranges, the
+// vertices created at a split are shared by the front and back pieces).
+//
+// Parallel work runs in child arenas which read the parent's data (indices below
+// their base) and append new data locally. Children are merged back in task order,
+// which gives the same trees as the serial path.
+//
+// In robust mode vertex positions are stored as integer grid coordinates, planes are
+// exact (Newell normal of the grid points) and split vertices are snapped back to the
+// grid. Fragments which collapse to zero area are dropped and coplanar fragments are
+// merged again when the result is output.
+class Arena {
+ public:
+  using PolyList = std::vector<uint>;
+
+  Arena(const Mesh &mesh1, const Mesh &mesh2, const Mesh::Options &options) :
+   numThreads_(CImportParallel::numThreads(options.numThreads)),
+   robust_(options.robust), grid_(options.snapSize) {
+    auto nv = mesh1.vertices().size() + mesh2.vertices().size();
+    auto ni = mesh1.indices ().size() + mesh2.indices ().size();
+    auto np = mesh1.polygons().size() + mesh2.polygons().size();
+
+    verts_.reserve(2*nv);
+    inds_ .reserve(2*ni);
+    polys_.reserve(2*np);
+    nodes_.reserve(np);
+
+    // serial below depth where there are a few tasks per thread
+    while ((1U << parallelDepth_) < 4*numThreads_)
+      ++parallelDepth_;
+
+    // grid coarse enough for all coordinates to fit in range
+    if (robust_) {
+      if (grid_ <= 0.0)
+        grid_ = EPSILON;
+
+      double maxCoord = 0.0;
+
+      for (const auto *mesh : {&mesh1, &mesh2}) {
+        for (const auto &v : mesh->vertices())
+          maxCoord = std::max({maxCoord, std::abs(v.pos.x), std::abs(v.pos.y), std::abs(v.pos.z)});
+      }
+
+      grid_ = std::max(grid_, maxCoord/MAX_GRID_COORD);
+    }
+  }
+
+  explicit Arena(const Arena *parent) :
+   parent_  (parent), robust_(parent->robust_), grid_(parent->grid_),
+   vertBase_(parent->numVerts()), indBase_ (parent->numInds ()),
+   polyBase_(parent->numPolys()), nodeBase_(parent->numNodes()) {
+  }
+
+  Arena(const Arena &) = delete;
+  Arena &operator=(const Arena &) = delete;
+
+  //! add meshes as new trees (returns root nodes)
+  void addMeshes(const Mesh &mesh1, const Mesh &mesh2, uint &root1, uint &root2);
+
+  //! remove polygons in tree a that are inside tree b
+  void clipTo(uint a, uint b);
+
+  //! swap solid and empty space
+  void invert(uint root);
+
+  PolyList allPolygons(uint root) const;
+
+  //! add polygons to tree (filtered down to leaves)
+  void buildTree(uint root, PolyList polys);
+
+  Mesh toMesh(uint root) const;
+
+ private:
+  struct Poly {
+    uint      first   { 0 };
+    uint      count   { 0 };
+    uint      tag     { 0 };
+    bool      flipped { false };
+    PlaneData plane;
+  };
+
+  struct Node {
+    PlaneData plane;
+    bool      hasPlane { false };
+    int       front    { -1 };
+    int       back     { -1 };
+    PolyList  polys;
+  };
+
+  using Verts = std::vector<Mesh::Vertex>;
+  using Inds  = std::vector<uint>;
+  using Polys = std::vector<Poly>;
+  using Nodes = std::vector<Node>;
+  using Types = std::vector<int>;
+
+  // output polygon (robust mode merges coplanar ones sharing an edge)
+  struct OutPoly {
+    uint poly     { 0 };     //!< source polygon
+    uint tag      { 0 };
+    bool flipped  { false };
+    uint group    { 0 };     //!< polygons with same plane, tag and orientation
+    int  axis     { 2 };     //!< dominant normal axis
+    bool positive { true };  //!< dominant normal component positive
+    Inds inds;               //!< arena vertices
+    Inds posIds;             //!< unique vertex positions
+  };
+
+  using OutPolys = std::vector<OutPoly>;
+
+  // polygons to build into a new front or back subtree of node
+  struct BuildTask {
+    uint     node  { 0 };
+    bool     front { false };
+    PolyList polys;
+  };
+
+  using BuildTasks = std::vector<BuildTask>;
+
+  uint numVerts() const { return vertBase_ + uint(verts_.size()); }
+  uint numInds () const { return indBase_  + uint(inds_ .size()); }
+  uint numPolys() const { return polyBase_ + uint(polys_.size()); }
+  uint numNodes() const { return nodeBase_ + uint(nodes_.size()); }
+
+  const Mesh::Vertex &vert(uint i) const {
+    return (i < vertBase_ ? parent_->vert(i) : verts_[i - vertBase_]); }
+  uint ind(uint i) const {
+    return (i < indBase_ ? parent_->ind(i) : inds_[i - indBase_]); }
+  const Poly &poly(uint i) const {
+    return (i < polyBase_ ? parent_->poly(i) : polys_[i - polyBase_]); }
+  const Node &node(uint i) const {
+    return (i < nodeBase_ ? parent_->node(i) : nodes_[i - nodeBase_]); }
+
+  // only local nodes can be changed
+  Node &localNode(uint i) {
+    assert(i >= nodeBase_);
+
+    return nodes_[i - nodeBase_];
+  }
+
+  uint newNode() {
+    nodes_.emplace_back();
+
+    return numNodes() - 1;
+  }
+
+  uint addMesh(const Mesh &mesh, BuildTasks &tasks);
+
+  //! grid coordinates of point (robust mode)
+  Vector snap(const Vector &p) const {
+    return Vector(std::round(p.x/grid_), std::round(p.y/grid_), std::round(p.z/grid_)); }
+
+  //! remove repeated grid points and check polygon has non-zero area (robust mode)
+  bool cleanPolygon(Inds &inds, Int128 normal[3]) const;
+
+  void mergeCoplanar(OutPolys &polys) const;
+
+  bool mergePolys(const OutPoly &poly1, uint i1, const OutPoly &poly2, OutPoly &poly) const;
+
+  bool isConvex(const OutPoly &poly) const;
+
+  void build(uint root, PolyList polys, BuildTasks *tasks);
+
+  void runBuildTasks(BuildTasks &tasks);
+
+  void treeNodes(uint root, PolyList &nodes) const;
+
+  PolyList clipPolygons(uint root, PolyList polys);
+
+  void splitPolygon(const PlaneData &plane, uint poly, PolyList &coplanarFront,
+                    PolyList &coplanarBack, PolyList &front, PolyList &back);
+
+  //! append child arena data (child indices shifted past current data)
+  void merge(const Arena &child);
+
+  uint remapPoly(const Arena &child, uint pi) const {
+    return (pi >= child.polyBase_ ? pi + (numPolys() - child.numPolys()) : pi); }
+
+ private:
+  const Arena* parent_        { nullptr };
+  uint         numThreads_    { 1 };
+  uint         parallelDepth_ { 1 };
+  bool         robust_        { false };
+  double       grid_          { EPSILON };
+
+  uint vertBase_ { 0 };
+  uint indBase_  { 0 };
+  uint polyBase_ { 0 };
+  uint nodeBase_ { 0 };
+
+  Verts verts_;
+  Inds  inds_;
+  Polys polys_;
+  Nodes nodes_;
+
+  // split scratch
+  Types               types_;
+  std::vector<Int128> sides_;
+  Inds                pinds_, finds_, binds_;
+};
+
+// min polygons for separate build or clip task
+const size_t MIN_TASK_POLYS = 64;
+
+void
+Arena::
+addMeshes(const Mesh &mesh1, const Mesh &mesh2, uint &root1, uint &root2)
+{
+  // top of both trees built serially, subtrees of both built in parallel
+  BuildTasks tasks;
+
+  root1 = addMesh(mesh1, tasks);
+  root2 = addMesh(mesh2, tasks);
+
+  runBuildTasks(tasks);
+}
+
+uint
+Arena::
+addMesh(const Mesh &mesh, BuildTasks &tasks)
+{
+  auto vertexOffset = numVerts();
+
+  verts_.insert(verts_.end(), mesh.vertices().begin(), mesh.vertices().end());
+
+  if (robust_) {
+    for (auto i = vertexOffset; i < numVerts(); ++i)
+      verts_[i].pos = snap(verts_[i].pos);
+  }
+
+  PolyList polys;
+
+  polys.reserve(mesh.polygons().size());
+
+  Inds pinds;
+
+  for (const auto &polygon : mesh.polygons()) {
+    pinds.clear();
+
+    for (uint i = 0; i < polygon.count; ++i)
+      pinds.push_back(vertexOffset + mesh.indices()[polygon.first + i]);
+
+    Poly poly;
+
+    if (robust_) {
+      Int128 normal[3];
+
+      // drop polygons collapsed by snapping
+      if (! cleanPolygon(pinds, normal))
+        continue;
+
+      poly.plane = PlaneData::fromExact(normal, vert(pinds[0]).pos);
+    }
+    else {
+      const auto &p1 = vert(pinds[0]).pos;
+      const auto &p2 = vert(pinds[1]).pos;
+      const auto &p3 = vert(pinds[2]).pos;
+
+      poly.plane = PlaneData::fromPoints(p1, p2, p3);
+    }
+
+    poly.first = numInds();
+    poly.count = uint(pinds.size());
+    poly.tag   = polygon.tag;
+
+    inds_.insert(inds_.end(), pinds.begin(), pinds.end());
+
+    polys.push_back(numPolys());
+
+    polys_.push_back(poly);
+  }
+
+  auto root = newNode();
+
+  build(root, std::move(polys), &tasks);
+
+  return root;
+}
+
+void
+Arena::
+buildTree(uint root, PolyList polys)
+{
+  BuildTasks tasks;
+
+  build(root, std::move(polys), &tasks);
+
+  runBuildTasks(tasks);
+}
+
+void
+Arena::
+treeNodes(uint root, PolyList &nodes) const
+{
+  nodes.clear();
+
+  PolyList stack;
+
+  stack.push_back(root);
+
+  while (! stack.empty()) {
+    auto ni = stack.back();
+
+    stack.pop_back();
+
+    nodes.push_back(ni);
+
+    const auto &node1 = node(ni);
+
+    if (node1.back  >= 0) stack.push_back(uint(node1.back ));
+    if (node1.front >= 0) stack.push_back(uint(node1.front));
+  }
+}
+
+void
+Arena::
+invert(uint root)
+{
+  assert(! parent_);
+
+  PolyList nodes;
+
+  treeNodes(root, nodes);
+
+  for (auto ni : nodes) {
+    auto &node = nodes_[ni];
+
+    for (auto pi : node.polys) {
+      auto &poly = polys_[pi];
+
+      std::reverse(inds_.begin() + poly.first, inds_.begin() + poly.first + poly.count);
+
+      poly.flipped = ! poly.flipped;
+
+      poly.plane.flip();
+    }
+
+    node.plane.flip();
+
+    std::swap(node.front, node.back);
+  }
+}
+
+// remove all polygons in polys that are inside tree
+Arena::PolyList
+Arena::
+clipPolygons(uint root, PolyList polys)
+{
+  PolyList result;
+
+  std::vector<std::pair<uint, PolyList>> stack;
+
+  stack.emplace_back(root, std::move(polys));
+
+  // depth first (front before back) to keep result order of recursive clip
+  while (! stack.empty()) {
+    auto ni     = stack.back().first;
+    auto polys1 = std::move(stack.back().second);
+
+    stack.pop_back();
+
+    const auto &node1 = node(ni);
+
+    if (! node1.hasPlane) {
+      result.insert(result.end(), polys1.begin(), polys1.end());
+      continue;
+    }
+
+    PolyList front, back;
+
+    for (auto pi : polys1)
+      splitPolygon(node1.plane, pi, front, back, front, back);
+
+    if (node1.back >= 0 && ! back.empty())
+      stack.emplace_back(uint(node1.back), std::move(back));
+
+    if (node1.front >= 0) {
+      if (! front.empty())
+        stack.emplace_back(uint(node1.front), std::move(front));
+    }
+    else
+      result.insert(result.end(), front.begin(), front.end());
+  }
+
+  return result;
+}
+
+// nodes of tree a are clipped in parallel chunks (child arenas merged in node order)
+void
+Arena::
+clipTo(uint a, uint b)
+{
+  assert(! parent_);
+
+  PolyList nodes;
+
+  treeNodes(a, nodes);
+
+  size_t numPolys = 0;
+
+  for (auto ni : nodes)
+    numPolys += nodes_[ni].polys.size();
+
+  if (numThreads_ <= 1 || numPolys < 2*MIN_TASK_POLYS) {
+    for (auto ni : nodes)
+      nodes_[ni].polys = clipPolygons(b, std::move(nodes_[ni].polys));
+
+    return;
+  }
+
+  // split nodes into chunks of similar polygon count
+  auto chunkPolys = std::max(numPolys/(4*numThreads_), MIN_TASK_POLYS);
+
+  std::vector<size_t> chunkStart;
+
+  size_t n = 0;
+
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    if (n == 0)
+      chunkStart.push_back(i);
+
+    n += nodes_[nodes[i]].polys.size();
+
+    if (n >= chunkPolys)
+      n = 0;
+  }
+
+  auto numChunks = chunkStart.size();
+
+  chunkStart.push_back(nodes.size());
+
+  std::vector<std::unique_ptr<Arena>> children(numChunks);
+  std::vector<PolyList>               results (nodes.size());
+
+  CImportParallel::parallelFor(numChunks, numThreads_, [&](size_t ic) {
+    auto child = std::make_unique<Arena>(this);
+
+    for (auto i = chunkStart[ic]; i < chunkStart[ic + 1]; ++i)
+      results[i] = child->clipPolygons(b, nodes_[nodes[i]].polys);
+
+    children[ic] = std::move(child);
+  });
+
+  for (size_t ic = 0; ic < numChunks; ++ic) {
+    const auto &child = *children[ic];
+
+    merge(child);
+
+    for (auto i = chunkStart[ic]; i < chunkStart[ic + 1]; ++i) {
+      for (auto &pi : results[i])
+        pi = remapPoly(child, pi);
+
+      nodes_[nodes[i]].polys = std::move(results[i]);
+    }
+
+    children[ic].reset();
+  }
+}
+
+Arena::PolyList
+Arena::
+allPolygons(uint root) const
+{
+  PolyList nodes;
+
+  treeNodes(root, nodes);
+
+  PolyList polys;
+
+  for (auto ni : nodes) {
+    const auto &node1 = node(ni);
+
+    polys.insert(polys.end(), node1.polys.begin(), node1.polys.end());
+  }
+
+  return polys;
+}
+
+// each set of polygons is partitioned using the first polygon. When tasks is set, large
+// polygon sets for new subtrees below the parallel depth are added as build tasks
+// instead of being built here
+void
+Arena::
+build(uint root, PolyList polys, BuildTasks *tasks)
+{
+  struct StackData {
+    uint     node;
+    uint     depth;
+    PolyList polys;
+  };
+
+  std::vector<StackData> stack;
+
+  stack.push_back(StackData { root, 0, std::move(polys) });
+
+  bool parallel = (tasks && numThreads_ > 1);
+
+  while (! stack.empty()) {
+    auto ni     = stack.back().node;
+    auto depth  = stack.back().depth;
+    auto polys1 = std::move(stack.back().polys);
+
+    stack.pop_back();
+
+    if (polys1.empty())
+      continue;
+
+    auto &node1 = localNode(ni);
+
+    if (! node1.hasPlane) {
+      node1.plane    = poly(polys1[0]).plane;
+      node1.hasPlane = true;
+    }
+
+    auto plane = node1.plane;
+
+    PolyList coplanar, front, back;
+
+    for (auto pi : polys1)
+      splitPolygon(plane, pi, coplanar, coplanar, front, back);
+
+    localNode(ni).polys.insert(localNode(ni).polys.end(), coplanar.begin(), coplanar.end());
+
+    // note: newNode may reallocate nodes_
+    auto addChild = [&](PolyList &childPolys, bool isFront) {
+      if (childPolys.empty())
+        return;
+
+      auto child = (isFront ? localNode(ni).front : localNode(ni).back);
+
+      if (child < 0) {
+        if (parallel && depth + 1 >= parallelDepth_ && childPolys.size() >= MIN_TASK_POLYS) {
+          tasks->push_back(BuildTask { ni, isFront, std::move(childPolys) });
+          return;
+        }
+
+        child = int(newNode());
+
+        if (isFront)
+          localNode(ni).front = child;
+        else
+          localNode(ni).back  = child;
+      }
+
+      stack.push_back(StackData { uint(child), depth + 1, std::move(childPolys) });
+    };
+
+    addChild(back , false);
+    addChild(front, true );
+  }
+}
+
+// build task subtrees in child arenas and merge them in task order
+void
+Arena::
+runBuildTasks(BuildTasks &tasks)
+{
+  if (tasks.empty())
+    return;
+
+  auto nt = tasks.size();
+
+  std::vector<std::unique_ptr<Arena>> children(nt);
+  std::vector<uint>                   roots   (nt);
+
+  CImportParallel::parallelFor(nt, numThreads_, [&](size_t i) {
+    auto child = std::make_unique<Arena>(this);
+
+    roots[i] = child->newNode();
+
+    child->build(roots[i], std::move(tasks[i].polys), nullptr);
+
+    children[i] = std::move(child);
+  });
+
+  for (size_t i = 0; i < nt; ++i) {
+    const auto &child = *children[i];
+
+    auto nodeShift = numNodes() - child.nodeBase_;
+
+    merge(child);
+
+    auto root = int(roots[i] + nodeShift);
+
+    auto &node = nodes_[tasks[i].node];
+
+    if (tasks[i].front)
+      node.front = root;
+    else
+      node.back  = root;
+
+    children[i].reset();
+  }
+
+  tasks.clear();
+}
+
+void
+Arena::
+merge(const Arena &child)
+{
+  assert(! parent_ && child.parent_ == this);
+
+  auto vertShift = numVerts() - child.vertBase_;
+  auto indShift  = numInds () - child.indBase_;
+  auto polyShift = numPolys() - child.polyBase_;
+  auto nodeShift = numNodes() - child.nodeBase_;
+
+  verts_.insert(verts_.end(), child.verts_.begin(), child.verts_.end());
+
+  for (auto vi : child.inds_)
+    inds_.push_back(vi >= child.vertBase_ ? vi + vertShift : vi);
+
+  for (auto poly : child.polys_) {
+    poly.first += indShift;
+
+    polys_.push_back(poly);
+  }
+
+  for (auto node : child.nodes_) {
+    if (node.front >= int(child.nodeBase_)) node.front += int(nodeShift);
+    if (node.back  >= int(child.nodeBase_)) node.back  += int(nodeShift);
+
+    for (auto &pi : node.polys) {
+      if (pi >= child.polyBase_)
+        pi += polyShift;
+    }
+
+    nodes_.push_back(std::move(node));
+  }
+}
+
+// split polygon by plane if needed, then put the polygon or polygon fragments in the
+// appropriate lists
+void
+Arena::
+splitPolygon(const PlaneData &plane, uint pi, PolyList &coplanarFront,
+             PolyList &coplanarBack, PolyList &front, PolyList &back)
+{
+  const auto &poly1 = poly(pi);
+
+  auto n = poly1.count;
+
+  // polygon on its own (inherited) plane is always coplanar, otherwise vertices
+  // snapped off the plane could split it forever
+  if (robust_) {
+    if      (poly1.plane.isExactSame(plane)) {
+      coplanarFront.push_back(pi);
+      return;
+    }
+    else if (poly1.plane.isExactOpposite(plane)) {
+      coplanarBack.push_back(pi);
+      return;
+    }
+  }
+
+  types_.resize(n);
+
+  if (robust_)
+    sides_.resize(n);
+
+  int polygonType = COPLANAR;
+
+  for (uint i = 0; i < n; ++i) {
+    const auto &pos = vert(ind(poly1.first + i)).pos;
+
+    int type = COPLANAR;
+
+    if (robust_) {
+      auto side = plane.exactSide(pos);
+
+      if      (side < -plane.itol) type = BACK;
+      else if (side >  plane.itol) type = FRONT;
+
+      sides_[i] = side;
+    }
+    else {
+      double t = plane.normal.dot(pos) - plane.w;
+
+      if      (t < -EPSILON) type = BACK;
+      else if (t >  EPSILON) type = FRONT;
+    }
+
+    polygonType |= type;
+
+    types_[i] = type;
+  }
+
+  switch (polygonType) {
+    case COPLANAR: {
+      if (plane.normal.dot(poly1.plane.normal) > 0)
+        coplanarFront.push_back(pi);
+      else
+        coplanarBack .push_back(pi);
+
+      break;
+    }
+    case FRONT:
+      front.push_back(pi);
+      break;
+    case BACK:
+      back.push_back(pi);
+      break;
+    case SPANNING: {
+      // copy polygon and indices as arrays grow below
+      auto poly2 = poly1;
+
+      pinds_.resize(n);
+
+      for (uint i = 0; i < n; ++i)
+        pinds_[i] = ind(poly2.first + i);
+
+      finds_.clear();
+      binds_.clear();
+
+      for (uint i = 0; i < n; ++i) {
+        uint j = (i + 1) % n;
+
+        int  ti = types_[i], tj = types_[j];
+        uint vi = pinds_[i], vj = pinds_[j];
+
+        if (ti != BACK ) finds_.push_back(vi);
+        if (ti != FRONT) binds_.push_back(vi);
+
+        if ((ti | tj) == SPANNING) {
+          const auto &pi1 = vert(vi);
+          const auto &pj1 = vert(vj);
+
+          double t;
+
+          if (robust_)
+            t = double(sides_[i])/double(sides_[i] - sides_[j]);
+          else
+            t = (plane.w - plane.normal.dot(pi1.pos))/plane.normal.dot(pj1.pos.minus(pi1.pos));
+
+          Mesh::Vertex v { pi1.pos.lerp(pj1.pos, t), pi1.normal.lerp(pj1.normal, t) };
+
+          // already in grid coordinates
+          if (robust_)
+            v.pos = Vector(std::round(v.pos.x), std::round(v.pos.y), std::round(v.pos.z));
+
+          auto vk = numVerts();
+
+          verts_.push_back(v);
+
+          finds_.push_back(vk);
+          binds_.push_back(vk);
+        }
+      }
+
+      auto addPiece = [&](Inds &inds, PolyList &list) {
+        if (robust_) {
+          // drop sliver collapsed by snapping
+          Int128 normal[3];
+
+          if (! cleanPolygon(inds, normal))
+            return;
+        }
+
+        if (inds.size() < 3)
+          return;
+
+        auto poly3 = poly2;
+
+        poly3.first = numInds();
+        poly3.count = uint(inds.size());
+
+        inds_.insert(inds_.end(), inds.begin(), inds.end());
+
+        list.push_back(numPolys());
+
+        polys_.push_back(poly3);
+      };
+
+      addPiece(finds_, front);
+      addPiece(binds_, back );
+
+      break;
+    }
+  }
+}
+
+bool
+Arena::
+cleanPolygon(Inds &inds, Int128 normal[3]) const
+{
+  auto samePos = [&](uint i1, uint i2) {
+    const auto &p1 = vert(i1).pos;
+    const auto &p2 = vert(i2).pos;
+
+    return (p1.x == p2.x && p1.y == p2.y && p1.z == p2.z);
+  };
+
+  size_t n = 0;
+
+  for (size_t i = 0; i < inds.size(); ++i) {
+    if (n > 0 && samePos(inds[n - 1], inds[i]))
+      continue;
+
+    inds[n++] = inds[i];
+  }
+
+  while (n > 1 && samePos(inds[n - 1], inds[0]))
+    --n;
+
+  inds.resize(n);
+
+  if (n < 3)
+    return false;
+
+  // Newell normal (twice area vector) of grid points
+  normal[0] = 0;
+  normal[1] = 0;
+  normal[2] = 0;
+
+  for (size_t i = 0; i < n; ++i) {
+    const auto &p1 = vert(inds[i          ]).pos;
+    const auto &p2 = vert(inds[(i + 1) % n]).pos;
+
+    normal[0] += (toInt(p1.y) - toInt(p2.y))*(toInt(p1.z) + toInt(p2.z));
+    normal[1] += (toInt(p1.z) - toInt(p2.z))*(toInt(p1.x) + toInt(p2.x));
+    normal[2] += (toInt(p1.x) - toInt(p2.x))*(toInt(p1.y) + toInt(p2.y));
+  }
+
+  return (normal[0] != 0 || normal[1] != 0 || normal[2] != 0);
+}
+
+// merge pairs of polygons with the same tag, orientation and plane which share an
+// edge while the result is convex. Vertices are never removed so no cracks are added
+void
+Arena::
+mergeCoplanar(OutPolys &polys) const
+{
+  using GroupKey = std::tuple<uint, bool, Int128, Int128, Int128, Int128>;
+  using PosKey   = std::tuple<double, double, double>;
+  using EdgeKey  = std::tuple<uint, uint, uint>;
+
+  std::map<GroupKey, uint> groups;
+  std::map<PosKey, uint>   posIds;
+
+  for (auto &poly1 : polys) {
+    const auto &plane = poly(poly1.poly).plane;
+
+    auto g = gcdInt(gcdInt(gcdInt(plane.in[0], plane.in[1]), plane.in[2]), plane.id);
+
+    auto key = GroupKey(poly1.tag, poly1.flipped, plane.in[0]/g, plane.in[1]/g,
+                        plane.in[2]/g, plane.id/g);
+
+    poly1.group = groups.emplace(key, uint(groups.size())).first->second;
+
+    auto a0 = absInt(plane.in[0]);
+    auto a1 = absInt(plane.in[1]);
+    auto a2 = absInt(plane.in[2]);
+
+    poly1.axis     = (a0 >= a1 && a0 >= a2 ? 0 : (a1 >= a2 ? 1 : 2));
+    poly1.positive = (plane.in[poly1.axis] > 0);
+
+    poly1.posIds.clear();
+
+    for (auto vi : poly1.inds) {
+      const auto &pos = vert(vi).pos;
+
+      auto id = posIds.emplace(PosKey(pos.x, pos.y, pos.z), uint(posIds.size())).first->second;
+
+      poly1.posIds.push_back(id);
+    }
+  }
+
+  //---
+
+  // directed edge (group, start, end) to polygon
+  std::map<EdgeKey, uint> edges;
+
+  auto addEdges = [&](uint i) {
+    const auto &poly1 = polys[i];
+
+    auto n = poly1.posIds.size();
+
+    for (size_t k = 0; k < n; ++k)
+      edges[EdgeKey(poly1.group, poly1.posIds[k], poly1.posIds[(k + 1) % n])] = i;
+  };
+
+  auto removeEdges = [&](uint i) {
+    const auto &poly1 = polys[i];
+
+    auto n = poly1.posIds.size();
+
+    for (size_t k = 0; k < n; ++k) {
+      auto p = edges.find(EdgeKey(poly1.group, poly1.posIds[k], poly1.posIds[(k + 1) % n]));
+
+      if (p != edges.end() && (*p).second == i)
+        edges.erase(p);
+    }
+  };
+
+  auto np = uint(polys.size());
+
+  for (uint i = 0; i < np; ++i)
+    addEdges(i);
+
+  std::vector<bool> alive(np, true);
+
+  for (uint i = 0; i < np; ++i) {
+    bool merged = true;
+
+    while (alive[i] && merged) {
+      merged = false;
+
+      auto &poly1 = polys[i];
+
+      auto n = uint(poly1.posIds.size());
+
+      for (uint k = 0; k < n; ++k) {
+        auto p = edges.find(EdgeKey(poly1.group, poly1.posIds[(k + 1) % n], poly1.posIds[k]));
+
+        if (p == edges.end())
+          continue;
+
+        auto j = (*p).second;
+
+        if (j == i || ! alive[j])
+          continue;
+
+        OutPoly poly;
+
+        if (! mergePolys(poly1, k, polys[j], poly))
+          continue;
+
+        removeEdges(i);
+        removeEdges(j);
+
+        poly1    = std::move(poly);
+        alive[j] = false;
+
+        addEdges(i);
+
+        merged = true;
+
+        break;
+      }
+    }
+  }
+
+  uint n = 0;
+
+  for (uint i = 0; i < np; ++i) {
+    if (! alive[i])
+      continue;
+
+    if (n != i)
+      polys[n] = std::move(polys[i]);
+
+    ++n;
+  }
+
+  polys.resize(n);
+}
+
+// merge poly2 into poly1 across edge i1 of poly1
+bool
+Arena::
+mergePolys(const OutPoly &poly1, uint i1, const OutPoly &poly2, OutPoly &poly) const
+{
+  auto n1 = poly1.posIds.size();
+  auto n2 = poly2.posIds.size();
+
+  auto a = poly1.posIds[i1];
+  auto b = poly1.posIds[(i1 + 1) % n1];
+
+  size_t i2 = 0;
+
+  while (i2 < n2 && ! (poly2.posIds[i2] == b && poly2.posIds[(i2 + 1) % n2] == a))
+    ++i2;
+
+  if (i2 >= n2)
+    return false;
+
+  poly.poly     = poly1.poly;
+  poly.tag      = poly1.tag;
+  poly.flipped  = poly1.flipped;
+  poly.group    = poly1.group;
+  poly.axis     = poly1.axis;
+  poly.positive = poly1.positive;
+
+  // poly1 from b round to a, then poly2 after a up to b
+  for (size_t i = 1; i <= n1; ++i) {
+    auto k = (i1 + i) % n1;
+
+    poly.inds  .push_back(poly1.inds  [k]);
+    poly.posIds.push_back(poly1.posIds[k]);
+  }
+
+  for (size_t i = 2; i < n2; ++i) {
+    auto k = (i2 + i) % n2;
+
+    poly.inds  .push_back(poly2.inds  [k]);
+    poly.posIds.push_back(poly2.posIds[k]);
+  }
+
+  // polygons sharing more than one edge
+  auto ids = poly.posIds;
+
+  std::sort(ids.begin(), ids.end());
+
+  if (std::adjacent_find(ids.begin(), ids.end()) != ids.end())
+    return false;
+
+  return isConvex(poly);
+}
+
+// exact convexity test projected onto plane of two minor normal axes (collinear
+// vertices allowed)
+bool
+Arena::
+isConvex(const OutPoly &poly) const
+{
+  auto u = (poly.axis + 1) % 3;
+  auto v = (poly.axis + 2) % 3;
+
+  auto coord = [&](uint vi, int k) {
+    const auto &pos = vert(vi).pos;
+
+    return toInt(k == 0 ? pos.x : (k == 1 ? pos.y : pos.z));
+  };
+
+  auto n = poly.inds.size();
+
+  for (size_t i = 0; i < n; ++i) {
+    auto i0 = poly.inds[(i + n - 1) % n];
+    auto i1 = poly.inds[i];
+    auto i2 = poly.inds[(i + 1) % n];
+
+    auto e1u = coord(i1, u) - coord(i0, u);
+    auto e1v = coord(i1, v) - coord(i0, v);
+    auto e2u = coord(i2, u) - coord(i1, u);
+    auto e2v = coord(i2, v) - coord(i1, v);
+
+    auto cross = e1u*e2v - e1v*e2u;
+
+    if (! poly.positive)
+      cross = -cross;
+
+    if (cross < 0)
+      return false;
+
+    // reversed or zero length edge
+    if (cross == 0 && e1u*e2u + e1v*e2v <= 0)
+      return false;
+  }
+
+  return true;
+}
+
+Mesh
+Arena::
+toMesh(uint root) const
+{
+  OutPolys polys;
+
+  for (auto pi : allPolygons(root)) {
+    const auto &poly1 = poly(pi);
+
+    OutPoly outPoly;
+
+    outPoly.poly    = pi;
+    outPoly.tag     = poly1.tag;
+    outPoly.flipped = poly1.flipped;
+
+    for (uint i = 0; i < poly1.count; ++i)
+      outPoly.inds.push_back(ind(poly1.first + i));
+
+    polys.push_back(std::move(outPoly));
+  }
+
+  if (robust_)
+    mergeCoplanar(polys);
+
+  //---
+
+  Mesh mesh;
+
+  // output vertex for each arena vertex and orientation (normals of flipped polygons
+  // are negated)
+  std::vector<int> vertexMap[2];
+
+  vertexMap[0].resize(numVerts(), -1);
+  vertexMap[1].resize(numVerts(), -1);
+
+  Mesh::Indices inds;
+
+  for (const auto &poly1 : polys) {
+    auto &map = vertexMap[poly1.flipped ? 1 : 0];
+
+    inds.clear();
+
+    for (auto vi : poly1.inds) {
+      if (map[vi] < 0) {
+        const auto &v = vert(vi);
+
+        auto pos    = (robust_ ? v.pos.times(grid_) : v.pos);
+        auto normal = (poly1.flipped ? v.normal.negated() : v.normal);
+
+        map[vi] = int(mesh.addVertex(pos, normal));
+      }
+
+      inds.push_back(uint(map[vi]));
+    }
+
+    mesh.addPolygon(inds, poly1.tag);
+  }
+
+  return mesh;
+}
+
+}
+
+//---
+
+uint
+Mesh::
+addVertex(const Vector &pos, const Vector &normal)
+{
+  vertices_.push_back(Vertex { pos, normal });
+
+  return uint(vertices_.size() - 1);
+}
+
+void
+Mesh::
+addPolygon(const Indices &inds, uint tag)
+{
+  if (inds.size() < 3)
+    return;
+
+  Polygon polygon;
+
+  polygon.first = uint(indices_.size());
+  polygon.count = uint(inds.size());
+  polygon.tag   = tag;
+
+  indices_.insert(indices_.end(), inds.begin(), inds.end());
+
+  polygons_.push_back(polygon);
+}
+
+void
+Mesh::
+setTag(uint tag)
+{
+  for (auto &polygon : polygons_)
+    polygon.tag = tag;
+}
+
+// a.clipTo(b), b.clipTo(a), b.invert(), b.clipTo(a), b.invert(), a.build(b.allPolygons())
+Mesh
+Mesh::
+unionOp(const Mesh &mesh, const Options &options) const
+{
+  Arena arena(*this, mesh, options);
+
+  uint a, b;
+
+  arena.addMeshes(*this, mesh, a, b);
+
+  arena.clipTo(a, b);
+  arena.clipTo(b, a);
+  arena.invert(b);
+  arena.clipTo(b, a);
+  arena.invert(b);
+
+  arena.buildTree(a, arena.allPolygons(b));
+
+  return arena.toMesh(a);
+}
+
+// A - B = ~(~A | B)
+Mesh
+Mesh::
+subtractOp(const Mesh &mesh, const Options &options) const
+{
+  Arena arena(*this, mesh, options);
+
+  uint a, b;
+
+  arena.addMeshes(*this, mesh, a, b);
+
+  arena.invert(a);
+  arena.clipTo(a, b);
+  arena.clipTo(b, a);
+  arena.invert(b);
+  arena.clipTo(b, a);
+  arena.invert(b);
+
+  arena.buildTree(a, arena.allPolygons(b));
+
+  arena.invert(a);
+
+  return arena.toMesh(a);
+}
+
+// A & B = ~(~A | ~B)
+Mesh
+Mesh::
+intersectOp(const Mesh &mesh, const Options &options) const
+{
+  Arena arena(*this, mesh, options);
+
+  uint a, b;
+
+  arena.addMeshes(*this, mesh, a, b);
+
+  arena.invert(a);
+  arena.clipTo(b, a);
+  arena.invert(b);
+  arena.clipTo(a, b);
+  arena.clipTo(b, a);
+
+  arena.buildTree(a, arena.allPolygons(b));
+
+  arena.invert(a);
+
+  return arena.toMesh(a);
+}
+
+Mesh
+Mesh::
+inverseOp() const
+{
+  Mesh mesh;
+
+  mesh.vertices_ = vertices_;
+  mesh.polygons_ = polygons_;
+  mesh.indices_  = indices_;
+
+  for (auto &v : mesh.vertices_)
+    v.normal = v.normal.negated();
+
+  for (const auto &polygon : mesh.polygons_)
+    std::reverse(mesh.indices_.begin() + polygon.first,
+                 mesh.indices_.begin() + polygon.first + polygon.count);
+
+  return mesh;
+}
+
+//---
+
+Mesh
+Mesh::
+cube(const Vector &c, double r)
+{
+  static double normals[][3] = {
+    {-1,  0,  0},
+    {+1,  0,  0},
+    { 0, -1,  0},
+    { 0, +1,  0},
+    { 0,  0, -1},
+    { 0,  0, +1}
+  };
+
+  static int faces[][4] = {
+    {0, 4, 6, 2},
+    {1, 3, 7, 5},
+    {0, 1, 5, 4},
+    {2, 6, 7, 3},
+    {0, 2, 3, 1},
+    {4, 5, 7, 6}
+  };
+
+  Mesh mesh;
+
+  Indices inds;
+
+  for (int i = 0; i < 6; ++i) {
+    auto n = Vector(normals[i][0], normals[i][1], normals[i][2]);
+
+    inds.clear();
+
+    for (int j = 0; j < 4; ++j) {
+      auto f = faces[i][j];
+
+      Vector pos(c.x + r*(2*(f & 1 ? 1 : 0) - 1),
+                 c.y + r*(2*(f & 2 ? 1 : 0) - 1),
+                 c.z + r*(2*(f & 4 ? 1 : 0) - 1));
+
+      inds.push_back(mesh.addVertex(pos, n));
+    }
+
+    mesh.addPolygon(inds);
+  }
+
+  return mesh;
+}
+
+Mesh
+Mesh::
+sphere(const Vector &c, double r, int slices, int stacks)
+{
+  Mesh mesh;
+
+  // shared grid of vertices (slices + 1 by stacks + 1)
+  for (int i = 0; i <= slices; ++i) {
+    for (int j = 0; j <= stacks; ++j) {
+      double theta = (1.0*i/slices)*M_PI*2.0;
+      double phi   = (1.0*j/stacks)*M_PI;
+
+      Vector dir(std::cos(theta)*std::sin(phi), std::cos(phi), std::sin(theta)*std::sin(phi));
+
+      mesh.addVertex(c.plus(dir.times(r)), dir);
+    }
+  }
+
+  auto vertex = [&](int i, int j) { return uint(i*(stacks + 1) + j); };
+
+  Indices inds;
+
+  for (int i = 0; i < slices; ++i) {
+    for (int j = 0; j < stacks; ++j) {
+      inds.clear();
+
+      inds.push_back(vertex(i, j));
+
+      if (j > 0         ) inds.push_back(vertex(i + 1, j    ));
+      if (j < stacks - 1) inds.push_back(vertex(i + 1, j + 1));
+
+      inds.push_back(vertex(i, j + 1));
+
+      mesh.addPolygon(inds);
+    }
+  }
+
+  return mesh;
+}
+
+Mesh
+Mesh::
+cylinder(const Vector &s, const Vector &e, double r, int slices)
+{
+  Mesh mesh;
+
+  auto ray = e.minus(s);
+
+  auto axisZ = ray.unit(); bool isY = (std::abs(axisZ.y) > 0.5);
+  auto axisX = Vector(isY, !isY, 0).cross(axisZ).unit();
+  auto axisY = axisX.cross(axisZ).unit();
+
+  auto start = mesh.addVertex(s, axisZ.negated());
+  auto end   = mesh.addVertex(e, axisZ);
+
+  auto point = [&](int stack, double slice, int normalBlend) {
+    double angle = slice*M_PI*2;
+
+    auto out    = axisX.times(cos(angle)).plus(axisY.times(sin(angle)));
+    auto pos    = s.plus(ray.times(stack)).plus(out.times(r));
+    auto normal = out.times(1 - std::abs(normalBlend)).plus(axisZ.times(normalBlend));
+
+    return mesh.addVertex(pos, normal);
+  };
+
+  // ring vertices for bottom cap, side bottom, side top and top cap
+  std::vector<uint> ring[4];
+
+  for (int i = 0; i <= slices; ++i) {
+    double t = double(i)/slices;
+
+    ring[0].push_back(point(0, t, -1));
+    ring[1].push_back(point(0, t,  0));
+    ring[2].push_back(point(1, t,  0));
+    ring[3].push_back(point(1, t,  1));
+  }
+
+  for (int i = 0; i < slices; ++i) {
+    mesh.addPolygon({start, ring[0][i], ring[0][i + 1]});
+    mesh.addPolygon({ring[1][i + 1], ring[1][i], ring[2][i], ring[2][i + 1]});
+    mesh.addPolygon({end, ring[3][i + 1], ring[3][i]});
+  }
+
+  return mesh;
+}
+
+}